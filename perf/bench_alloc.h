@@ -0,0 +1,85 @@
+// ===================== bench_alloc.h =====================
+// Counting memory policies shared by the benchmarks.
+//
+// An Account collects what a container asks from its policy:
+//
+//  - calls  : allocator calls
+//  - bytes  : requested bytes
+//  - usable : bytes malloc actually handed out (malloc_usable_size), live
+//  - pool   : the VmBumpPoolT of the arena policies
+//
+// The malloc policies behave like the library default; the arena policies take the
+// nodes from 'pool' and never hand them back, the arena is released by the benchmark.
+// The map variants account for the map node head in front of the set node.
+#ifndef BENCH_ALLOC_H_
+#define BENCH_ALLOC_H_
+
+#include "cpatricia_set.h"
+#include "cpatricia_map.h"
+#include "vmbumppool.h"
+#include <cstddef>
+#include <cstdlib>
+#if defined(__linux__)
+# include <malloc.h>
+#endif
+
+struct Account {
+    std::size_t  calls = 0;      // allocator calls
+    std::size_t  bytes = 0;      // requested bytes
+    std::size_t  usable = 0;     // malloc usable bytes, live
+    VmBumpPoolT *pool = nullptr; // arena, if any
+
+    // memory held: live usable bytes for malloc, bytes consumed from the arena
+    std::size_t held() const {
+        return pool ? vmBump_getattr(pool, eVmBumpAtt_Total) : usable;
+    }
+};
+
+static constexpr std::size_t kMapHead = offsetof(PTMapNodeT, _m_node);
+
+static inline std::size_t usable_size(void *p, std::size_t n) {
+#if defined(__linux__)
+    (void)n;
+    return malloc_usable_size(p);
+#else
+    (void)p;
+    return n;
+#endif
+}
+
+static inline void *cnt_malloc(Account *a, std::size_t n, std::size_t head) {
+    char *p = static_cast<char *>(std::malloc(n + head));
+    if (!p) return nullptr;
+    ++a->calls;
+    a->bytes  += n + head;
+    a->usable += usable_size(p, n + head);
+    return p + head;
+}
+
+static inline void cnt_free(Account *a, void *obj, std::size_t head) {
+    char *p = static_cast<char *>(obj) - head;
+    a->usable -= usable_size(p, 0);
+    std::free(p);
+}
+
+static inline void *cnt_bump(Account *a, std::size_t n, std::size_t head) {
+    char *p = static_cast<char *>(vmBump_alloc(a->pool, n + head, sizeof(void *)));
+    if (!p) return nullptr;
+    ++a->calls;
+    a->bytes += n + head;
+    return p + head;
+}
+
+static inline void *set_malloc(void *a, size_t n) { return cnt_malloc(static_cast<Account *>(a), n, 0); }
+static inline void  set_free(void *a, void *p)    { cnt_free(static_cast<Account *>(a), p, 0); }
+static inline void *set_bump(void *a, size_t n)   { return cnt_bump(static_cast<Account *>(a), n, 0); }
+static inline void *map_malloc(void *a, size_t n) { return cnt_malloc(static_cast<Account *>(a), n, kMapHead); }
+static inline void  map_free(void *a, void *p)    { cnt_free(static_cast<Account *>(a), p, kMapHead); }
+static inline void *map_bump(void *a, size_t n)   { return cnt_bump(static_cast<Account *>(a), n, kMapHead); }
+
+static const PTMemFuncT mf_set_malloc = {set_malloc, set_free, nullptr};
+static const PTMemFuncT mf_set_bump   = {set_bump,   nullptr,  nullptr};
+static const PTMemFuncT mf_map_malloc = {map_malloc, map_free, nullptr};
+static const PTMemFuncT mf_map_bump   = {map_bump,   nullptr,  nullptr};
+
+#endif // BENCH_ALLOC_H_
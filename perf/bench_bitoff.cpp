@@ -0,0 +1,78 @@
+// ===================== bench_bitoff.cpp =====================
+// Header fields that do not start on a byte boundary: a 20-bit field 4 bits into the
+// packet (the IPv6 flow label) followed by a 40-bit field, matched as one 60-bit key.
+// Shifting the field into a scratch buffer before every lookup, against handing the
+// packet buffer and the bit offset over to patriset_lookup_o().
+//
+// Benchmarks are registered as  BM_BitOffset/<shiftcopy|inplace>/N:<N>
+// and report the time of one successful lookup in random order.
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kPacket = 16;  // bytes of header per packet
+constexpr unsigned    kOffset = 4;   // bit offset of the key
+constexpr uint16_t    kBits   = 60;  // key length
+
+// byte-aligned copy of the key bits, the way a caller without offset support would
+void shift_copy(unsigned char *dst, const unsigned char *pkt) {
+    for (unsigned i = 0; i < (kBits + 7) / 8; ++i) {
+        dst[i] = static_cast<unsigned char>((pkt[i] << kOffset) | (pkt[i + 1] >> (8 - kOffset)));
+    }
+}
+
+void BM_BitOffset(benchmark::State &state, bool inplace) {
+    const std::size_t n = std::size_t(state.range(0));
+    std::mt19937_64 rng(17);
+    std::vector<unsigned char> packets(n * kPacket);
+    PatriciaSetT set;
+    patriset_init(&set);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < kPacket; ++j) packets[i * kPacket + j] = static_cast<unsigned char>(rng());
+        patriset_insert_o(&set, &packets[i * kPacket], kOffset, kBits, nullptr);
+    }
+    std::vector<uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = uint32_t(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(19));
+
+    unsigned char scratch[(kBits + 7) / 8];
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const unsigned char *pkt = &packets[std::size_t(order[i]) * kPacket];
+        const PTSetNodeT *np;
+        if (inplace) {
+            np = patriset_lookup_o(&set, pkt, kOffset, kBits);
+        } else {
+            shift_copy(scratch, pkt);
+            np = patriset_lookup(&set, scratch, kBits);
+        }
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == n) i = 0;
+    }
+    if (found != std::size_t(state.iterations())) {
+        state.SkipWithError("lookup missed");
+    }
+    patriset_fini(&set);
+}
+
+int register_bitoff() {
+    for (bool inplace : {false, true}) {
+        std::string name = std::string("BM_BitOffset/") + (inplace ? "inplace" : "shiftcopy");
+        benchmark::RegisterBenchmark(name.c_str(), BM_BitOffset, inplace)
+            ->ArgName("N")->Arg(10000)->Arg(1000000);
+    }
+    return 0;
+}
+
+const int registered = register_bitoff();
+
+} // namespace
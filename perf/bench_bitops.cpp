@@ -0,0 +1,197 @@
+// ===================== bench_bitops.cpp =====================
+// Microbenchmarks for the bit primitives in the inner loop of every tree operation:
+//
+//  - patricia_getbit  : random bit indices, including indices past the key end
+//  - patricia_bitdiff : difference early (bit 1), mid, late (last bit) or none; this also
+//                       covers the internal bit streamer and the clz/bswap helpers
+//  - patricia_equkey  : mismatch early, late or none
+//  - patricia_clz / patricia_bswap : the portable fallbacks against compiler builtins
+//
+// Key lengths run from 1 to 8192 bits, including lengths that are not byte or word
+// multiples.  Buffers are cache-line aligned, both misaligned (+1 byte), or mixed
+// (first aligned, second at +3 bytes).
+//
+// Benchmarks are registered as
+//   BM_Bits/getbit/<align>/len:<L>
+//   BM_Bits/bitdiff/<align>/<early|mid|late|none>/len:<L>
+//   BM_Bits/equkey/<align>/<early|late|none>/len:<L>
+//   BM_Bits/<clz|bswap>/<builtin|portable>
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+enum class Align { Aligned, Unaligned, Mixed };
+enum class Diff  { Early, Mid, Late, None };
+
+constexpr std::size_t kMaxBytes = 8192 / CHAR_BIT;
+
+// Two key buffers with identical random content, at the requested alignment
+struct KeyPair {
+    alignas(64) unsigned char raw1[kMaxBytes + 64];
+    alignas(64) unsigned char raw2[kMaxBytes + 64];
+    unsigned char *p1;
+    unsigned char *p2;
+
+    explicit KeyPair(Align a) {
+        p1 = raw1 + (a == Align::Unaligned ? 1 : 0);
+        p2 = raw2 + (a == Align::Aligned ? 0 : a == Align::Unaligned ? 1 : 3);
+        std::mt19937 rng(42);
+        for (std::size_t i = 0; i < kMaxBytes + 1; ++i) p1[i] = p2[i] = (unsigned char)rng();
+    }
+    // flip unity-based bit 'pos' in the second key
+    void flip(unsigned pos) {
+        --pos;
+        p2[pos / CHAR_BIT] ^= (unsigned char)(0x80u >> (pos % CHAR_BIT));
+    }
+};
+
+unsigned diff_pos(Diff d, unsigned len) {
+    switch (d) {
+    case Diff::Early: return 1;
+    case Diff::Mid:   return (len + 1) / 2;
+    case Diff::Late:  return len;
+    default:          return 0;
+    }
+}
+
+// ------------------------------------------------------------
+// patricia_getbit: a fixed stream of indices in [0, len + 16]
+// ------------------------------------------------------------
+void BM_GetBit(benchmark::State &state, Align align) {
+    const uint16_t len = uint16_t(state.range(0));
+    KeyPair kp(align);
+    std::mt19937 rng(7);
+    std::vector<uint16_t> idx(1024);
+    for (auto &i : idx) i = uint16_t(rng() % (len + 17u));
+
+    unsigned sink = 0;
+    for (auto _ : state) {
+        for (auto i : idx) sink += patricia_getbit(kp.p1, len, i);
+    }
+    benchmark::DoNotOptimize(sink);
+    state.SetItemsProcessed(state.iterations() * int64_t(idx.size()));
+}
+
+// ------------------------------------------------------------
+// patricia_bitdiff: equal lengths, one flipped bit (or none)
+// ------------------------------------------------------------
+void BM_BitDiff(benchmark::State &state, Align align, Diff diff) {
+    const uint16_t len = uint16_t(state.range(0));
+    KeyPair kp(align);
+    const unsigned pos = diff_pos(diff, len);
+    if (pos) kp.flip(pos);
+
+    uint16_t res = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kp.p1);
+        res = patricia_bitdiff(kp.p1, len, kp.p2, len);
+        benchmark::DoNotOptimize(res);
+    }
+    if (res != pos) state.SkipWithError("bitdiff returned a wrong position");
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * int64_t((pos ? pos : len) + CHAR_BIT - 1) / CHAR_BIT);
+}
+
+// ------------------------------------------------------------
+// patricia_equkey: equal lengths, one flipped bit (or none)
+// ------------------------------------------------------------
+void BM_EquKey(benchmark::State &state, Align align, Diff diff) {
+    const uint16_t len = uint16_t(state.range(0));
+    KeyPair kp(align);
+    const unsigned pos = diff_pos(diff, len);
+    if (pos) kp.flip(pos);
+
+    bool res = false;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kp.p1);
+        res = patricia_equkey(kp.p1, len, kp.p2, len);
+        benchmark::DoNotOptimize(res);
+    }
+    if (res != (0 == pos)) state.SkipWithError("equkey returned a wrong result");
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * int64_t((pos ? pos : len) + CHAR_BIT - 1) / CHAR_BIT);
+}
+
+// ------------------------------------------------------------
+// clz / bswap: the library's portable fallbacks against the builtins the library
+// uses when compiled with GCC or Clang
+// ------------------------------------------------------------
+std::vector<size_t> word_stream() {
+    // nonzero values with the leading one spread over all positions
+    std::mt19937_64 rng(11);
+    std::vector<size_t> out(1024);
+    for (auto &v : out) v = (size_t(rng()) | 1u) >> (rng() % (sizeof(size_t) * CHAR_BIT));
+    for (auto &v : out) v |= (v == 0);
+    return out;
+}
+
+template <bool Builtin>
+void BM_Clz(benchmark::State &state) {
+    const auto words = word_stream();
+    unsigned sink = 0;
+    for (auto _ : state) {
+        for (auto v : words) {
+            if constexpr (Builtin) sink += unsigned(__builtin_clzll((unsigned long long)v))
+                                           - unsigned((sizeof(long long) - sizeof(size_t)) * CHAR_BIT);
+            else                   sink += patricia_clz(v);
+        }
+        benchmark::DoNotOptimize(sink);
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(words.size()));
+}
+
+template <bool Builtin>
+void BM_Bswap(benchmark::State &state) {
+    const auto words = word_stream();
+    size_t sink = 0;
+    for (auto _ : state) {
+        for (auto v : words) {
+            if constexpr (Builtin) sink ^= size_t(__builtin_bswap64(uint64_t(v)) >> (64 - sizeof(size_t) * CHAR_BIT));
+            else                   sink ^= patricia_bswap(v);
+        }
+        benchmark::DoNotOptimize(sink);
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(words.size()));
+}
+
+int register_bitops() {
+    static const struct { const char *name; Align align; } aligns[] = {
+        {"aligned", Align::Aligned}, {"unaligned", Align::Unaligned}, {"mixed", Align::Mixed},
+    };
+    static const struct { const char *name; Diff diff; } diffs[] = {
+        {"early", Diff::Early}, {"mid", Diff::Mid}, {"late", Diff::Late}, {"none", Diff::None},
+    };
+    static const int64_t lens[] = {1, 7, 8, 13, 63, 64, 65, 127, 128, 255, 1000, 1024, 4095, 8192};
+
+    for (auto &a : aligns) {
+        auto *b = benchmark::RegisterBenchmark((std::string("BM_Bits/getbit/") + a.name).c_str(), BM_GetBit, a.align);
+        b->ArgName("len");
+        for (auto l : lens) b->Arg(l);
+        for (auto &d : diffs) {
+            std::string suffix = std::string(a.name) + "/" + d.name;
+            b = benchmark::RegisterBenchmark(("BM_Bits/bitdiff/" + suffix).c_str(), BM_BitDiff, a.align, d.diff);
+            b->ArgName("len");
+            for (auto l : lens) b->Arg(l);
+            if (d.diff == Diff::Mid) continue;
+            b = benchmark::RegisterBenchmark(("BM_Bits/equkey/" + suffix).c_str(), BM_EquKey, a.align, d.diff);
+            b->ArgName("len");
+            for (auto l : lens) b->Arg(l);
+        }
+    }
+    benchmark::RegisterBenchmark("BM_Bits/clz/builtin",    BM_Clz<true>);
+    benchmark::RegisterBenchmark("BM_Bits/clz/portable",   BM_Clz<false>);
+    benchmark::RegisterBenchmark("BM_Bits/bswap/builtin",  BM_Bswap<true>);
+    benchmark::RegisterBenchmark("BM_Bits/bswap/portable", BM_Bswap<false>);
+    return 0;
+}
+
+const int registered = register_bitops();
+
+} // namespace
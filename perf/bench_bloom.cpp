@@ -0,0 +1,83 @@
+// ===================== bench_bloom.cpp =====================
+// Blocklist checks where most lookups miss: the plain set against the set with a
+// blocked Bloom filter in front (PatriciaBloomT).  A miss in the plain set still walks
+// down to a leaf and compares keys; with the filter, most misses are answered by one
+// probe of one 64-byte block.
+//
+// Keys are 16..31 random bytes.  The query stream mixes keys in the set with keys that
+// are not, at the hit rate given as argument (in percent).
+//
+// Benchmarks are registered as  BM_Bloom/<plain|filter>/hit%:<H>/N:<N>
+// and report the time of one lookup.
+#include "cpatricia_set.h"
+#include "cpatricia_bloom.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+std::string random_key(std::mt19937_64 &rng) {
+    std::string k(16 + rng() % 16, '\0');
+    for (auto &c : k) c = char(rng());
+    return k;
+}
+
+void BM_Bloom(benchmark::State &state, bool filter) {
+    const unsigned    hit = unsigned(state.range(0));
+    const std::size_t n   = std::size_t(state.range(1));
+    const std::size_t nq  = 1u << 16;
+    std::mt19937_64 rng(31);
+
+    std::vector<std::string> keys(n);
+    for (auto &k : keys) k = random_key(rng);
+
+    PatriciaSetT   set;
+    PatriciaBloomT bset;
+    if (filter) {
+        patribloom_init(&bset, n);
+        for (auto &k : keys) patribloom_insert(&bset, k.data(), uint16_t(k.size() * CHAR_BIT), nullptr);
+    } else {
+        patriset_init(&set);
+        for (auto &k : keys) patriset_insert(&set, k.data(), uint16_t(k.size() * CHAR_BIT), nullptr);
+    }
+
+    // random keys of these lengths miss with overwhelming probability
+    std::vector<std::string> queries(nq);
+    for (auto &q : queries) q = (rng() % 100 < hit) ? keys[rng() % n] : random_key(rng);
+
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const std::string &q = queries[i];
+        const PTSetNodeT *np = filter ? patribloom_lookup(&bset, q.data(), uint16_t(q.size() * CHAR_BIT))
+                                      : patriset_lookup(&set, q.data(), uint16_t(q.size() * CHAR_BIT));
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == nq) i = 0;
+    }
+    state.counters["hit rate"] = double(found) / double(state.iterations());
+    if (filter) {
+        patribloom_fini(&bset);
+    } else {
+        patriset_fini(&set);
+    }
+}
+
+int register_bloom() {
+    for (bool filter : {false, true}) {
+        std::string name = std::string("BM_Bloom/") + (filter ? "filter" : "plain");
+        auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_Bloom, filter);
+        b->ArgNames({"hit%", "N"});
+        for (int64_t hit : {1, 10, 50}) {
+            for (int64_t n : {100000, 1000000}) b->Args({hit, n});
+        }
+    }
+    return 0;
+}
+
+const int registered = register_bloom();
+
+} // namespace
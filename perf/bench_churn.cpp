@@ -0,0 +1,153 @@
+// ===================== bench_churn.cpp =====================
+// Steady-state churn: a working set of W keys is filled up front, then a random mix of
+// lookups, inserts and removals runs against it.  Keys come from a universe of 2*W
+// keys; inserts pick a key that is currently absent and removals one that is present,
+// so with equal insert & remove ratios the working set stays at W keys.
+//
+// The mix is given in percent as  lookup/insert/remove, e.g. 90/5/5 or 50/25/25; removals
+// take whatever lookups and inserts leave over.
+//
+// Counters:
+//  - bytes/key  : memory held by the container at the end, per live key
+//  - fill/key   : the same right after filling the working set
+//  - growth%    : memory growth from fill to end
+//  - MB/Mop     : memory growth per million operations -- a container that reuses freed
+//                 nodes stays near zero, a bump arena without reuse grows linearly
+//
+// 'Memory held' is live bytes for malloc and bytes consumed from the arena for
+// VmBumpPoolT, which never hands back what the tree frees.
+// Benchmarks are registered as  BM_Churn/<set|map>/<malloc|arena>/W:<W>/lookup:../insert:../remove:..
+#include "cpatricia_set.h"
+#include "cpatricia_map.h"
+#include "vmbumppool.h"
+#include "bench_alloc.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+// ------------------------------------------------------------
+// Key universe: 16-byte keys, a bijective scramble of the index up front
+// ------------------------------------------------------------
+constexpr std::size_t kKeyLen = 16;
+
+std::vector<std::string> make_universe(std::size_t n) {
+    std::vector<std::string> out(n, std::string(kKeyLen, '\0'));
+    for (std::size_t i = 0; i < n; ++i) {
+        make_key(&out[i][0], kKeyLen, i);
+    }
+    return out;
+}
+
+// Key index pool with O(1) random removal, one for present and one for absent keys
+struct Pool {
+    std::vector<uint32_t> item;
+
+    bool empty() const { return item.empty(); }
+    void add(uint32_t k) { item.push_back(k); }
+    uint32_t take(uint64_t r) {
+        std::size_t pos = std::size_t(r % item.size());
+        uint32_t k = item[pos];
+        item[pos] = item.back();
+        item.pop_back();
+        return k;
+    }
+};
+
+void BM_Churn(benchmark::State &state, bool is_map, bool arena) {
+    const std::size_t W   = static_cast<std::size_t>(state.range(0));
+    const unsigned    pLk = unsigned(state.range(1));
+    const unsigned    pIn = unsigned(state.range(2));
+    const std::size_t ops = W;   // operations per iteration
+
+    auto keys = make_universe(2 * W);
+    Account acc;
+    VmBumpPoolT pool;
+    PatriciaSetT set;
+    PatriciaMapT map;
+    if (arena) {
+        vmBump_init(&pool, 1u << 20, 4096);   // 1 MiB blocks, 4 GiB limit
+        acc.pool = &pool;
+    }
+    if (is_map) {
+        patrimap_init_ex(&map, arena ? &mf_map_bump : &mf_map_malloc, &acc);
+    } else {
+        patriset_init_ex(&set, arena ? &mf_set_bump : &mf_set_malloc, &acc);
+    }
+
+    // fill with a random half of the universe
+    Pool present, absent;
+    std::mt19937_64 rng(4711);
+    for (uint32_t k = 0; k < keys.size(); ++k) absent.add(k);
+    for (std::size_t i = 0; i < W; ++i) {
+        uint32_t k = absent.take(rng());
+        present.add(k);
+        if (is_map) patrimap_insert(&map, keys[k].data(), kKeyLen * CHAR_BIT, nullptr);
+        else        patriset_insert(&set, keys[k].data(), kKeyLen * CHAR_BIT, nullptr);
+    }
+    const std::size_t fill = acc.held();
+
+    std::size_t hits = 0, done = 0;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < ops; ++i) {
+            uint64_t r = rng();
+            unsigned dice = unsigned(r % 100);
+            r >>= 8;
+            if (dice < pLk || (dice < pLk + pIn ? absent.empty() : present.empty())) {
+                // lookup: members and non-members alike
+                const std::string &k = keys[r % keys.size()];
+                hits += is_map ? (nullptr != patrimap_lookup(&map, k.data(), kKeyLen * CHAR_BIT))
+                               : (nullptr != patriset_lookup(&set, k.data(), kKeyLen * CHAR_BIT));
+            } else if (dice < pLk + pIn) {
+                uint32_t k = absent.take(r);
+                present.add(k);
+                if (is_map) benchmark::DoNotOptimize(patrimap_insert(&map, keys[k].data(), kKeyLen * CHAR_BIT, nullptr));
+                else        benchmark::DoNotOptimize(patriset_insert(&set, keys[k].data(), kKeyLen * CHAR_BIT, nullptr));
+            } else {
+                uint32_t k = present.take(r);
+                absent.add(k);
+                if (is_map) benchmark::DoNotOptimize(patrimap_remove(&map, keys[k].data(), kKeyLen * CHAR_BIT));
+                else        benchmark::DoNotOptimize(patriset_remove(&set, keys[k].data(), kKeyLen * CHAR_BIT));
+            }
+        }
+        done += ops;
+        benchmark::DoNotOptimize(hits);
+    }
+
+    const std::size_t held = acc.held();
+    const std::size_t live = present.item.size();
+    state.SetItemsProcessed(int64_t(done));
+    state.counters["fill/key"]  = double(fill) / double(W);
+    state.counters["bytes/key"] = live ? double(held) / double(live) : 0.0;
+    state.counters["growth%"]   = fill ? 100.0 * (double(held) - double(fill)) / double(fill) : 0.0;
+    state.counters["MB/Mop"]    = done ? (double(held) - double(fill)) / double(done) : 0.0;
+
+    if (is_map) patrimap_fini(&map); else patriset_fini(&set);
+    if (arena) vmBump_fini(&pool);
+}
+
+int register_churn() {
+    static const int64_t mixes[][3] = {{90, 5, 5}, {50, 25, 25}, {0, 50, 50}};
+    for (int is_map = 0; is_map < 2; ++is_map) {
+        for (int arena = 0; arena < 2; ++arena) {
+            std::string name = std::string("BM_Churn") + (is_map ? "/map" : "/set")
+                             + (arena ? "/arena" : "/malloc");
+            auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_Churn, bool(is_map), bool(arena));
+            b->ArgNames({"W", "lookup", "insert", "remove"});
+            for (int64_t w : {10000, 100000}) {
+                for (auto &m : mixes) b->Args({w, m[0], m[1], m[2]});
+            }
+        }
+    }
+    return 0;
+}
+
+const int registered = register_churn();
+
+} // namespace
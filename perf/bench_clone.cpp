@@ -0,0 +1,90 @@
+// ===================== bench_clone.cpp =====================
+// Bulk node allocation: a structural clone of a set followed by its finalisation, with
+// the same memory policy once without and once with the batch hooks (PTMemBatchT).
+// Without them, every node costs one indirect call into the policy on the way in and
+// another one on the way out; with them, the library hands over chunks of nodes.
+//
+// The policy is malloc/free behind a mutex, standing in for a shared pool or a locking
+// allocator: the single-node hooks take the lock per node, the batch hooks per chunk.
+//
+// Benchmarks are registered as  BM_Clone/<single|batch>/N:<N>
+// and report clone and fini time per node.
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <climits>
+
+namespace {
+
+std::mutex g_heap_lock;
+
+void *one_alloc(void *, size_t n) {
+    std::lock_guard<std::mutex> guard(g_heap_lock);
+    return std::malloc(n);
+}
+void one_free(void *, void *p) {
+    std::lock_guard<std::mutex> guard(g_heap_lock);
+    std::free(p);
+}
+
+size_t batch_alloc(void *, void **objs, const size_t *bytes, size_t count) {
+    std::lock_guard<std::mutex> guard(g_heap_lock);
+    size_t i = 0;
+    while (i < count && nullptr != (objs[i] = std::malloc(bytes[i]))) ++i;
+    return i;
+}
+void batch_free(void *, void **objs, size_t count) {
+    std::lock_guard<std::mutex> guard(g_heap_lock);
+    while (count--) std::free(*objs++);
+}
+
+const PTMemFuncT  mf_single = {one_alloc, one_free, nullptr};
+const PTMemBatchT mb_batch  = {sizeof(PTMemBatchT), batch_alloc, batch_free};
+
+void BM_Clone(benchmark::State &state, const PTMemBatchT *mb) {
+    const std::size_t n = std::size_t(state.range(0));
+    std::mt19937 rng(5);
+    PatriciaSetT src, dst;
+    patriset_init(&src);
+    std::string key(16, '\0');
+    for (std::size_t i = 0; i < n; ++i) {
+        for (auto &c : key) c = char('a' + rng() % 26);
+        patriset_insert(&src, key.data(), uint16_t(key.size() * CHAR_BIT), nullptr);
+    }
+
+    double t_clone = 0.0, t_fini = 0.0;
+    for (auto _ : state) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!patriset_clone_ex(&dst, &src, &mf_single, mb, nullptr, nullptr)) {
+            state.SkipWithError("clone failed");
+            break;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        patriset_fini(&dst);
+        auto t2 = std::chrono::steady_clock::now();
+        t_clone += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        t_fini  += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    }
+    const double nodes = double(state.iterations()) * double(n);
+    state.counters["clone ns/node"] = nodes > 0 ? t_clone / nodes : 0.0;
+    state.counters["fini ns/node"]  = nodes > 0 ? t_fini / nodes : 0.0;
+    state.SetItemsProcessed(int64_t(nodes));
+    patriset_fini(&src);
+}
+
+int register_clone() {
+    for (auto *mb : {static_cast<const PTMemBatchT *>(nullptr), &mb_batch}) {
+        std::string name = std::string("BM_Clone/") + (mb ? "batch" : "single");
+        benchmark::RegisterBenchmark(name.c_str(), BM_Clone, mb)->ArgName("N")->Arg(10000)->Arg(1000000);
+    }
+    return 0;
+}
+
+const int registered = register_clone();
+
+} // namespace
@@ -0,0 +1,391 @@
+// ===================== bench_compare.cpp =====================
+// PatriciaC against standard containers on identical key sets:
+//   std::map, std::unordered_set, a sorted vector with binary search and a plain
+//   crit-bit tree (byte/mask internal nodes, as popularised by D.J.Bernstein & A.Langley)
+//
+// Operations: insert, lookup hit, lookup miss, longest-prefix query, ordered scan,
+// remove (all keys) and teardown.  All containers allocate through counting hooks,
+// so every benchmark reports 'bytes/key' of the populated container.
+//
+// Prefix queries on the standard containers probe every shorter prefix of the query,
+// longest first -- that is what a user of these containers would have to do.  The
+// unordered_set scan is not ordered, of course; it is listed to show the raw cost.
+#include "cpatricia_set.h"
+#include "bench_perfctr.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <climits>
+
+namespace {
+
+// ------------------------------------------------------------
+// Byte accounting shared by all containers (single-threaded benchmarks)
+// ------------------------------------------------------------
+std::size_t g_live = 0;
+
+void *count_malloc(std::size_t n) {
+    auto *p = static_cast<std::size_t *>(std::malloc(n + sizeof(max_align_t)));
+    if (!p) return nullptr;
+    *p = n;
+    g_live += n;
+    return reinterpret_cast<char *>(p) + sizeof(max_align_t);
+}
+
+void count_free(void *obj) {
+    if (!obj) return;
+    auto *p = reinterpret_cast<std::size_t *>(static_cast<char *>(obj) - sizeof(max_align_t));
+    g_live -= *p;
+    std::free(p);
+}
+
+template <class T> struct CountAlloc {
+    using value_type = T;
+    CountAlloc() = default;
+    template <class U> CountAlloc(const CountAlloc<U> &) {}
+    T *allocate(std::size_t n) {
+        if (void *p = count_malloc(n * sizeof(T))) return static_cast<T *>(p);
+        throw std::bad_alloc();
+    }
+    void deallocate(T *p, std::size_t) { count_free(p); }
+    template <class U> bool operator==(const CountAlloc<U> &) const { return true; }
+    template <class U> bool operator!=(const CountAlloc<U> &) const { return false; }
+};
+
+using CString = std::basic_string<char, std::char_traits<char>, CountAlloc<char>>;
+
+struct CStringHash {
+    std::size_t operator()(const CString &s) const {
+        return std::hash<std::string_view>()(std::string_view(s.data(), s.size()));
+    }
+};
+
+// ------------------------------------------------------------
+// Containers behind one interface
+// ------------------------------------------------------------
+struct PatriciaAdapter {
+    static constexpr const char *name = "patricia";
+    static void *mf_alloc(void *, size_t n) { return count_malloc(n); }
+    static void  mf_free(void *, void *p)   { count_free(p); }
+    static constexpr PTMemFuncT mf = { mf_alloc, mf_free, nullptr };
+    PatriciaSetT t;
+
+    PatriciaAdapter()  { patriset_init_ex(&t, &mf, nullptr); }
+    ~PatriciaAdapter() { patriset_fini(&t); }
+    void insert(const std::string &k) { patriset_insert(&t, k.data(), uint16_t(k.size() * CHAR_BIT), nullptr); }
+    bool contains(const std::string &k) const { return patriset_lookup(&t, k.data(), uint16_t(k.size() * CHAR_BIT)); }
+    std::size_t prefix(const std::string &q) const {
+        const PTSetNodeT *np = patriset_prefix(&t, q.data(), uint16_t(q.size() * CHAR_BIT));
+        return np ? np->nbit / CHAR_BIT : 0;
+    }
+    std::size_t scan() {
+        PTSetIterT it;
+        std::size_t n = 0;
+        psetiter_init(&it, &t, nullptr, true, ePTMode_inOrder);
+        while (psetiter_next(&it)) ++n;
+        return n;
+    }
+    void erase(const std::string &k) { patriset_remove(&t, k.data(), uint16_t(k.size() * CHAR_BIT)); }
+};
+
+struct StdMapAdapter {
+    static constexpr const char *name = "std_map";
+    std::map<CString, char, std::less<CString>, CountAlloc<std::pair<const CString, char>>> m;
+
+    void insert(const std::string &k) { m.emplace(CString(k.data(), k.size()), 0); }
+    bool contains(const std::string &k) const { return m.count(CString(k.data(), k.size())); }
+    std::size_t prefix(const std::string &q) const {
+        for (std::size_t n = q.size(); n; --n)
+            if (m.count(CString(q.data(), n))) return n;
+        return 0;
+    }
+    std::size_t scan() { std::size_t n = 0; for (auto &e : m) n += !e.first.empty(); return n; }
+    void erase(const std::string &k) { m.erase(CString(k.data(), k.size())); }
+};
+
+struct UnorderedAdapter {
+    static constexpr const char *name = "unordered_set";
+    std::unordered_set<CString, CStringHash, std::equal_to<CString>, CountAlloc<CString>> s;
+
+    void insert(const std::string &k) { s.emplace(k.data(), k.size()); }
+    bool contains(const std::string &k) const { return s.count(CString(k.data(), k.size())); }
+    std::size_t prefix(const std::string &q) const {
+        for (std::size_t n = q.size(); n; --n)
+            if (s.count(CString(q.data(), n))) return n;
+        return 0;
+    }
+    std::size_t scan() { std::size_t n = 0; for (auto &e : s) n += !e.empty(); return n; }
+    void erase(const std::string &k) { s.erase(CString(k.data(), k.size())); }
+};
+
+// Sorted vector: inserts append, the first query sorts (bulk-load semantics)
+struct SortedVecAdapter {
+    static constexpr const char *name = "sorted_vector";
+    std::vector<CString, CountAlloc<CString>> v;
+    bool sorted = true;
+
+    void insert(const std::string &k) { v.emplace_back(k.data(), k.size()); sorted = false; }
+    void settle() {
+        if (!sorted) {
+            std::sort(v.begin(), v.end());
+            v.erase(std::unique(v.begin(), v.end()), v.end());
+            sorted = true;
+        }
+    }
+    bool has(std::string_view k) const {
+        auto it = std::lower_bound(v.begin(), v.end(), k,
+            [](const CString &a, std::string_view b) { return std::string_view(a.data(), a.size()) < b; });
+        return it != v.end() && std::string_view(it->data(), it->size()) == k;
+    }
+    bool contains(const std::string &k) const { return has(k); }
+    std::size_t prefix(const std::string &q) const {
+        for (std::size_t n = q.size(); n; --n)
+            if (has(std::string_view(q.data(), n))) return n;
+        return 0;
+    }
+    std::size_t scan() { std::size_t n = 0; for (auto &e : v) n += !e.empty(); return n; }
+    void erase(const std::string &k) {
+        auto it = std::lower_bound(v.begin(), v.end(), k,
+            [](const CString &a, const std::string &b) { return std::string_view(a.data(), a.size()) < b; });
+        if (it != v.end() && std::string_view(it->data(), it->size()) == k) v.erase(it);
+    }
+};
+
+// Plain crit-bit tree: internal nodes hold a byte index and a one-bit mask; leaves hold
+// the key.  The low pointer bit tags internal nodes.
+struct CritBitAdapter {
+    static constexpr const char *name = "critbit";
+    struct Leaf  { std::size_t len; char data[1]; };
+    struct Inner { void *child[2]; std::size_t byte; uint8_t otherbits; };
+    void *root = nullptr;
+
+    static bool   is_inner(void *p) { return reinterpret_cast<uintptr_t>(p) & 1; }
+    static Inner *inner(void *p)    { return reinterpret_cast<Inner *>(reinterpret_cast<uintptr_t>(p) - 1); }
+    static void  *tag(Inner *q)     { return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(q) + 1); }
+    static Leaf  *leaf(void *p)     { return static_cast<Leaf *>(p); }
+
+    static int dir(const Inner *q, const char *k, std::size_t len) {
+        uint8_t c = q->byte < len ? uint8_t(k[q->byte]) : 0;
+        return (1 + (q->otherbits | c)) >> 8;
+    }
+    Leaf *find(const char *k, std::size_t len) const {
+        void *p = root;
+        if (!p) return nullptr;
+        while (is_inner(p)) p = inner(p)->child[dir(inner(p), k, len)];
+        return leaf(p);
+    }
+    bool has(const char *k, std::size_t len) const {
+        Leaf *l = find(k, len);
+        return l && l->len == len && 0 == std::memcmp(l->data, k, len);
+    }
+
+    ~CritBitAdapter() { destroy(root); }
+    static void destroy(void *p) {
+        if (!p) return;
+        if (is_inner(p)) {
+            destroy(inner(p)->child[0]);
+            destroy(inner(p)->child[1]);
+            count_free(inner(p));
+        } else {
+            count_free(p);
+        }
+    }
+    void insert(const std::string &k) {
+        const char *u = k.data();
+        std::size_t len = k.size();
+        Leaf *nl = nullptr;
+        if (!root) {
+            nl = static_cast<Leaf *>(count_malloc(offsetof(Leaf, data) + len));
+            nl->len = len;
+            std::memcpy(nl->data, u, len);
+            root = nl;
+            return;
+        }
+        Leaf *best = find(u, len);
+        // find the critical byte and bit
+        std::size_t newbyte;
+        uint32_t newotherbits = 0;
+        for (newbyte = 0; newbyte < len; ++newbyte) {
+            uint8_t b = newbyte < best->len ? uint8_t(best->data[newbyte]) : 0;
+            if (b != uint8_t(u[newbyte])) { newotherbits = b ^ uint8_t(u[newbyte]); break; }
+        }
+        if (newbyte == len) {
+            if (best->len == len) return; // present
+            for (; newbyte < best->len; ++newbyte)
+                if (best->data[newbyte]) { newotherbits = uint8_t(best->data[newbyte]); break; }
+            if (newbyte == best->len) return; // differs only in trailing NULs -- treat as dup
+        }
+        while (newotherbits & (newotherbits - 1)) newotherbits &= newotherbits - 1;
+        newotherbits ^= 255;
+        uint8_t c = newbyte < best->len ? uint8_t(best->data[newbyte]) : 0;
+        int newdir = (1 + (newotherbits | c)) >> 8;
+
+        nl = static_cast<Leaf *>(count_malloc(offsetof(Leaf, data) + len));
+        nl->len = len;
+        std::memcpy(nl->data, u, len);
+        Inner *nn = static_cast<Inner *>(count_malloc(sizeof(Inner)));
+        nn->byte = newbyte;
+        nn->otherbits = uint8_t(newotherbits);
+        nn->child[1 - newdir] = nl;
+
+        void **wherep = &root;
+        for (;;) {
+            void *p = *wherep;
+            if (!is_inner(p)) break;
+            Inner *q = inner(p);
+            if (q->byte > newbyte) break;
+            if (q->byte == newbyte && q->otherbits > newotherbits) break;
+            wherep = &q->child[dir(q, u, len)];
+        }
+        nn->child[newdir] = *wherep;
+        *wherep = tag(nn);
+    }
+    bool contains(const std::string &k) const { return has(k.data(), k.size()); }
+    std::size_t prefix(const std::string &q) const {
+        for (std::size_t n = q.size(); n; --n)
+            if (has(q.data(), n)) return n;
+        return 0;
+    }
+    std::size_t scan() {
+        std::size_t n = 0;
+        std::vector<void *> stk;
+        if (root) stk.push_back(root);
+        while (!stk.empty()) {
+            void *p = stk.back();
+            stk.pop_back();
+            if (is_inner(p)) {
+                stk.push_back(inner(p)->child[1]);
+                stk.push_back(inner(p)->child[0]);
+            } else {
+                ++n;
+            }
+        }
+        return n;
+    }
+    void erase(const std::string &k) {
+        const char *u = k.data();
+        std::size_t len = k.size();
+        void **wherep = &root, **whereq = nullptr;
+        Inner *q = nullptr;
+        int d = 0;
+        if (!root) return;
+        void *p = root;
+        while (is_inner(p)) {
+            whereq = wherep;
+            q = inner(p);
+            d = dir(q, u, len);
+            wherep = &q->child[d];
+            p = *wherep;
+        }
+        Leaf *l = leaf(p);
+        if (l->len != len || std::memcmp(l->data, u, len)) return;
+        count_free(l);
+        if (!whereq) { root = nullptr; return; }
+        *whereq = q->child[1 - d];
+        count_free(q);
+    }
+};
+
+enum class Op { Insert, Hit, Miss, Prefix, Scan, Remove, Teardown };
+
+template <class C>
+void BM_Cmp(benchmark::State &state, Op op) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    const auto keys = generate_random_strings(N, 16, 12345);
+    std::vector<std::string> probe;
+    if (op == Op::Miss) {
+        probe = generate_random_strings(N, 16, 54321);
+    } else if (op == Op::Prefix) {
+        probe = keys;
+        for (auto &s : probe) s += "/suffix";
+    } else {
+        probe = keys;
+        std::shuffle(probe.begin(), probe.end(), std::mt19937(7));
+    }
+
+    auto build = [&](C &c) {
+        for (auto &k : keys) c.insert(k);
+        if constexpr (std::is_same_v<C, SortedVecAdapter>) c.settle();
+    };
+
+    double bytes = 0.0;
+    std::size_t sink = 0;
+    PerfCounters pc;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::size_t base = g_live;
+        C *c = new C;
+        if (op != Op::Insert) build(*c);
+        bytes = double(g_live - base);
+        state.ResumeTiming();
+
+        pc.start();
+        switch (op) {
+        case Op::Insert:
+            build(*c);
+            break;
+        case Op::Hit: case Op::Miss:
+            for (auto &k : probe) sink += c->contains(k);
+            break;
+        case Op::Prefix:
+            for (auto &k : probe) sink += c->prefix(k);
+            break;
+        case Op::Scan:
+            sink += c->scan();
+            break;
+        case Op::Remove:
+            for (auto &k : probe) c->erase(k);
+            break;
+        case Op::Teardown:
+            delete c;
+            c = nullptr;
+            break;
+        }
+        pc.stop();
+
+        state.PauseTiming();
+        if (op == Op::Insert) bytes = double(g_live - base);
+        delete c;
+        state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(sink);
+    state.SetItemsProcessed(state.iterations() * N);
+    state.counters["bytes/key"] = bytes / double(N);
+    pc.report(state, double(state.iterations() * N));
+}
+
+int register_compare() {
+    static const struct { const char *name; Op op; } ops[] = {
+        {"insert", Op::Insert}, {"hit", Op::Hit}, {"miss", Op::Miss}, {"prefix", Op::Prefix},
+        {"scan", Op::Scan}, {"remove", Op::Remove}, {"teardown", Op::Teardown},
+    };
+    for (auto &o : ops) {
+        std::string name = std::string("BM_Cmp/") + o.name + "/";
+        benchmark::RegisterBenchmark((name + PatriciaAdapter::name).c_str(), BM_Cmp<PatriciaAdapter>, o.op)
+            ->Arg(10000)->Arg(100000);
+        benchmark::RegisterBenchmark((name + CritBitAdapter::name).c_str(), BM_Cmp<CritBitAdapter>, o.op)
+            ->Arg(10000)->Arg(100000);
+        benchmark::RegisterBenchmark((name + StdMapAdapter::name).c_str(), BM_Cmp<StdMapAdapter>, o.op)
+            ->Arg(10000)->Arg(100000);
+        benchmark::RegisterBenchmark((name + UnorderedAdapter::name).c_str(), BM_Cmp<UnorderedAdapter>, o.op)
+            ->Arg(10000)->Arg(100000);
+        // removing all keys one by one from a vector is quadratic -- keep it small
+        auto *sv = benchmark::RegisterBenchmark((name + SortedVecAdapter::name).c_str(),
+                                                BM_Cmp<SortedVecAdapter>, o.op)->Arg(10000);
+        if (o.op != Op::Remove) sv->Arg(100000);
+    }
+    return 0;
+}
+
+const int registered = register_compare();
+
+} // namespace
@@ -0,0 +1,146 @@
+// ===================== bench_elide.cpp =====================
+// Prefix-elided key storage against the plain set, on URL-like keys: a few hundred hosts
+// under a handful of schemes, with paths built from a small vocabulary.  Such keys share
+// long prefixes, which the elided set does not store again in every node.
+//
+// Reported through google-benchmark counters:
+//
+//  - bytes/key    : bytes requested from the memory policy, per key
+//  - usable/key   : bytes actually handed out by malloc (malloc_usable_size), per key
+//  - saved%       : elide only -- requested bytes saved against the plain set
+//
+// The benchmark time is the time of one lookup, either for keys in the set (hit) or for
+// keys that differ from a stored key in the last byte (miss).
+//
+// Benchmarks are registered as  BM_Elide/<set|elide>/<hit|miss>/N:<N>
+#include "cpatricia_set.h"
+#include "cpatricia_elide.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+#if defined(__linux__)
+# include <malloc.h>
+#endif
+
+namespace {
+
+// ------------------------------------------------------------
+// Counting policy
+// ------------------------------------------------------------
+struct Account {
+    std::size_t bytes = 0;      // requested bytes
+    std::size_t usable = 0;     // malloc usable bytes
+};
+
+void *cnt_alloc(void *a, size_t n) {
+    void *p = std::malloc(n);
+    if (p) {
+        static_cast<Account *>(a)->bytes += n;
+#if defined(__linux__)
+        static_cast<Account *>(a)->usable += malloc_usable_size(p);
+#else
+        static_cast<Account *>(a)->usable += n;
+#endif
+    }
+    return p;
+}
+void cnt_free(void *, void *p) { std::free(p); }
+
+const PTMemFuncT mf_count = {cnt_alloc, cnt_free, nullptr};
+
+// ------------------------------------------------------------
+// URL-like key set, deterministic for a given N
+// ------------------------------------------------------------
+std::vector<std::string> make_urls(std::size_t n) {
+    static const char *const scheme[] = {"https://", "http://"};
+    static const char *const tld[]    = {"com", "org", "net", "de", "io"};
+    static const char *const words[]  = {
+        "api", "v1", "v2", "users", "items", "search", "static", "images", "docs",
+        "blog", "2024", "2025", "archive", "category", "product", "details", "en", "de",
+    };
+    std::mt19937_64 rng(0xE11DEull);
+    std::vector<std::string> out;
+    out.reserve(n);
+    char buf[64];
+    for (std::size_t i = 0; i < n; ++i) {
+        const unsigned host = unsigned(rng() % 500);
+        std::string url = scheme[host % 10 == 0];
+        std::snprintf(buf, sizeof(buf), "www.site%03u.example.%s/", host, tld[host % 5]);
+        url += buf;
+        for (unsigned seg = 1 + unsigned(rng() % 4); seg; --seg) {
+            url += words[rng() % (sizeof(words) / sizeof(words[0]))];
+            url += '/';
+        }
+        std::snprintf(buf, sizeof(buf), "page-%zu.html", i);
+        url += buf;
+        out.push_back(std::move(url));
+    }
+    return out;
+}
+
+uint16_t bits(const std::string &s) { return uint16_t(s.size() * CHAR_BIT); }
+
+void BM_Elide(benchmark::State &state, bool elide, bool hit) {
+    const std::size_t n = std::size_t(state.range(0));
+    const auto urls = make_urls(n);
+
+    // probe keys in random order; misses change the last byte of a stored key
+    std::vector<std::string> probe(urls);
+    std::shuffle(probe.begin(), probe.end(), std::mt19937(7));
+    if (!hit) {
+        for (auto &p : probe) p.back() ^= 0x20;
+    }
+
+    Account acc_set, acc_elide;
+    PatriciaSetT   set;
+    PatriciaElideT eset;
+    patriset_init_ex(&set, &mf_count, &acc_set);
+    for (const auto &u : urls) patriset_insert(&set, u.data(), bits(u), nullptr);
+    if (elide) {
+        patrielide_init_ex(&eset, &mf_count, &acc_elide);
+        for (const auto &u : urls) patrielide_insert(&eset, u.data(), bits(u), nullptr);
+    }
+
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const std::string &k = probe[i];
+        const PTSetNodeT *np = elide ? patrielide_lookup(&eset, k.data(), bits(k))
+                                     : patriset_lookup(&set, k.data(), bits(k));
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == n) i = 0;
+    }
+    if ((found != 0) != hit) {
+        state.SkipWithError("unexpected lookup result");
+    }
+
+    const Account &acc = elide ? acc_elide : acc_set;
+    state.counters["bytes/key"]  = double(acc.bytes) / double(n);
+    state.counters["usable/key"] = double(acc.usable) / double(n);
+    if (elide) {
+        state.counters["saved%"] = 100.0 * (1.0 - double(acc_elide.bytes) / double(acc_set.bytes));
+    }
+    if (elide) patrielide_fini(&eset);
+    patriset_fini(&set);
+}
+
+int register_elide() {
+    for (bool elide : {false, true}) {
+        for (bool hit : {true, false}) {
+            std::string name = std::string("BM_Elide/") + (elide ? "elide" : "set") + (hit ? "/hit" : "/miss");
+            benchmark::RegisterBenchmark(name.c_str(), BM_Elide, elide, hit)
+                ->ArgName("N")->Arg(100000)->Arg(1000000);
+        }
+    }
+    return 0;
+}
+
+const int registered = register_elide();
+
+} // namespace
@@ -0,0 +1,78 @@
+// ===================== bench_fixed.cpp =====================
+// Keys of one length (32-bit addresses, 128-bit UUIDs): the plain set against the
+// fixed-length set.  The fixed set extracts bits without clamping, compares keys as
+// integers without a length check, and its nodes carry no key length or NUL byte.
+//
+// Benchmarks are registered as  BM_FixedLen/<plain|fixed>/bits:<B>/N:<N>
+// and report the time of one successful lookup in random order.
+// Counters:
+//  - node bytes : bytes requested per node
+#include "cpatricia_set.h"
+#include "cpatricia_fixed.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+void BM_FixedLen(benchmark::State &state, bool fixed) {
+    const uint16_t    bits   = uint16_t(state.range(0));
+    const std::size_t n      = std::size_t(state.range(1));
+    const std::size_t nbytes = bits / CHAR_BIT;
+    std::mt19937_64 rng(23);
+    std::vector<unsigned char> keys(n * nbytes);
+    for (auto &c : keys) c = static_cast<unsigned char>(rng());
+
+    PatriciaSetT set;
+    PatriciaFixT fix;
+    if (fixed) {
+        patrifix_init(&fix, bits);
+        for (std::size_t i = 0; i < n; ++i) patrifix_insert(&fix, &keys[i * nbytes], bits, nullptr);
+    } else {
+        patriset_init(&set);
+        for (std::size_t i = 0; i < n; ++i) patriset_insert(&set, &keys[i * nbytes], bits, nullptr);
+    }
+    std::vector<uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = uint32_t(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(29));
+
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const unsigned char *k = &keys[std::size_t(order[i]) * nbytes];
+        const void *np = fixed ? static_cast<const void *>(patrifix_lookup(&fix, k, bits))
+                               : static_cast<const void *>(patriset_lookup(&set, k, bits));
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == n) i = 0;
+    }
+    if (found != std::size_t(state.iterations())) {
+        state.SkipWithError("lookup missed");
+    }
+    state.counters["node bytes"] = fixed ? double(PATRIFIX_NODE_SIZE(bits))
+                                         : double(offsetof(PTSetNodeT, data) + nbytes + 1);
+    if (fixed) {
+        patrifix_fini(&fix);
+    } else {
+        patriset_fini(&set);
+    }
+}
+
+int register_fixed() {
+    for (bool fixed : {false, true}) {
+        std::string name = std::string("BM_FixedLen/") + (fixed ? "fixed" : "plain");
+        auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_FixedLen, fixed);
+        b->ArgNames({"bits", "N"});
+        for (int64_t bits : {32, 128}) {
+            for (int64_t n : {10000, 1000000}) b->Args({bits, n});
+        }
+    }
+    return 0;
+}
+
+const int registered = register_fixed();
+
+} // namespace
@@ -0,0 +1,84 @@
+// ===================== bench_iovec.cpp =====================
+// Composite keys spread over several buffers (tenant id, table id, row key): copying the
+// parts into a scratch buffer before every lookup, against handing the parts over as
+// segments to patriset_lookup_v().  Row keys are 24 bytes, so all segments are byte
+// multiples -- the common case, where runs inside a segment are compared with memcmp.
+//
+// Benchmarks are registered as  BM_Iovec/<gather|segments>/N:<N>
+// and report the time of one successful lookup in random order.
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+constexpr std::size_t kRowLen = 24;
+
+struct Row {
+    uint32_t tenant;
+    uint32_t table;
+    char     row[kRowLen];
+};
+
+void BM_Iovec(benchmark::State &state, bool segments) {
+    const std::size_t n = std::size_t(state.range(0));
+    std::mt19937_64 rng(3);
+    std::vector<Row> rows(n);
+    PatriciaSetT set;
+    patriset_init(&set);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        rows[i].tenant = uint32_t(rng() % 16);
+        rows[i].table  = uint32_t(rng() % 64);
+        for (auto &c : rows[i].row) c = char('a' + rng() % 26);
+        PTKeySegT seg[3] = {
+            {&rows[i].tenant, 32}, {&rows[i].table, 32}, {rows[i].row, kRowLen * CHAR_BIT},
+        };
+        patriset_insert_v(&set, seg, 3, nullptr);
+    }
+    std::vector<uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = uint32_t(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(5));
+
+    char scratch[sizeof(Row)];
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const Row &r = rows[order[i]];
+        const PTSetNodeT *np;
+        if (segments) {
+            PTKeySegT seg[3] = {{&r.tenant, 32}, {&r.table, 32}, {r.row, kRowLen * CHAR_BIT}};
+            np = patriset_lookup_v(&set, seg, 3);
+        } else {
+            std::memcpy(scratch, &r.tenant, 4);
+            std::memcpy(scratch + 4, &r.table, 4);
+            std::memcpy(scratch + 8, r.row, kRowLen);
+            np = patriset_lookup(&set, scratch, uint16_t((8 + kRowLen) * CHAR_BIT));
+        }
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == n) i = 0;
+    }
+    if (found != std::size_t(state.iterations())) {
+        state.SkipWithError("lookup missed");
+    }
+    patriset_fini(&set);
+}
+
+int register_iovec() {
+    for (bool segments : {false, true}) {
+        std::string name = std::string("BM_Iovec/") + (segments ? "segments" : "gather");
+        benchmark::RegisterBenchmark(name.c_str(), BM_Iovec, segments)
+            ->ArgName("N")->Arg(10000)->Arg(1000000);
+    }
+    return 0;
+}
+
+const int registered = register_iovec();
+
+} // namespace
@@ -0,0 +1,188 @@
+// ===================== bench_iterator.cpp =====================
+// Iterator cost: full scans in all three modes and both directions, zig-zag next/prev
+// stepping, and subtree-rooted iteration, on trees of different depth:
+//
+//  - random : 16-byte random strings, depth ~ log2(N)
+//  - seq    : sequential 32-bit integers, balanced-ish but deeper than random
+//  - chain  : one-hot bit strings, depth = N (worst case for the bounded parent FIFO)
+//
+// The parent FIFO capacity is a compile-time knob (PATRICIA_ITER_PSTK, default 8).  If
+// the library is built with PATRICIA_ITER_STATS, each benchmark also reports how many
+// parent recovery walks ('rewalks') were needed per 1000 steps.  The 'pstk' and 'depth'
+// counters make the results comparable across builds.
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+enum class Shape { Random, Seq, Chain };
+
+struct Tree {
+    PatriciaSetT set;
+    unsigned     depth = 0;
+
+    Tree(Shape shape, std::size_t n) {
+        patriset_init(&set);
+        std::mt19937 rng(12345);
+        std::string k;
+        for (std::size_t i = 0; i < n; ++i) {
+            switch (shape) {
+            case Shape::Random:
+                k.resize(16);
+                for (auto &c : k) c = char('a' + rng() % 26);
+                break;
+            case Shape::Seq:
+                k.assign({char(i >> 24), char(i >> 16), char(i >> 8), char(i)});
+                break;
+            case Shape::Chain:
+                k.assign((n + 8) / 8, '\0');
+                k[i / 8] = char(0x80u >> (i % 8));
+                break;
+            }
+            patriset_insert(&set, k.data(), uint16_t(k.size() * CHAR_BIT), nullptr);
+        }
+        depth = max_depth(set._m_root->_m_child[0], set._m_root->bpos);
+    }
+    ~Tree() { patriset_fini(&set); }
+
+    // iterative max depth over downlinks
+    static unsigned max_depth(const PTSetNodeT *top, uint16_t above) {
+        struct Item { const PTSetNodeT *node; unsigned depth; };
+        std::vector<Item> stk;
+        unsigned best = 0;
+        if (top->bpos > above) stk.push_back({top, 1});
+        while (!stk.empty()) {
+            Item it = stk.back();
+            stk.pop_back();
+            best = std::max(best, it.depth);
+            for (int i = 0; i < 2; ++i) {
+                const PTSetNodeT *c = it.node->_m_child[i];
+                if (c->bpos > it.node->bpos) stk.push_back({c, it.depth + 1});
+            }
+        }
+        return best;
+    }
+};
+
+void report(benchmark::State &state, const Tree &t, std::size_t steps, unsigned rewalks) {
+    state.counters["depth"] = t.depth;
+    state.counters["pstk"]  = PATRICIA_ITER_PSTK;
+#ifdef PATRICIA_ITER_STATS
+    state.counters["rewalks/1k"] = steps ? 1000.0 * double(rewalks) / double(steps) : 0.0;
+#else
+    (void)rewalks;
+#endif
+    state.SetItemsProcessed(int64_t(steps));
+}
+
+unsigned rewalks_of(const PTSetIterT &it) {
+#ifdef PATRICIA_ITER_STATS
+    return it.rwcount;
+#else
+    (void)it;
+    return 0;
+#endif
+}
+
+std::size_t tree_size(Shape s) { return s == Shape::Chain ? 2000 : 100000; }
+
+// ------------------------------------------------------------
+// Full scan: every mode, both directions
+// ------------------------------------------------------------
+void BM_IterScan(benchmark::State &state, Shape shape, EPTIterMode mode, bool dir) {
+    Tree t(shape, tree_size(shape));
+    std::size_t steps = 0;
+    unsigned rewalks = 0;
+    for (auto _ : state) {
+        PTSetIterT it;
+        psetiter_init(&it, &t.set, nullptr, dir, mode);
+        while (psetiter_next(&it)) ++steps;
+        rewalks += rewalks_of(it);
+    }
+    report(state, t, steps, rewalks);
+}
+
+// ------------------------------------------------------------
+// Zig-zag: two steps forward, one step back, until the end
+// ------------------------------------------------------------
+void BM_IterZigZag(benchmark::State &state, Shape shape, EPTIterMode mode) {
+    Tree t(shape, tree_size(shape));
+    std::size_t steps = 0;
+    unsigned rewalks = 0;
+    for (auto _ : state) {
+        PTSetIterT it;
+        psetiter_init(&it, &t.set, nullptr, true, mode);
+        while (psetiter_next(&it) && psetiter_next(&it)) {
+            benchmark::DoNotOptimize(psetiter_prev(&it));
+            benchmark::DoNotOptimize(psetiter_next(&it));
+            steps += 4;
+        }
+        rewalks += rewalks_of(it);
+    }
+    report(state, t, steps, rewalks);
+}
+
+// ------------------------------------------------------------
+// Subtree iteration: start at the node 'level' downlinks below the top, following
+// random bits; iterate its subtree in order.  Deeper levels mean smaller subtrees.
+// ------------------------------------------------------------
+void BM_IterSubtree(benchmark::State &state, Shape shape) {
+    const unsigned level = unsigned(state.range(0));
+    Tree t(shape, tree_size(shape));
+    std::mt19937 rng(77);
+    std::vector<const PTSetNodeT *> roots;
+    for (int r = 0; r < 64; ++r) {
+        const PTSetNodeT *node = t.set._m_root->_m_child[0];
+        for (unsigned l = 0; l < level; ++l) {
+            const PTSetNodeT *next = node->_m_child[rng() & 1];
+            if (next->bpos <= node->bpos) next = node->_m_child[0];
+            if (next->bpos <= node->bpos) break;
+            node = next;
+        }
+        roots.push_back(node);
+    }
+    std::size_t steps = 0;
+    unsigned rewalks = 0;
+    for (auto _ : state) {
+        for (auto *root : roots) {
+            PTSetIterT it;
+            psetiter_init(&it, &t.set, root, true, ePTMode_inOrder);
+            while (psetiter_next(&it)) ++steps;
+            rewalks += rewalks_of(it);
+        }
+    }
+    report(state, t, steps, rewalks);
+}
+
+int register_iterator() {
+    static const struct { const char *name; Shape shape; } shapes[] = {
+        {"random", Shape::Random}, {"seq", Shape::Seq}, {"chain", Shape::Chain},
+    };
+    static const struct { const char *name; EPTIterMode mode; } modes[] = {
+        {"pre", ePTMode_preOrder}, {"in", ePTMode_inOrder}, {"post", ePTMode_postOrder},
+    };
+    for (auto &s : shapes) {
+        for (auto &m : modes) {
+            for (int dir = 1; dir >= 0; --dir) {
+                std::string name = std::string("BM_IterScan/") + s.name + "/" + m.name + (dir ? "/ltr" : "/rtl");
+                benchmark::RegisterBenchmark(name.c_str(), BM_IterScan, s.shape, m.mode, bool(dir));
+            }
+            std::string name = std::string("BM_IterZigZag/") + s.name + "/" + m.name;
+            benchmark::RegisterBenchmark(name.c_str(), BM_IterZigZag, s.shape, m.mode);
+        }
+        std::string name = std::string("BM_IterSubtree/") + s.name;
+        benchmark::RegisterBenchmark(name.c_str(), BM_IterSubtree, s.shape)
+            ->ArgName("level")->Arg(1)->Arg(4)->Arg(8)->Arg(12);
+    }
+    return 0;
+}
+
+const int registered = register_iterator();
+
+} // namespace
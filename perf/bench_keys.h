@@ -0,0 +1,46 @@
+// ===================== bench_keys.h =====================
+// Key generators shared by the benchmarks.
+//
+// The generators are deterministic: the same arguments give the same keys, so runs
+// and benchmarks that share a key set can be compared.
+#ifndef BENCH_KEYS_H_
+#define BENCH_KEYS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Helper: generate random strings of 'len' characters from [a-z0-9]
+static inline std::vector<std::string> generate_random_strings(std::size_t count, std::size_t len,
+                                                               unsigned seed = 12345) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, sizeof(alphabet) - 2);
+
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string s;
+        s.resize(len);
+        for (std::size_t j = 0; j < len; ++j) s[j] = alphabet[dist(rng)];
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+// Key 'i' of length 'len' (>= 4): a bijective scramble of the index up front keeps
+// keys distinct, the rest is deterministic filler.  Keys are made on the fly from the
+// index, so large key counts need no key store.
+static inline void make_key(char *buf, std::size_t len, uint64_t i) {
+    uint32_t h = uint32_t(i) * 2654435761u;
+    buf[0] = char(h >> 24); buf[1] = char(h >> 16); buf[2] = char(h >> 8); buf[3] = char(h);
+    uint64_t x = i;
+    for (std::size_t j = 4; j < len; ++j) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        buf[j] = char('a' + (x >> 59));
+    }
+}
+
+#endif // BENCH_KEYS_H_
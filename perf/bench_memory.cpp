@@ -0,0 +1,131 @@
+// ===================== bench_memory.cpp =====================
+// Memory footprint of sets and maps, reported through google-benchmark counters:
+//
+//  - bytes/key    : bytes requested from the memory policy, per key
+//  - usable/key   : bytes actually handed out by malloc (malloc_usable_size), per key
+//  - rss/key      : resident set size delta while the container is populated, per key;
+//                   malloc recycles memory freed by earlier runs, so use a filter that
+//                   selects a single benchmark when this number matters
+//  - allocs       : allocator calls needed to build the container
+//  - slack%       : arena only -- bytes consumed in the arena that were not requested
+//                   (alignment padding & block tails), relative to consumed bytes
+//
+// Policies: a counting wrapper around malloc (same behaviour as the default policy) and a
+// VmBumpPoolT arena, as used by the map under PATRIMAP_USE_ARENA.  The map default
+// policy (whatever the library was built with) is covered as well.
+//
+// Keys are generated on the fly from the key index, so N can go up to 10M without a
+// key store.  Combinations that would need more than ~1 GiB of key bytes are skipped.
+// Benchmarks are registered as  BM_Mem/<set|map>/<malloc|arena|default>/keylen:<L>/N:<N>
+#include "cpatricia_set.h"
+#include "cpatricia_map.h"
+#include "vmbumppool.h"
+#include "bench_alloc.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <climits>
+#if defined(__linux__)
+# include <unistd.h>
+#endif
+
+namespace {
+
+// ------------------------------------------------------------
+// RSS probe (Linux /proc); returns 0 where not available
+// ------------------------------------------------------------
+std::size_t rss_bytes() {
+#if defined(__linux__)
+    long pages = 0, resident = 0;
+    if (FILE *fp = std::fopen("/proc/self/statm", "r")) {
+        if (2 != std::fscanf(fp, "%ld %ld", &pages, &resident)) resident = 0;
+        std::fclose(fp);
+    }
+    return std::size_t(resident) * std::size_t(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+enum class Kind { SetMalloc, SetArena, MapMalloc, MapArena, MapDefault };
+
+void BM_Mem(benchmark::State &state, Kind kind) {
+    const std::size_t len = static_cast<std::size_t>(state.range(0));
+    const std::size_t N   = static_cast<std::size_t>(state.range(1));
+    const bool is_map = kind >= Kind::MapMalloc;
+    const bool arena  = kind == Kind::SetArena || kind == Kind::MapArena;
+    std::string key(len, '\0');
+
+    for (auto _ : state) {
+        Account acc;
+        VmBumpPoolT pool;
+        PatriciaSetT set;
+        PatriciaMapT map;
+
+        if (arena) {
+            vmBump_init(&pool, 1u << 20, 8192);   // 1 MiB blocks, 8 GiB limit
+            acc.pool = &pool;
+        }
+        switch (kind) {
+        case Kind::SetMalloc:  patriset_init_ex(&set, &mf_set_malloc, &acc); break;
+        case Kind::SetArena:   patriset_init_ex(&set, &mf_set_bump, &acc);   break;
+        case Kind::MapMalloc:  patrimap_init_ex(&map, &mf_map_malloc, &acc); break;
+        case Kind::MapArena:   patrimap_init_ex(&map, &mf_map_bump, &acc);   break;
+        case Kind::MapDefault: patrimap_init(&map);                          break;
+        }
+
+        std::size_t rss0 = rss_bytes();
+        for (std::size_t i = 0; i < N; ++i) {
+            make_key(&key[0], len, i);
+            if (is_map) {
+                patrimap_insert(&map, key.data(), uint16_t(len * CHAR_BIT), nullptr);
+            } else {
+                patriset_insert(&set, key.data(), uint16_t(len * CHAR_BIT), nullptr);
+            }
+        }
+        std::size_t rss1 = rss_bytes();
+
+        state.PauseTiming();
+        state.counters["rss/key"] = rss1 > rss0 ? double(rss1 - rss0) / double(N) : 0.0;
+        if (kind != Kind::MapDefault) {
+            state.counters["bytes/key"] = double(acc.bytes) / double(N);
+            state.counters["allocs"]    = double(acc.calls);
+        }
+        if (kind == Kind::SetMalloc || kind == Kind::MapMalloc) {
+            state.counters["usable/key"] = double(acc.usable) / double(N);
+        }
+        if (arena) {
+            std::size_t total = vmBump_getattr(&pool, eVmBumpAtt_Total);
+            state.counters["slack%"] = total ? 100.0 * double(total - acc.bytes) / double(total) : 0.0;
+        }
+        if (is_map) patrimap_fini(&map); else patriset_fini(&set);
+        if (arena) vmBump_fini(&pool);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+int register_memory() {
+    static const struct { const char *name; Kind kind; } kinds[] = {
+        {"set/malloc", Kind::SetMalloc}, {"set/arena", Kind::SetArena},
+        {"map/malloc", Kind::MapMalloc}, {"map/arena", Kind::MapArena},
+        {"map/default", Kind::MapDefault},
+    };
+    for (auto &k : kinds) {
+        auto *b = benchmark::RegisterBenchmark((std::string("BM_Mem/") + k.name).c_str(), BM_Mem, k.kind);
+        b->ArgNames({"keylen", "N"})->Unit(benchmark::kMillisecond)->Iterations(1);
+        for (int64_t len : {4, 16, 64, 256}) {
+            for (int64_t n : {10000, 100000, 1000000, 10000000}) {
+                if (len * n <= (int64_t(1) << 30)) b->Args({len, n});
+            }
+        }
+    }
+    return 0;
+}
+
+const int registered = register_memory();
+
+} // namespace
@@ -0,0 +1,124 @@
+// ===================== bench_perfctr.h =====================
+// Optional hardware performance counters for the benchmarks (Linux perf_event_open).
+//
+// Set PATRICIAC_PERF_COUNTERS=1 in the environment to enable them.  A benchmark owns a
+// PerfCounters object, brackets the measured code with start()/stop() -- usually next
+// to ResumeTiming()/PauseTiming() -- and calls report() with the number of operations.
+// Counters are added per operation:
+//
+//   cycles/op, instr/op, L1d-miss/op, LLC-miss/op, dTLB-miss/op, br-miss/op
+//
+// Only user space of the calling thread is counted.  Events the CPU or hypervisor does
+// not offer are left out; if perf events are not permitted at all (see
+// /proc/sys/kernel/perf_event_paranoid) a note is printed once and the benchmarks run
+// without counters.  On other systems the class is an empty shell.
+#ifndef BENCH_PERFCTR_H_
+#define BENCH_PERFCTR_H_
+
+#include <benchmark/benchmark.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+class PerfCounters {
+public:
+    static constexpr int kMaxEvents = 6;
+
+#if defined(__linux__)
+    PerfCounters() {
+        if (!enabled()) return;
+        static const struct { uint32_t type; uint64_t config; const char *name; } events[kMaxEvents] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,    "cycles/op"},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,  "instr/op"},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D), "L1d-miss/op"},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL),  "LLC-miss/op"},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB), "dTLB-miss/op"},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "br-miss/op"},
+        };
+        for (auto &ev : events) {
+            int fd = open_event(ev.type, ev.config, m_leader);
+            if (fd < 0) {
+                if (m_leader < 0) {
+                    // the group leader (cycles) failed: nothing will work
+                    warn_once();
+                    return;
+                }
+                continue;
+            }
+            if (m_leader < 0) m_leader = fd;
+            m_fd[m_count]   = fd;
+            m_name[m_count] = ev.name;
+            ++m_count;
+        }
+        ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+    ~PerfCounters() {
+        for (int i = 0; i < m_count; ++i) close(m_fd[i]);
+    }
+
+    void start() { if (m_leader >= 0) ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP); }
+    void stop()  { if (m_leader >= 0) ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP); }
+
+    // add the per-operation counters; multiplexed counts are scaled up to the full time
+    void report(benchmark::State &state, double ops) const {
+        if (m_leader < 0 || ops <= 0.0) return;
+        uint64_t buf[3 + kMaxEvents] = {0};
+        if (read(m_leader, buf, sizeof(buf)) < ssize_t(3 * sizeof(uint64_t))) return;
+        const double scale = buf[2] ? double(buf[1]) / double(buf[2]) : 1.0;
+        for (int i = 0; i < m_count && uint64_t(i) < buf[0]; ++i) {
+            state.counters[m_name[i]] = double(buf[3 + i]) * scale / ops;
+        }
+    }
+
+private:
+    int         m_leader = -1;
+    int         m_count  = 0;
+    int         m_fd[kMaxEvents];
+    const char *m_name[kMaxEvents];
+
+    static constexpr uint64_t cache(uint64_t id) {
+        return id | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+
+    static bool enabled() {
+        const char *env = std::getenv("PATRICIAC_PERF_COUNTERS");
+        return env && *env && std::strcmp(env, "0");
+    }
+
+    static void warn_once() {
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            std::fprintf(stderr, "perf counters not available (%s); running without them\n",
+                         std::strerror(errno));
+        }
+    }
+
+    static int open_event(uint32_t type, uint64_t config, int group) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = (group < 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#else
+    void start() {}
+    void stop() {}
+    void report(benchmark::State &, double) const {}
+#endif
+};
+
+#endif // BENCH_PERFCTR_H_
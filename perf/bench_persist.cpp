@@ -0,0 +1,151 @@
+// ===================== bench_persist.cpp =====================
+// Persistent (path-copying) set against the mutable dual-use set:
+//  - insert & lookup throughput without any snapshots
+//  - insert throughput and extra memory per version with a snapshot every K inserts
+#include "cpatricia_set.h"
+#include "cpatricia_pers.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <climits>
+
+// Counting malloc policy: live bytes are tracked in the arena word.  Each block carries
+// its size in a header so the free hook can account for it.
+static void *count_alloc(void *arena, size_t bytes) {
+    auto *p = static_cast<size_t *>(std::malloc(bytes + sizeof(max_align_t)));
+    if (!p) return nullptr;
+    *p = bytes;
+    *static_cast<size_t *>(arena) += bytes;
+    return reinterpret_cast<char *>(p) + sizeof(max_align_t);
+}
+
+static void count_free(void *arena, void *obj) {
+    auto *p = reinterpret_cast<size_t *>(static_cast<char *>(obj) - sizeof(max_align_t));
+    *static_cast<size_t *>(arena) -= *p;
+    std::free(p);
+}
+
+static const PTMemFuncT count_memfunc = { count_alloc, count_free, nullptr };
+
+// ------------------------------------------------------------
+// Benchmark: insert, mutable set vs. persistent set (no snapshots)
+// ------------------------------------------------------------
+static void BM_Set_Insert(benchmark::State &state) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    auto keys = generate_random_strings(N, 16);
+    size_t live = 0;
+
+    for (auto _ : state) {
+        PatriciaSetT tree;
+        live = 0;
+        patriset_init_ex(&tree, &count_memfunc, &live);
+        for (auto &s : keys) {
+            patriset_insert(&tree, s.c_str(), s.length() * CHAR_BIT, nullptr);
+        }
+        state.PauseTiming();
+        state.counters["bytes/key"] = double(live) / double(N);
+        patriset_fini(&tree);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_Set_Insert)->Arg(1000)->Arg(10000)->Arg(50000);
+
+static void BM_Pers_Insert(benchmark::State &state) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    auto keys = generate_random_strings(N, 16);
+    size_t live = 0;
+
+    for (auto _ : state) {
+        PatriciaPersT tree;
+        live = 0;
+        patripers_init_ex(&tree, &count_memfunc, &live);
+        for (auto &s : keys) {
+            patripers_insert(&tree, s.c_str(), s.length() * CHAR_BIT, nullptr);
+        }
+        state.PauseTiming();
+        state.counters["bytes/key"] = double(live) / double(N);
+        patripers_fini(&tree);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_Pers_Insert)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// ------------------------------------------------------------
+// Benchmark: lookup, mutable set vs. persistent set
+// ------------------------------------------------------------
+static void BM_Set_Lookup(benchmark::State &state) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    auto keys = generate_random_strings(N, 16);
+    PatriciaSetT tree;
+    patriset_init(&tree);
+    for (auto &s : keys) {
+        patriset_insert(&tree, s.c_str(), s.length() * CHAR_BIT, nullptr);
+    }
+    for (auto _ : state) {
+        for (auto &s : keys) {
+            benchmark::DoNotOptimize(patriset_lookup(&tree, s.c_str(), s.length() * CHAR_BIT));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+    patriset_fini(&tree);
+}
+BENCHMARK(BM_Set_Lookup)->Arg(1000)->Arg(10000)->Arg(50000);
+
+static void BM_Pers_Lookup(benchmark::State &state) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    auto keys = generate_random_strings(N, 16);
+    PatriciaPersT tree;
+    patripers_init(&tree);
+    for (auto &s : keys) {
+        patripers_insert(&tree, s.c_str(), s.length() * CHAR_BIT, nullptr);
+    }
+    for (auto _ : state) {
+        for (auto &s : keys) {
+            benchmark::DoNotOptimize(patripers_lookup(&tree, s.c_str(), s.length() * CHAR_BIT));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+    patripers_fini(&tree);
+}
+BENCHMARK(BM_Pers_Lookup)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// ------------------------------------------------------------
+// Benchmark: insert 10k keys, keeping a snapshot every K inserts.
+// 'bytes/version' is the memory on top of the final version alone, divided by the
+// number of retained versions -- i.e. the price of one O(1) snapshot.
+// ------------------------------------------------------------
+static void BM_Pers_InsertSnapshots(benchmark::State &state) {
+    const std::size_t N = 10000;
+    const std::size_t K = static_cast<std::size_t>(state.range(0));
+    auto keys = generate_random_strings(N, 16);
+    std::vector<PatriciaPersT> versions;
+    versions.reserve(N / K + 1);
+    size_t live = 0, base = 0;
+
+    for (auto _ : state) {
+        PatriciaPersT tree;
+        live = 0;
+        patripers_init_ex(&tree, &count_memfunc, &live);
+        for (std::size_t i = 0; i < N; ++i) {
+            patripers_insert(&tree, keys[i].c_str(), keys[i].length() * CHAR_BIT, nullptr);
+            if (0 == (i + 1) % K) {
+                versions.emplace_back();
+                patripers_snapshot(&versions.back(), &tree);
+            }
+        }
+        state.PauseTiming();
+        base = live;
+        for (auto &v : versions) patripers_fini(&v);
+        base -= live;   // memory held only by the snapshots
+        state.counters["bytes/version"] = versions.empty() ? 0.0 : double(base) / double(versions.size());
+        versions.clear();
+        patripers_fini(&tree);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_Pers_InsertSnapshots)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
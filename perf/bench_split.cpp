@@ -0,0 +1,129 @@
+// ===================== bench_split.cpp =====================
+// Node layout: keys inline in the nodes (the plain set) against topology nodes and key
+// bytes in separate arenas (PatriciaSplitT).  With inline keys of 64..512 bytes a node
+// header shares its cache line and page with key bytes the descent never reads; with
+// the split layout the headers are packed, and only the final compare touches a key.
+//
+// Variants:
+//  - inline/malloc : plain set, default malloc policy
+//  - inline/arena  : plain set, nodes bump-allocated from one arena (no malloc headers)
+//  - split         : split set, fixed-size nodes in one arena, keys in another
+//
+// The benchmark time is the time of one successful lookup in random order.
+// Counters:
+//  - node bytes/key : bytes of the structure a descent walks through, per key (inline:
+//                     whole nodes including keys; split: the node arena only)
+//  - nodes/line     : node headers per 64-byte cache line along that memory
+//
+// Benchmarks are registered as  BM_Layout/<variant>/keylen:<L>/N:<N>
+#include "cpatricia_set.h"
+#include "cpatricia_split.h"
+#include "vmbumppool.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+struct BumpAccount {
+    VmBumpPoolT pool;
+    std::size_t bytes = 0;
+};
+
+void *bump_alloc(void *a, size_t n) {
+    auto *acc = static_cast<BumpAccount *>(a);
+    acc->bytes += n;
+    return vmBump_alloc(&acc->pool, n, sizeof(void *));
+}
+
+const PTMemFuncT mf_bump = {bump_alloc, nullptr, nullptr};
+
+enum class Layout { InlineMalloc, InlineArena, Split };
+
+void BM_Layout(benchmark::State &state, Layout layout) {
+    const std::size_t len = std::size_t(state.range(0));
+    const std::size_t n   = std::size_t(state.range(1));
+    const uint16_t    nbit = uint16_t(len * CHAR_BIT);
+
+    std::vector<char> keys(n * len);
+    for (std::size_t i = 0; i < n; ++i) make_key(&keys[i * len], len, i);
+    std::vector<uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = uint32_t(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(11));
+
+    PatriciaSetT   set;
+    PatriciaSplitT split;
+    BumpAccount    acc;
+    double         node_bytes = 0.0;
+
+    switch (layout) {
+    case Layout::InlineMalloc:
+        patriset_init(&set);
+        for (std::size_t i = 0; i < n; ++i) patriset_insert(&set, &keys[i * len], nbit, nullptr);
+        node_bytes = double(offsetof(PTSetNodeT, data) + len + 1);
+        break;
+    case Layout::InlineArena:
+        vmBump_init(&acc.pool, 1u << 20, 4096);
+        patriset_init_ex(&set, &mf_bump, &acc);
+        for (std::size_t i = 0; i < n; ++i) patriset_insert(&set, &keys[i * len], nbit, nullptr);
+        node_bytes = double(acc.bytes) / double(n);
+        break;
+    case Layout::Split:
+        if (!patrisplit_init(&split, n * (len + 64))) {
+            state.SkipWithError("arena setup failed");
+            return;
+        }
+        for (std::size_t i = 0; i < n; ++i) patrisplit_insert(&split, &keys[i * len], nbit, nullptr);
+        node_bytes = double(vmBump_getattr(&split._m_nodes, eVmBumpAtt_Total)) / double(n);
+        break;
+    }
+
+    std::size_t i = 0, found = 0;
+    for (auto _ : state) {
+        const char *k = &keys[std::size_t(order[i]) * len];
+        const PTSetNodeT *np = (layout == Layout::Split) ? patrisplit_lookup(&split, k, nbit)
+                                                         : patriset_lookup(&set, k, nbit);
+        benchmark::DoNotOptimize(np);
+        found += (nullptr != np);
+        if (++i == n) i = 0;
+    }
+    if (found != std::size_t(state.iterations())) {
+        state.SkipWithError("lookup missed");
+    }
+    state.counters["node bytes/key"] = node_bytes;
+    state.counters["nodes/line"]     = 64.0 / node_bytes;
+
+    switch (layout) {
+    case Layout::InlineMalloc: patriset_fini(&set);                         break;
+    case Layout::InlineArena:  patriset_fini(&set); vmBump_fini(&acc.pool); break;
+    case Layout::Split:        patrisplit_fini(&split);                     break;
+    }
+}
+
+int register_split() {
+    static const struct { const char *name; Layout layout; } layouts[] = {
+        {"inline/malloc", Layout::InlineMalloc},
+        {"inline/arena",  Layout::InlineArena},
+        {"split",         Layout::Split},
+    };
+    for (auto &l : layouts) {
+        auto *b = benchmark::RegisterBenchmark((std::string("BM_Layout/") + l.name).c_str(), BM_Layout, l.layout);
+        b->ArgNames({"keylen", "N"});
+        for (int64_t len : {64, 128, 256, 512}) {
+            for (int64_t n : {100000, 1000000}) {
+                if (len * n <= (int64_t(128) << 20)) b->Args({len, n});
+            }
+        }
+    }
+    return 0;
+}
+
+const int registered = register_split();
+
+} // namespace
@@ -0,0 +1,174 @@
+// ===================== bench_threads.cpp =====================
+// Read scaling on a shared tree: N benchmark threads do lookups on one set or map of
+// 100k random 16-byte keys.  The library has no internal locking; these cases are the
+// baseline for any future concurrency work.
+//
+// Modes:
+//  - pure   : read-only tree, no locking at all
+//  - shared : every lookup takes a std::shared_mutex in shared mode, no writer; the
+//             pure cost of the lock's cache line bouncing between readers
+//  - rwlock : as 'shared', plus a background writer inserting & removing keys under
+//             the exclusive lock
+//  - frozen : readers use a structural clone without locking, while the writer keeps
+//             changing the live tree under its own lock
+//
+// Benchmarks are registered as  BM_Threads/<set|map>/<mode>/real_time/threads:<T>
+// and run on 1..hardware_concurrency threads.  'writes/s' is the writer's throughput.
+// Nothing is registered in a PATRICIA_OP_COUNTERS build: the counters make lookups
+// write to the tree, so concurrent readers would race.
+#include "cpatricia_set.h"
+#include "cpatricia_map.h"
+#include "bench_keys.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <climits>
+
+namespace {
+
+enum class Mode { Pure, Shared, RwLock, Frozen };
+
+constexpr std::size_t kKeys   = 100000;
+constexpr std::size_t kKeyLen = 16;
+constexpr uint16_t    kBits   = kKeyLen * CHAR_BIT;
+
+// ------------------------------------------------------------
+// State shared by all benchmark threads; set up & torn down by thread 0, which the
+// framework runs before the other threads enter the timed loop.
+// ------------------------------------------------------------
+struct Shared {
+    bool                     is_map = false;
+    PatriciaSetT             set, set_frozen;
+    PatriciaMapT             map, map_frozen;
+    std::vector<std::string> keys;      // members
+    std::vector<std::string> extra;     // keys the writer churns
+    std::shared_mutex        lock;
+    std::atomic<bool>        stop{false};
+    std::atomic<uint64_t>    writes{0};
+    std::thread              writer;
+
+    void setup(bool map_, bool frozen, bool with_writer) {
+        is_map = map_;
+        keys   = generate_random_strings(kKeys, kKeyLen, 1);
+        extra  = generate_random_strings(kKeys / 10, kKeyLen, 2);
+        if (is_map) {
+            patrimap_init(&map);
+            for (auto &k : keys) patrimap_insert(&map, k.data(), kBits, nullptr);
+            if (frozen) patrimap_clone(&map_frozen, &map, nullptr, nullptr);
+        } else {
+            patriset_init(&set);
+            for (auto &k : keys) patriset_insert(&set, k.data(), kBits, nullptr);
+            if (frozen) patriset_clone(&set_frozen, &set, nullptr, nullptr);
+        }
+        stop   = false;
+        writes = 0;
+        if (with_writer) writer = std::thread([this] { write_loop(); });
+    }
+
+    void teardown(bool frozen) {
+        if (writer.joinable()) {
+            stop = true;
+            writer.join();
+        }
+        if (is_map) {
+            patrimap_fini(&map);
+            if (frozen) patrimap_fini(&map_frozen);
+        } else {
+            patriset_fini(&set);
+            if (frozen) patriset_fini(&set_frozen);
+        }
+    }
+
+    // insert all extra keys, then remove them again, one exclusive lock per change
+    void write_loop() {
+        bool adding = true;
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (auto &k : extra) {
+                std::unique_lock<std::shared_mutex> guard(lock);
+                if (is_map) {
+                    if (adding) patrimap_insert(&map, k.data(), kBits, nullptr);
+                    else        patrimap_remove(&map, k.data(), kBits);
+                } else {
+                    if (adding) patriset_insert(&set, k.data(), kBits, nullptr);
+                    else        patriset_remove(&set, k.data(), kBits);
+                }
+            }
+            writes.fetch_add(extra.size(), std::memory_order_relaxed);
+            adding = !adding;
+        }
+    }
+
+    const void *lookup(const std::string &k, bool frozen) const {
+        if (is_map) return patrimap_lookup(frozen ? &map_frozen : &map, k.data(), kBits);
+        return patriset_lookup(frozen ? &set_frozen : &set, k.data(), kBits);
+    }
+};
+
+Shared g_shared;
+
+void BM_Threads(benchmark::State &state, bool is_map, Mode mode) {
+    const bool frozen = mode == Mode::Frozen;
+    const bool locked = mode == Mode::Shared || mode == Mode::RwLock;
+    if (0 == state.thread_index()) {
+        g_shared.setup(is_map, frozen, mode == Mode::RwLock || frozen);
+    }
+
+    std::mt19937 rng(1000 + unsigned(state.thread_index()));
+    std::vector<uint32_t> stream(4096);
+    for (auto &i : stream) i = uint32_t(rng() % kKeys);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::size_t hits = 0;
+    for (auto _ : state) {
+        for (auto i : stream) {
+            const std::string &k = g_shared.keys[i];
+            if (locked) {
+                std::shared_lock<std::shared_mutex> guard(g_shared.lock);
+                hits += (nullptr != g_shared.lookup(k, false));
+            } else {
+                hits += (nullptr != g_shared.lookup(k, frozen));
+            }
+        }
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations() * int64_t(stream.size()));
+
+    if (0 == state.thread_index()) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (g_shared.writer.joinable()) {
+            state.counters["writes/s"] = double(g_shared.writes.load()) / secs;
+        }
+        g_shared.teardown(frozen);
+    }
+}
+
+int register_threads() {
+#ifndef PATRICIA_OP_COUNTERS
+    static const struct { const char *name; Mode mode; } modes[] = {
+        {"pure", Mode::Pure}, {"shared", Mode::Shared}, {"rwlock", Mode::RwLock}, {"frozen", Mode::Frozen},
+    };
+    const int hw = std::max(1, int(std::thread::hardware_concurrency()));
+    for (int is_map = 0; is_map < 2; ++is_map) {
+        for (auto &m : modes) {
+            std::string name = std::string("BM_Threads") + (is_map ? "/map/" : "/set/") + m.name;
+            benchmark::RegisterBenchmark(name.c_str(), BM_Threads, bool(is_map), m.mode)
+                ->ThreadRange(1, hw)->UseRealTime();
+        }
+    }
+#else
+    (void)&BM_Threads;
+#endif
+    return 0;
+}
+
+const int registered = register_threads();
+
+} // namespace
@@ -0,0 +1,315 @@
+// ===================== bench_workloads.cpp =====================
+// Realistic and adversarial workloads for sets and maps, with malloc and arena policies.
+//
+// Key families:
+//  - ipv4 / ipv6 : routing-table style prefixes, bit length = prefix length
+//  - url / path  : textual keys with long shared prefixes
+//  - seq         : monotone 64-bit integers, big-endian (dense low bits)
+//  - deep        : one-hot bit strings, every key branches one level deeper (depth = N)
+//
+// Lookup streams:
+//  - hit   : uniform over the inserted keys
+//  - zipf  : Zipf(s=1) skewed over the inserted keys (hot set stays in cache)
+//  - miss  : 90% negative lookups from the same key family
+//
+// Benchmarks are registered as  BM_Work/<keys>/<set|map>/<malloc|arena>/<op>
+#include "cpatricia_set.h"
+#include "cpatricia_map.h"
+#include "vmbumppool.h"
+#include "bench_perfctr.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+struct Key {
+    std::string bytes;
+    uint16_t    bits;
+};
+
+// ------------------------------------------------------------
+// Key generators. Each returns 'count' distinct keys; 'seed' selects the sample, so
+// the same generator with another seed gives (mostly) non-members for miss streams.
+// ------------------------------------------------------------
+std::vector<Key> gen_ipv4(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::discrete_distribution<int> plen({1, 2, 4, 8, 60, 10, 15}); // /8,/12,/16,/20,/24,/28,/32
+    static const uint16_t lens[] = {8, 12, 16, 20, 24, 28, 32};
+    std::vector<Key> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        uint16_t len = lens[plen(rng)];
+        uint32_t adr = rng() & (len < 32 ? ~(UINT32_MAX >> len) : UINT32_MAX);
+        char b[4] = {char(adr >> 24), char(adr >> 16), char(adr >> 8), char(adr)};
+        out.push_back({std::string(b, 4), len});
+    }
+    return out;
+}
+
+std::vector<Key> gen_ipv6(std::size_t count, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    static const uint16_t lens[] = {32, 40, 48, 56, 64, 64, 64, 128};
+    // a handful of /32 allocations everything else lives in
+    uint32_t alloc[16];
+    for (auto &a : alloc) a = 0x20010000u | (uint32_t(rng()) & 0xFFFFu);
+    std::vector<Key> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        uint16_t len = lens[rng() % 8];
+        char b[16];
+        uint32_t top = alloc[rng() % 16];
+        uint64_t mid = rng(), low = rng();
+        for (int j = 0; j < 4; ++j) b[j] = char(top >> (24 - 8 * j));
+        for (int j = 0; j < 4; ++j) b[4 + j] = char(mid >> (56 - 8 * j));
+        for (int j = 0; j < 8; ++j) b[8 + j] = char(low >> (56 - 8 * j));
+        for (unsigned bit = len; bit < 128; ++bit) b[bit / 8] &= char(~(0x80u >> (bit % 8)));
+        out.push_back({std::string(b, (len + 7) / 8), len});
+    }
+    return out;
+}
+
+std::vector<Key> gen_url(std::size_t count, unsigned seed) {
+    static const char *const hosts[] = {"https://www.example.com", "https://api.example.com",
+                                        "https://cdn.example.org", "http://intranet.local"};
+    static const char *const parts[] = {"/api/v1/users/", "/api/v2/users/", "/static/img/",
+                                        "/docs/reference/", "/shop/category/"};
+    std::mt19937 rng(seed);
+    std::vector<Key> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string s = hosts[rng() % 4];
+        s += parts[rng() % 5];
+        s += std::to_string(rng() % 1000000);
+        s += "/orders/";
+        s += std::to_string(rng());
+        out.push_back({s, uint16_t(s.size() * CHAR_BIT)});
+    }
+    return out;
+}
+
+std::vector<Key> gen_path(std::size_t count, unsigned seed) {
+    static const char *const dirs[] = {"usr", "share", "lib", "include", "src", "local",
+                                       "doc", "man", "x86_64-linux-gnu", "python3"};
+    std::mt19937 rng(seed);
+    std::vector<Key> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string s;
+        unsigned depth = 3 + rng() % 5;
+        for (unsigned d = 0; d < depth; ++d) {
+            s += '/';
+            s += dirs[(d + rng() % 3) % 10];
+        }
+        s += "/file_" + std::to_string(rng()) + ".h";
+        out.push_back({s, uint16_t(s.size() * CHAR_BIT)});
+    }
+    return out;
+}
+
+std::vector<Key> gen_seq(std::size_t count, unsigned seed) {
+    // consecutive numbers of one parity: odd seeds (the members) give odd numbers, even
+    // seeds (the misses) the even numbers in between
+    std::vector<Key> out;
+    out.reserve(count);
+    uint64_t v = 1000000 + (seed & 1);
+    for (std::size_t i = 0; i < count; ++i, v += 2) {
+        char b[8];
+        for (int j = 0; j < 8; ++j) b[j] = char(v >> (56 - 8 * j));
+        out.push_back({std::string(b, 8), 64});
+    }
+    return out;
+}
+
+std::vector<Key> gen_deep(std::size_t count, unsigned seed) {
+    // keys of 'count' bits where key i has its first set bit at index i, so any two keys
+    // differ first at the smaller index and the tree degenerates into a chain of depth
+    // 'count'.  Odd seeds (the members) give two-hot keys (bits i and i+1), even seeds
+    // (the misses) one-hot keys, which follow the chain down to key i and miss there.
+    std::vector<Key> out;
+    out.reserve(count);
+    std::size_t nbyte = (count + 8) / 8;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string s(nbyte, '\0');
+        s[i / 8] |= char(0x80u >> (i % 8));
+        if (seed & 1) s[(i + 1) / 8] |= char(0x80u >> ((i + 1) % 8));
+        out.push_back({s, uint16_t(nbyte * CHAR_BIT)});
+    }
+    return out;
+}
+
+void dedup(std::vector<Key> &keys) {
+    std::sort(keys.begin(), keys.end(), [](const Key &a, const Key &b) {
+        return a.bits != b.bits ? a.bits < b.bits : a.bytes < b.bytes;
+    });
+    keys.erase(std::unique(keys.begin(), keys.end(), [](const Key &a, const Key &b) {
+        return a.bits == b.bits && a.bytes == b.bytes;
+    }), keys.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(99));
+}
+
+// ------------------------------------------------------------
+// Lookup streams: hit/zipf draw members, miss mixes in keys from another seed
+// ------------------------------------------------------------
+enum class Op { Insert, Hit, Zipf, Miss };
+
+std::vector<std::size_t> zipf_stream(std::size_t n, std::size_t len, unsigned seed) {
+    std::vector<double> cdf(n);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) cdf[i] = (sum += 1.0 / double(i + 1));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, sum);
+    std::vector<std::size_t> out(len);
+    for (auto &x : out) x = std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin();
+    return out;
+}
+
+// ------------------------------------------------------------
+// Memory policies: plain malloc or a private bump arena, each for set & map nodes.
+// Map nodes need the payload in front of the set node.
+// ------------------------------------------------------------
+constexpr std::size_t kMapHead = offsetof(PTMapNodeT, _m_node);
+
+void *set_malloc(void *, size_t n) { return std::malloc(n); }
+void  set_free(void *, void *p)    { std::free(p); }
+void *set_bump(void *a, size_t n)  { return vmBump_alloc(static_cast<VmBumpPoolT *>(a), n, sizeof(void *)); }
+void *map_malloc(void *, size_t n) {
+    char *p = static_cast<char *>(std::malloc(n + kMapHead));
+    return p ? p + kMapHead : nullptr;
+}
+void  map_free(void *, void *p)    { std::free(static_cast<char *>(p) - kMapHead); }
+void *map_bump(void *a, size_t n) {
+    char *p = static_cast<char *>(vmBump_alloc(static_cast<VmBumpPoolT *>(a), n + kMapHead, sizeof(void *)));
+    return p ? p + kMapHead : nullptr;
+}
+void  bump_kill(void *a)           { vmBump_fini(static_cast<VmBumpPoolT *>(a)); }
+
+const PTMemFuncT mf_set_malloc = {set_malloc, set_free, nullptr};
+const PTMemFuncT mf_set_bump   = {set_bump,   nullptr,  bump_kill};
+const PTMemFuncT mf_map_malloc = {map_malloc, map_free, nullptr};
+const PTMemFuncT mf_map_bump   = {map_bump,   nullptr,  bump_kill};
+
+// Uniform wrapper over set & map so one benchmark body covers both
+struct Tree {
+    bool         is_map;
+    PatriciaSetT set;
+    PatriciaMapT map;
+    VmBumpPoolT  pool;
+
+    Tree(bool map_, bool arena) : is_map(map_) {
+        void *ap = nullptr;
+        if (arena) {
+            vmBump_init(&pool, 1u << 20, 4096);   // 1 MiB blocks, 4 GiB limit
+            ap = &pool;
+        }
+        if (is_map) {
+            patrimap_init_ex(&map, arena ? &mf_map_bump : &mf_map_malloc, ap);
+        } else {
+            patriset_init_ex(&set, arena ? &mf_set_bump : &mf_set_malloc, ap);
+        }
+    }
+    ~Tree() {
+        if (is_map) patrimap_fini(&map); else patriset_fini(&set);
+    }
+    const void *insert(const Key &k) {
+        if (is_map) {
+            const PTMapNodeT *np = patrimap_insert(&map, k.bytes.data(), k.bits, nullptr);
+            if (np) const_cast<PTMapNodeT *>(np)->payload = k.bits;
+            return np;
+        }
+        return patriset_insert(&set, k.bytes.data(), k.bits, nullptr);
+    }
+    const void *lookup(const Key &k) const {
+        return is_map ? static_cast<const void *>(patrimap_lookup(&map, k.bytes.data(), k.bits))
+                      : static_cast<const void *>(patriset_lookup(&set, k.bytes.data(), k.bits));
+    }
+};
+
+typedef std::vector<Key> (*GenFn)(std::size_t, unsigned);
+
+void BM_Work(benchmark::State &state, GenFn gen, bool is_map, bool arena, Op op) {
+    const std::size_t N = static_cast<std::size_t>(state.range(0));
+    auto keys = gen(N, 1);
+    dedup(keys);
+
+    PerfCounters pc;
+    if (op == Op::Insert) {
+        for (auto _ : state) {
+            pc.start();
+            Tree *t = new Tree(is_map, arena);
+            for (auto &k : keys) benchmark::DoNotOptimize(t->insert(k));
+            pc.stop();
+            state.PauseTiming();
+            delete t;   // keep teardown out of the timing
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+        pc.report(state, double(state.iterations() * keys.size()));
+        return;
+    }
+
+    // build once, then run a fixed stream of 'N' lookups per iteration
+    Tree t(is_map, arena);
+    for (auto &k : keys) t.insert(k);
+
+    std::vector<const Key *> stream;
+    stream.reserve(N);
+    std::vector<Key> others;
+    if (op == Op::Miss) {
+        others = gen(N, 2);
+        std::mt19937 rng(7);
+        for (std::size_t i = 0; i < N; ++i) {
+            stream.push_back(rng() % 10 ? &others[i % others.size()] : &keys[i % keys.size()]);
+        }
+    } else if (op == Op::Zipf) {
+        for (auto i : zipf_stream(keys.size(), N, 5)) stream.push_back(&keys[i]);
+    } else {
+        std::mt19937 rng(5);
+        for (std::size_t i = 0; i < N; ++i) stream.push_back(&keys[rng() % keys.size()]);
+    }
+
+    std::size_t hits = 0;
+    pc.start();
+    for (auto _ : state) {
+        for (auto *k : stream) hits += (nullptr != t.lookup(*k));
+    }
+    pc.stop();
+    state.SetItemsProcessed(state.iterations() * stream.size());
+    pc.report(state, double(state.iterations() * stream.size()));
+    state.counters["hit%"] = 100.0 * double(hits) / double(state.iterations() * stream.size());
+}
+
+struct Family { const char *name; GenFn gen; int64_t n; };
+
+int register_workloads() {
+    static const Family families[] = {
+        {"ipv4", gen_ipv4, 100000}, {"ipv6", gen_ipv6, 100000},
+        {"url",  gen_url,  100000}, {"path", gen_path, 100000},
+        {"seq",  gen_seq,  100000}, {"deep", gen_deep, 2000},
+    };
+    static const struct { const char *name; Op op; } ops[] = {
+        {"insert", Op::Insert}, {"hit", Op::Hit}, {"zipf", Op::Zipf}, {"miss", Op::Miss},
+    };
+    for (auto &f : families) {
+        for (int is_map = 0; is_map < 2; ++is_map) {
+            for (int arena = 0; arena < 2; ++arena) {
+                for (auto &o : ops) {
+                    std::string name = std::string("BM_Work/") + f.name + (is_map ? "/map" : "/set")
+                                     + (arena ? "/arena/" : "/malloc/") + o.name;
+                    benchmark::RegisterBenchmark(name.c_str(), BM_Work, f.gen,
+                                                 bool(is_map), bool(arena), o.op)->Arg(f.n);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+const int registered = register_workloads();
+
+} // namespace
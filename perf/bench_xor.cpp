@@ -0,0 +1,66 @@
+// ===================== bench_xor.cpp =====================
+// XOR metric queries on random node IDs (Kademlia-style DHT): the k = 20 closest IDs to
+// a random target with patriset_xor_nearest(), and the farthest ID with
+// patriset_xor_max().  Both walk the tree once; no key is compared.
+//
+// Benchmarks are registered as  BM_Xor/<nearest|max>/bits:<B>/N:<N>
+// and report the time of one query.
+#include "cpatricia_set.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace {
+
+constexpr std::size_t kNearest = 20;
+
+void BM_Xor(benchmark::State &state, bool nearest) {
+    const uint16_t    bits   = uint16_t(state.range(0));
+    const std::size_t n      = std::size_t(state.range(1));
+    const std::size_t nbytes = bits / CHAR_BIT;
+    const std::size_t nq     = 4096;
+    std::mt19937_64 rng(37);
+
+    PatriciaSetT set;
+    patriset_init(&set);
+    std::vector<unsigned char> id(nbytes);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (auto &c : id) c = static_cast<unsigned char>(rng());
+        patriset_insert(&set, id.data(), bits, nullptr);
+    }
+    std::vector<unsigned char> targets(nq * nbytes);
+    for (auto &c : targets) c = static_cast<unsigned char>(rng());
+
+    const PTSetNodeT *out[kNearest];
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const unsigned char *t = &targets[i * nbytes];
+        if (nearest) {
+            benchmark::DoNotOptimize(patriset_xor_nearest(&set, t, bits, kNearest, out));
+            benchmark::DoNotOptimize(out);
+        } else {
+            benchmark::DoNotOptimize(patriset_xor_max(&set, t, bits));
+        }
+        if (++i == nq) i = 0;
+    }
+    patriset_fini(&set);
+}
+
+int register_xor() {
+    for (bool nearest : {true, false}) {
+        std::string name = std::string("BM_Xor/") + (nearest ? "nearest" : "max");
+        auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_Xor, nearest);
+        b->ArgNames({"bits", "N"});
+        for (int64_t bits : {160, 256}) {
+            for (int64_t n : {100000, 1000000}) b->Args({bits, n});
+        }
+    }
+    return 0;
+}
+
+const int registered = register_xor();
+
+} // namespace
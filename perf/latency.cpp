@@ -0,0 +1,285 @@
+// ===================== latency.cpp =====================
+// Tail-latency harness: times every single operation and prints percentiles.
+//
+// Google Benchmark reports means over many operations, which hides the outliers that
+// matter for p99/p999 service levels: page commits inside vmBump_alloc, parent
+// recovery walks in the iterator, deep paths on degenerate key sets.  This harness
+// times each call individually (rdtsc on x86, clock_gettime elsewhere) and records the
+// samples in an HDR-style log-linear histogram with < 1% relative error.
+//
+// Phases, each with its own histogram:
+//  insert, lookup (hit), lookup (miss), iter (pre/in/post order steps), remove
+//
+// usage: patriciac_latency [-n N] [-k random|seq|chain] [-a]
+//   -n  number of keys (default 1000000, chain is capped at 60000)
+//   -k  key family: random 16-byte strings, sequential 64-bit integers or one-hot bit
+//       strings, which make the tree a chain as deep as the key count
+//   -a  allocate nodes from a VmBumpPoolT arena instead of malloc
+//
+// All numbers are nanoseconds, including the timer overhead shown in the first row.
+#include "cpatricia_set.h"
+#include "vmbumppool.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define LAT_USE_RDTSC 1
+#endif
+
+namespace {
+
+// ------------------------------------------------------------
+// Clock: raw ticks plus a conversion factor to nanoseconds
+// ------------------------------------------------------------
+uint64_t mono_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+inline uint64_t ticks() {
+#ifdef LAT_USE_RDTSC
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    return mono_ns();
+#endif
+}
+
+// nanoseconds per tick, measured against the monotonic clock
+double calibrate() {
+#ifdef LAT_USE_RDTSC
+    uint64_t n0 = mono_ns(), t0 = ticks();
+    while (mono_ns() - n0 < 50000000u) {}
+    uint64_t n1 = mono_ns(), t1 = ticks();
+    return double(n1 - n0) / double(t1 - t0);
+#else
+    return 1.0;
+#endif
+}
+
+// ------------------------------------------------------------
+// HDR-style histogram: values below 2^(S+1) are counted exactly, above that every
+// power-of-two range is split into 2^S linear sub-buckets.
+// ------------------------------------------------------------
+class Histogram {
+    static constexpr unsigned S    = 7;
+    static constexpr uint64_t Half = uint64_t(1) << S;
+
+    std::vector<uint64_t> m_cnt;
+    uint64_t              m_total = 0;
+    uint64_t              m_max   = 0;
+    double                m_sum   = 0.0;
+
+    static unsigned index(uint64_t v) {
+        if (v < 2 * Half) return unsigned(v);
+        unsigned shift = unsigned(64 - __builtin_clzll(v)) - (S + 1);
+        return unsigned(shift * Half + (v >> shift));
+    }
+    static uint64_t lowest(unsigned idx) {
+        if (idx < 2 * Half) return idx;
+        unsigned shift = unsigned(idx / Half) - 1;
+        return (uint64_t(idx) - shift * Half) << shift;
+    }
+
+public:
+    Histogram() : m_cnt((64 - S + 1) * Half, 0) {}
+
+    void record(uint64_t v) {
+        ++m_cnt[index(v)];
+        ++m_total;
+        m_sum += double(v);
+        m_max = std::max(m_max, v);
+    }
+    uint64_t count() const { return m_total; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_total ? m_sum / double(m_total) : 0.0; }
+
+    // smallest recorded value such that at least 'p' percent of all values are <= it
+    uint64_t percentile(double p) const {
+        uint64_t want = uint64_t(double(m_total) * p / 100.0 + 0.5), seen = 0;
+        want = std::max<uint64_t>(want, 1);
+        for (unsigned i = 0; i < m_cnt.size(); ++i) {
+            if ((seen += m_cnt[i]) >= want) return std::min(m_max, lowest(i + 1) - 1);
+        }
+        return m_max;
+    }
+};
+
+// ------------------------------------------------------------
+// Report: one row per phase
+// ------------------------------------------------------------
+void print_header() {
+    std::printf("%-14s %10s %9s %9s %9s %9s %9s %9s %11s\n",
+                "op", "count", "mean", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+}
+
+void print_row(const char *name, const Histogram &h, double ns_per_tick) {
+    auto ns = [ns_per_tick](uint64_t t) { return double(t) * ns_per_tick; };
+    std::printf("%-14s %10" PRIu64 " %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %11.1f\n",
+                name, h.count(), h.mean() * ns_per_tick,
+                ns(h.percentile(50)), ns(h.percentile(90)), ns(h.percentile(99)),
+                ns(h.percentile(99.9)), ns(h.percentile(99.99)), ns(h.max()));
+}
+
+// ------------------------------------------------------------
+// Keys
+// ------------------------------------------------------------
+struct Key {
+    std::string bytes;
+    uint16_t    bits;
+};
+
+std::vector<Key> make_keys(const char *family, std::size_t n, unsigned seed) {
+    std::vector<Key> out;
+    out.reserve(n);
+    std::mt19937_64 rng(seed);
+    if (0 == std::strcmp(family, "seq")) {
+        // members are even, odd seeds give the odd numbers in between
+        for (uint64_t i = 0, v = (seed & 1); i < n; ++i, v += 2) {
+            char b[8];
+            for (int j = 0; j < 8; ++j) b[j] = char(v >> (56 - 8 * j));
+            out.push_back({std::string(b, 8), 64});
+        }
+    } else if (0 == std::strcmp(family, "chain")) {
+        // one-hot; odd seeds set a second bit, which follows the chain but misses
+        std::size_t nbyte = (n + 8) / 8;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::string s(nbyte, '\0');
+            s[i / 8] |= char(0x80u >> (i % 8));
+            if (seed & 1) s[(i + 1) / 8] |= char(0x80u >> ((i + 1) % 8));
+            out.push_back({s, uint16_t(nbyte * CHAR_BIT)});
+        }
+    } else {
+        for (std::size_t i = 0; i < n; ++i) {
+            std::string s(16, '\0');
+            for (auto &c : s) c = char('a' + rng() % 26);
+            out.push_back({s, 16 * CHAR_BIT});
+        }
+    }
+    std::shuffle(out.begin(), out.end(), std::mt19937(seed + 99));
+    return out;
+}
+
+// ------------------------------------------------------------
+// Arena policy
+// ------------------------------------------------------------
+void *bump_alloc(void *a, size_t n) { return vmBump_alloc(static_cast<VmBumpPoolT *>(a), n, sizeof(void *)); }
+void  bump_kill(void *a)            { vmBump_fini(static_cast<VmBumpPoolT *>(a)); }
+
+const PTMemFuncT mf_bump = {bump_alloc, nullptr, bump_kill};
+
+int usage(const char *prog) {
+    std::fprintf(stderr, "usage: %s [-n N] [-k random|seq|chain] [-a]\n", prog);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t n = 1000000;
+    const char *family = "random";
+    bool arena = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == std::strcmp(argv[i], "-n") && i + 1 < argc) {
+            n = std::strtoul(argv[++i], nullptr, 10);
+        } else if (0 == std::strcmp(argv[i], "-k") && i + 1 < argc) {
+            family = argv[++i];
+        } else if (0 == std::strcmp(argv[i], "-a")) {
+            arena = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (0 == std::strcmp(family, "chain")) n = std::min<std::size_t>(n, 60000);
+    if (0 == n) return usage(argv[0]);
+
+    auto keys   = make_keys(family, n, 2);
+    auto misses = make_keys(family, n, 3);
+    const double ns_per_tick = calibrate();
+
+    VmBumpPoolT pool;
+    PatriciaSetT set;
+    if (arena) {
+        vmBump_init(&pool, 1u << 20, 4096);   // 1 MiB blocks, 4 GiB limit
+        patriset_init_ex(&set, &mf_bump, &pool);
+    } else {
+        patriset_init(&set);
+    }
+
+    std::printf("keys: %zu x %s, %s policy, %.4f ns/tick, parent FIFO %d\n\n",
+                keys.size(), family, arena ? "arena" : "malloc", ns_per_tick, PATRICIA_ITER_PSTK);
+    print_header();
+
+    Histogram h;
+    for (std::size_t i = 0; i < 1000000; ++i) {
+        uint64_t t0 = ticks();
+        h.record(ticks() - t0);
+    }
+    print_row("(timer)", h, ns_per_tick);
+
+    h = Histogram();
+    for (auto &k : keys) {
+        uint64_t t0 = ticks();
+        patriset_insert(&set, k.bytes.data(), k.bits, nullptr);
+        h.record(ticks() - t0);
+    }
+    print_row("insert", h, ns_per_tick);
+
+    const PTSetNodeT *volatile sink = nullptr;
+    h = Histogram();
+    for (auto &k : keys) {
+        uint64_t t0 = ticks();
+        sink = patriset_lookup(&set, k.bytes.data(), k.bits);
+        h.record(ticks() - t0);
+    }
+    print_row("lookup/hit", h, ns_per_tick);
+
+    h = Histogram();
+    for (auto &k : misses) {
+        uint64_t t0 = ticks();
+        sink = patriset_lookup(&set, k.bytes.data(), k.bits);
+        h.record(ticks() - t0);
+    }
+    print_row("lookup/miss", h, ns_per_tick);
+
+    static const struct { const char *name; EPTIterMode mode; } modes[] = {
+        {"iter/pre", ePTMode_preOrder}, {"iter/in", ePTMode_inOrder}, {"iter/post", ePTMode_postOrder},
+    };
+    for (auto &m : modes) {
+        PTSetIterT it;
+        psetiter_init(&it, &set, nullptr, true, m.mode);
+        h = Histogram();
+        for (;;) {
+            uint64_t t0 = ticks();
+            sink = psetiter_next(&it);
+            h.record(ticks() - t0);
+            if (nullptr == sink) break;
+        }
+        print_row(m.name, h, ns_per_tick);
+    }
+
+    h = Histogram();
+    for (auto &k : keys) {
+        uint64_t t0 = ticks();
+        patriset_remove(&set, k.bytes.data(), k.bits);
+        h.record(ticks() - t0);
+    }
+    print_row("remove", h, ns_per_tick);
+
+    (void)sink;
+    patriset_fini(&set);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------------------------
+// Bit and byte helpers shared by the PatriciaC sources -- internal header
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - not part of the API; all functions are 'static inline' in every includer
+//  - keys are logically extended beyond their length by the complement of the last bit
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_BITS_33122712_F042_47DB_924E_A482CE490FC8
+#define CPATRICIA_BITS_33122712_F042_47DB_924E_A482CE490FC8
+
+#include <stddef.h>
+#include <limits.h>
+
+#include "cpatricia_set.h"
+
+// -------------------------------------------------------------------------------------
+// Count leading zeros in a 'size_t' value. Resorts to builtins where practicable, uses
+// a portable implementation as fallback.
+#define EXCESS(_t_) ((sizeof(_t_) - sizeof(size_t)) * CHAR_BIT)
+
+static inline unsigned
+clzz(
+    size_t v)
+{
+    // Many implementations of CLZ have undefined behaviour if called with zero. We nail
+    // it down ourselves!
+    if (0 == v) {
+        return sizeof(size_t) * CHAR_BIT;
+    }
+
+    // GCC and Clang have builtins. Other compilers might, too...  
+# if (defined(__GNUC__) || defined(__clang__))
+    if (sizeof(int) >= sizeof(size_t))
+        return __builtin_clz((unsigned int)v) - EXCESS(int);
+    if (sizeof(long int) >= sizeof(size_t))
+        return __builtin_clzl((unsigned long int)v) - EXCESS(long int);
+    if (sizeof(long long int) >= sizeof(size_t))
+        return __builtin_clzll((unsigned long long int)v) - EXCESS(long long int);
+# endif
+
+    return patricia_clz(v);
+}
+
+// -------------------------------------------------------------------------------------
+// byte 'i' of a logically extended key with 'nbit' bits stored at 'p'
+static inline unsigned
+_xbyte(
+    const unsigned char *p   ,
+    unsigned             nbit,
+    unsigned             i   )
+{
+    unsigned fill, real;
+
+    if ((i + 1) * CHAR_BIT <= nbit) {
+        return p[i];
+    }
+    fill = patricia_getbit(p, (uint16_t)nbit, (uint16_t)nbit) ? 0u : UCHAR_MAX;
+    if (i * CHAR_BIT >= nbit) {
+        return fill;
+    }
+    real = UCHAR_MAX & (UCHAR_MAX << (CHAR_BIT - (nbit - i * CHAR_BIT)));
+    return (p[i] & real) | (fill & ~real & UCHAR_MAX);
+}
+
+// -------------------------------------------------------------------------------------
+// unity-based index of the first differing bit, given the nonzero XOR pattern 'd' of
+// key byte 'i'
+static inline unsigned
+_bytediff(
+    unsigned i,
+    unsigned d)
+{
+    return i * CHAR_BIT + 1 + clzz((size_t)d) - (unsigned)((sizeof(size_t) - 1) * CHAR_BIT);
+}
+
+#endif /* CPATRICIA_BITS_33122712_F042_47DB_924E_A482CE490FC8 */
@@ -0,0 +1,287 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with a blocked Bloom filter in front (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// One 64-bit hash per key.  A second mixing round of it selects the block, and the low
+// 'PATRIBLOOM_K' groups of 9 bits select the bits inside the 512-bit block.  Only the
+// key bits count for the hash; pad bits in a partial last byte are masked out.
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_bloom.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifndef PATRIBLOOM_K
+# define PATRIBLOOM_K 6         // bits per key in its block, at most 7
+#endif
+
+#define BLOCK_WORDS 8u          // 64-bit words per block
+#define BLOCK_BITS  512u        // bits per block
+#define BLOCK_ALIGN 64u         // block alignment, one cache line
+
+// -------------------------------------------------------------------------------------
+// ==== hashing & filter access                                                     ====
+// -------------------------------------------------------------------------------------
+
+// 64-bit finaliser (splitmix64)
+static inline uint64_t
+_bmix(
+    uint64_t x)
+{
+    x ^= x >> 30;
+    x *= UINT64_C(0xBF58476D1CE4E5B9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94D049BB133111EB);
+    x ^= x >> 31;
+    return x;
+}
+
+// hash of the key bits, eight bytes per round
+static uint64_t
+_bhash(
+    const unsigned char *key   ,
+    unsigned             bitlen)
+{
+    uint64_t h = UINT64_C(0x9E3779B97F4A7C15) ^ bitlen, w;
+    unsigned nbytes = bitlen / CHAR_BIT, tail = bitlen % CHAR_BIT;
+    unsigned char buf[8];
+
+    for (; nbytes >= 8; nbytes -= 8, key += 8) {
+        memcpy(&w, key, 8);
+        h = _bmix(h ^ w);
+    }
+    memset(buf, 0, sizeof(buf));
+    if (0 != nbytes) {
+        memcpy(buf, key, nbytes);
+    }
+    if (0 != tail) {
+        buf[nbytes] = key[nbytes] & (unsigned char)(UCHAR_MAX << (CHAR_BIT - tail));
+    }
+    memcpy(&w, buf, 8);
+    return _bmix(h ^ w);
+}
+
+// first word of the block for hash 'h'
+static inline uint64_t *
+_bblock(
+    const PatriciaBloomT *t,
+    uint64_t              h)
+{
+    return t->_m_bits + BLOCK_WORDS * (size_t)(_bmix(h) & t->_m_mask);
+}
+
+static inline void
+_badd(
+    PatriciaBloomT *t,
+    uint64_t        h)
+{
+    uint64_t *blk = _bblock(t, h);
+    unsigned  i, pos;
+
+    for (i = 0; i < PATRIBLOOM_K; ++i, h >>= 9) {
+        pos = (unsigned)h & (BLOCK_BITS - 1);
+        blk[pos / 64] |= UINT64_C(1) << (pos % 64);
+    }
+}
+
+static inline bool
+_bprobe(
+    const PatriciaBloomT *t,
+    uint64_t              h)
+{
+    const uint64_t *blk = _bblock(t, h);
+    unsigned        i, pos;
+
+    for (i = 0; i < PATRIBLOOM_K; ++i, h >>= 9) {
+        pos = (unsigned)h & (BLOCK_BITS - 1);
+        if (0 == ((blk[pos / 64] >> (pos % 64)) & 1u)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Replace the filter by one sized for 'nkeys' keys, filled from the set.  On allocation
+// failure the set is left without filter, and the capacity is set to 'nkeys' so the
+// next try waits until the set has grown to that.
+static bool
+_brebuild(
+    PatriciaBloomT *t    ,
+    size_t          nkeys)
+{
+    size_t            blocks = 1, need;
+    PTSetIterT        iter;
+    const PTSetNodeT *node;
+
+    if (nkeys < 64) {
+        nkeys = 64;
+    }
+    need = (nkeys * PATRIBLOOM_BITS_PER_KEY + BLOCK_BITS - 1) / BLOCK_BITS;
+    while (blocks < need) {
+        blocks <<= 1;
+    }
+
+    free(t->_m_mem);
+    t->_m_bits  = NULL;
+    t->_m_stale = 0;
+    t->_m_cap   = nkeys;
+    if (NULL == (t->_m_mem = calloc(blocks * BLOCK_WORDS + BLOCK_ALIGN / sizeof(uint64_t), sizeof(uint64_t)))) {
+        return false;
+    }
+    t->_m_bits = (uint64_t *)(((uintptr_t)t->_m_mem + BLOCK_ALIGN - 1) & ~(uintptr_t)(BLOCK_ALIGN - 1));
+    t->_m_mask = blocks - 1;
+    t->_m_cap  = blocks * BLOCK_BITS / PATRIBLOOM_BITS_PER_KEY;
+
+    psetiter_init(&iter, &t->_m_set, NULL, true, ePTMode_preOrder);
+    while (NULL != (node = psetiter_next(&iter))) {
+        _badd(t, _bhash((const unsigned char *)node->data, node->nbit));
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a filtered set with the given memory management scheme
+/// The memory policy serves the tree nodes; the filter comes from @c malloc().
+/// @param t        set to initialise
+/// @param nkeys    expected number of keys, to size the filter
+/// @param fp       function pointer block with memory policy functions
+/// @param arena    additional data for policy functions
+/// @return         @c true on success, @c false if the filter could not be allocated
+bool
+patribloom_init_ex(
+    PatriciaBloomT   *t    ,
+    size_t            nkeys,
+    const PTMemFuncT *fp   ,
+    void             *arena)
+{
+    memset(t, 0, sizeof(*t));
+    patriset_init_ex(&t->_m_set, fp, arena);
+    return _brebuild(t, nkeys);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a filtered set with default memory functions
+/// @param t        set to initialise
+/// @param nkeys    expected number of keys, to size the filter
+/// @return         @c true on success, @c false if the filter could not be allocated
+bool
+patribloom_init(
+    PatriciaBloomT *t    ,
+    size_t          nkeys)
+{
+    memset(t, 0, sizeof(*t));
+    patriset_init(&t->_m_set);
+    return _brebuild(t, nkeys);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief finalize a filtered set
+/// @param t        set to flush
+void
+patribloom_fini(
+    PatriciaBloomT *t)
+{
+    patriset_fini(&t->_m_set);
+    free(t->_m_mem);
+    t->_m_mem  = NULL;
+    t->_m_bits = NULL;
+    t->_m_keys = t->_m_stale = t->_m_cap = 0;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key, rejecting most misses by the filter
+/// @param t        set to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patribloom_lookup(
+    const PatriciaBloomT *t     ,
+    const void           *key   ,
+    uint16_t              bitlen)
+{
+    if ((NULL != t->_m_bits) && !_bprobe(t, _bhash(key, bitlen))) {
+        return NULL;
+    }
+    return patriset_lookup(&t->_m_set, key, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with given key, insert into set and filter
+/// @param t        set to insert into
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patribloom_insert(
+    PatriciaBloomT *t       ,
+    const void     *key     ,
+    uint16_t        bitlen  ,
+    bool           *inserted)
+{
+    const PTSetNodeT *node;
+    bool              ins;
+
+    node = patriset_insert(&t->_m_set, key, bitlen, &ins);
+    if (inserted) {
+        *inserted = ins;
+    }
+    if (ins) {
+        if (++t->_m_keys + t->_m_stale > t->_m_cap) {
+            _brebuild(t, (t->_m_keys > t->_m_cap / 2) ? 2 * t->_m_keys : t->_m_cap);
+        } else if (NULL != t->_m_bits) {
+            _badd(t, _bhash(key, bitlen));
+        }
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a key from the set
+/// The filter keeps the key's bits until the next rebuild.  Removals do not trigger a
+/// rebuild themselves: the keys and the removed keys together stay the same.
+/// @param t        set to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @return         @c true on success, @c false if the key is not in the set
+bool
+patribloom_remove(
+    PatriciaBloomT *t     ,
+    const void     *key   ,
+    uint16_t        bitlen)
+{
+    if (!patriset_remove(&t->_m_set, key, bitlen)) {
+        return false;
+    }
+    // the key still counts against the capacity, until an insert triggers a rebuild
+    --t->_m_keys;
+    ++t->_m_stale;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief rebuild the filter from the set, dropping the bits of removed keys
+/// The filter is sized for twice the current number of keys.
+/// @param t        set to rebuild the filter for
+/// @return         @c true on success, @c false if the filter could not be allocated
+bool
+patribloom_rebuild(
+    PatriciaBloomT *t)
+{
+    return _brebuild(t, 2 * t->_m_keys);
+}
+
+// -*- that's all folks -*-
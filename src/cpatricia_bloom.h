@@ -0,0 +1,72 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with a blocked Bloom filter in front (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - the plain set, plus a filter that answers most misses without a tree descent
+//  - the filter follows inserts; removals leave stale bits until the next rebuild
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_BLOOM_7FF2D0CD_A72C_4AE9_B566_602F790BADCC
+#define CPATRICIA_BLOOM_7FF2D0CD_A72C_4AE9_B566_602F790BADCC
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpatricia_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief filter bits per key the filter is sized for
+#ifndef PATRIBLOOM_BITS_PER_KEY
+# define PATRIBLOOM_BITS_PER_KEY 12
+#endif
+
+/// @brief PATRICIA set with a Bloom filter for negative lookups
+/// The filter is split into 512-bit blocks, one cache line each.  A key's hash picks a
+/// block and a few bits inside it, so a filter probe costs one cache miss at most,
+/// against one per level for a descent.  A clear bit proves the key is not in the set;
+/// otherwise the tree decides.
+///
+/// Inserting sets the key's bits.  Removing cannot clear them, as other keys may share
+/// them, so removed keys are only counted.  The filter is sized for a capacity of keys;
+/// when the keys plus the removed keys exceed it, the false positive rate rises above
+/// the design point and the filter is rebuilt from the set -- at the same size if
+/// removed keys filled it, at twice the key count if the set outgrew it.  A failed
+/// rebuild allocation leaves the set working without a filter until the set has grown
+/// enough to trigger the next rebuild.
+///
+/// The wrapped set can be used directly for everything that does not change it (the
+/// iterators, @c patriset_prefix(), statistics).
+typedef struct {
+    PatriciaSetT        _m_set;      ///< @brief the basic set we're extending
+    uint64_t           *_m_bits;     ///< @brief filter blocks, or NULL without filter
+    void               *_m_mem;      ///< @brief allocated block for the filter
+    size_t              _m_mask;     ///< @brief number of blocks minus one
+    size_t              _m_cap;      ///< @brief keys the filter is sized for
+    size_t              _m_keys;     ///< @brief keys in the set
+    size_t              _m_stale;    ///< @brief keys removed since the last rebuild
+} PatriciaBloomT;
+
+extern bool              patribloom_init_ex(PatriciaBloomT *t, size_t nkeys, const PTMemFuncT *fp, void *arena);
+extern bool              patribloom_init(PatriciaBloomT *t, size_t nkeys);
+extern void              patribloom_fini(PatriciaBloomT *t);
+
+extern const PTSetNodeT *patribloom_lookup(const PatriciaBloomT *t, const void *key, uint16_t bitlen);
+extern const PTSetNodeT *patribloom_insert(PatriciaBloomT *t, const void *key, uint16_t bitlen, bool *inserted);
+extern bool              patribloom_remove(PatriciaBloomT *t, const void *key, uint16_t bitlen);
+extern bool              patribloom_rebuild(PatriciaBloomT *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_BLOOM_7FF2D0CD_A72C_4AE9_B566_602F790BADCC */
@@ -0,0 +1,664 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with prefix-elided key storage (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// The tree is a plain set tree; only the key storage in the nodes differs.  The theory
+// is short: All keys in the subtree below a node 'y' agree on the bits before the branch
+// position of 'y'.  This includes the keys of nodes *above* 'y' that are reached by an
+// uplink from inside the subtree -- a search for such a key passes 'y' and stays in its
+// subtree.  So if 'y' is the downlink parent of 'z', the key of 'z' agrees with the key
+// of 'y' on bits 1 .. bpos(y)-1, and 'z' needs to store only what comes after.  We elide
+// full bytes only, and never the byte holding the last key bit, so a node always holds
+// the last bit of its key.  As with the plain set, keys extend logically beyond their
+// length with the complement of their last bit.
+//
+// A node's data starts with the number of elided bytes (two bytes, little endian),
+// followed by the rest of the key:
+//
+//      data[0..1]  elided byte count 'e'
+//      data[2..]   key bytes e .. (nbit + 7) / 8 - 1
+//
+// Searching down from the root, every downlink 'y' -> 'z' lets us check the search key
+// bytes between e(y) and e(z) against 'y'.  These bytes are the same for all keys that
+// can be reached below 'z', so any mismatch is final, and no byte needs to be checked
+// twice.  At the end, the tail beyond the bytes already checked is compared against the
+// node found.  The cost is the same number of compared bytes as a full key compare, just
+// spread over the path.
+//
+// Insertion never weakens these relations: a new node goes between a parent and a child
+// with a higher branch position than the parent.  Deletion moves up to two nodes under
+// a parent with a lower branch position; these nodes are copied with the missing bytes,
+// which they share with the key being removed.
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_elide.h"
+#include "cpatricia_bits.h"
+#include "cpatricia_node.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+// -------------------------------------------------------------------------------------
+// ==== node layout & key bytes                                                     ====
+// -------------------------------------------------------------------------------------
+
+#define ESKIP_SIZE 2    // bytes in front of the key rest, holding the elided byte count
+
+// number of bytes needed for 'bits' key bits
+static inline unsigned _nbytes(unsigned bits) {
+    return (bits + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+// number of elided key bytes of a node
+static inline unsigned _eskip(const PTSetNodeT *n) {
+    const unsigned char *p = (const unsigned char *)n->data;
+    return p[0] | ((unsigned)p[1] << CHAR_BIT);
+}
+
+// stored key bytes of a node, starting with key byte '_eskip(n)'
+static inline const unsigned char *_efrag(const PTSetNodeT *n) {
+    return (const unsigned char *)n->data + ESKIP_SIZE;
+}
+
+// number of bytes a node with 'nbit' key bits may elide below a parent branching at
+// bit 'pbpos': the full bytes before the branch, but never the byte with the last bit
+static unsigned
+_ecap(
+    unsigned nbit ,
+    unsigned pbpos)
+{
+    unsigned e = (0 != pbpos) ? (pbpos - 1) / CHAR_BIT : 0;
+    unsigned c = (0 != nbit ) ? (nbit  - 1) / CHAR_BIT : 0;
+    return (e < c) ? e : c;
+}
+
+// byte 'i' of the logically extended key of node 'n'; 'i' must not be elided
+static inline unsigned
+_nbyte(
+    const PTSetNodeT *n,
+    unsigned          i)
+{
+    unsigned e = _eskip(n);
+    assert(i >= e);
+    return _xbyte(_efrag(n), n->nbit - e * CHAR_BIT, i - e);
+}
+
+// key bit 'idx' of node 'n'; the bit must not be elided
+static inline bool
+_ngetbit(
+    const PTSetNodeT *n  ,
+    unsigned          idx)
+{
+    unsigned e = _eskip(n) * CHAR_BIT;
+    assert(idx > e);
+    return patricia_getbit(_efrag(n), (uint16_t)(n->nbit - e), (uint16_t)(idx - e));
+}
+
+// first differing bit between a search key and the key of node 'n' in the key bytes
+// [lo, hi); zero if there is none.  Bytes before 'lo' must not be elided in 'n'.
+static unsigned
+_xdiff(
+    const unsigned char *key   ,
+    unsigned             bitlen,
+    const PTSetNodeT    *n     ,
+    unsigned             lo    ,
+    unsigned             hi    )
+{
+    unsigned e = _eskip(n), full, d;
+
+    // bulk compare where both keys have full real bytes
+    full = bitlen / CHAR_BIT;
+    if (full > n->nbit / CHAR_BIT) {
+        full = n->nbit / CHAR_BIT;
+    }
+    if (full > hi) {
+        full = hi;
+    }
+    if ((lo < full) && (0 != memcmp(key + lo, _efrag(n) + (lo - e), full - lo))) {
+        const unsigned char *f = _efrag(n) - e;
+        while (key[lo] == f[lo]) {
+            ++lo;
+        }
+        return _bytediff(lo, key[lo] ^ f[lo]);
+    }
+    if (lo < full) {
+        lo = full;
+    }
+
+    // ragged ends and logical extension
+    for (; lo < hi; ++lo) {
+        if (0 != (d = _xbyte(key, bitlen, lo) ^ _nbyte(n, lo))) {
+            return _bytediff(lo, d);
+        }
+    }
+    return 0;
+}
+
+// copy the logically extended key bytes [lo, hi) of node 'n' to 'dst'
+static void
+_ecopy(
+    unsigned char    *dst,
+    const PTSetNodeT *n  ,
+    unsigned          lo ,
+    unsigned          hi )
+{
+    unsigned e = _eskip(n), full = n->nbit / CHAR_BIT;
+
+    if (full > hi) {
+        full = hi;
+    }
+    if (lo < full) {
+        memcpy(dst + lo, _efrag(n) + (lo - e), full - lo);
+        lo = full;
+    }
+    for (; lo < hi; ++lo) {
+        dst[lo] = (unsigned char)_nbyte(n, lo);
+    }
+}
+
+// allocate a node block for a key of 'bitlen' bits with 'e' elided bytes
+static PTSetNodeT*
+_enode_alloc(
+    const PatriciaSetT *tree  ,
+    unsigned            bitlen,
+    unsigned            e     )
+{
+    size_t nodelen = offsetof(PTSetNodeT, data) + ESKIP_SIZE + (_nbytes(bitlen) - e);
+    return tree->_m_mfunc->fp_alloc(tree->_m_arena, nodelen);
+}
+
+// set the elided byte count of a fresh node
+static void
+_eskip_set(
+    PTSetNodeT *n,
+    unsigned    e)
+{
+    n->data[0] = (char)(e & UCHAR_MAX);
+    n->data[1] = (char)(e >> CHAR_BIT);
+}
+
+// give a node back to the memory policy
+static void
+_enode_free(
+    const PatriciaSetT *tree,
+    PTSetNodeT         *node)
+{
+    memset(node, 0xFE, offsetof(PTSetNodeT, data));
+    if (NULL != tree->_m_mfunc->fp_free) {
+        tree->_m_mfunc->fp_free(tree->_m_arena, node);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an elided-key set with the given memory management scheme
+/// @param t        set to initialise
+/// @param fp       function pointer block with memory policy functions
+/// @param arena    additional data for policy functions
+void
+patrielide_init_ex(
+    PatriciaElideT   *t    ,
+    const PTMemFuncT *fp   ,
+    void             *arena)
+{
+    patriset_init_ex(&t->_m_set, fp, arena);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an elided-key set with default memory functions
+/// @param t        set to initialise
+void
+patrielide_init(
+    PatriciaElideT *t)
+{
+    patriset_init(&t->_m_set);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief finalize an elided-key set, destroying all nodes
+/// @param t        set to flush
+void
+patrielide_fini(
+    PatriciaElideT *t)
+{
+    patriset_fini(&t->_m_set);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key
+/// @param t        set to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patrielide_lookup(
+    const PatriciaElideT *t     ,
+    const void           *key   ,
+    uint16_t              bitlen)
+{
+    const PTSetNodeT *root = t->_m_set._m_root;
+    const PTSetNodeT *last = root, *next = root->_m_child[0];
+    unsigned          done = 0;   // key bytes checked so far
+
+    while (next->bpos > last->bpos) {
+        // 'next' shares the bytes it does not store with 'last' -- check them now
+        unsigned e = _eskip(next);
+        if (e > done) {
+            if (0 != _xdiff(key, bitlen, last, done, e)) {
+                return NULL;
+            }
+            done = e;
+        }
+        last = next;
+        next = last->_m_child[patricia_getbit(key, bitlen, last->bpos)];
+    }
+    if ((root == next) || (next->nbit != bitlen)) {
+        return NULL;
+    }
+    return (0 == _xdiff(key, bitlen, next, done, _nbytes(bitlen))) ? next : NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with given key, insert into the set
+/// @param t        set to insert into
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patrielide_insert(
+    PatriciaElideT *t       ,
+    const void     *key     ,
+    uint16_t        bitlen  ,
+    bool           *inserted)
+{
+    PatriciaSetT *tree = &t->_m_set;
+    PTSetNodeT   *last = tree->_m_root, *next = tree->_m_root->_m_child[0], *node;
+    unsigned      done = 0, bpos = 0, e;
+    bool          pdir = false, ndir;
+
+    if (inserted) {
+        *inserted = false;
+    }
+
+    // Walk down like a lookup.  The first mismatch found on the way is the branch
+    // position, as the bytes checked there are common to all keys below.
+    while (next->bpos > last->bpos) {
+        e = _eskip(next);
+        if (e > done) {
+            if (0 != (bpos = _xdiff(key, bitlen, last, done, e))) {
+                break;
+            }
+            done = e;
+        }
+        last = next;
+        next = last->_m_child[patricia_getbit(key, bitlen, last->bpos)];
+    }
+    if (0 == bpos) {
+        if (tree->_m_root == next) {
+            // empty set: the root sentinel holds the empty key
+            bpos = patricia_bitdiff(key, bitlen, "", 0);
+        } else {
+            unsigned maxb = (bitlen > next->nbit) ? bitlen : next->nbit;
+            bpos = _xdiff(key, bitlen, next, done, _nbytes(maxb));
+            if ((0 == bpos) && (bitlen != next->nbit)) {
+                bpos = maxb + 1;
+            }
+        }
+        if (0 == bpos) {
+            return next; // existing node
+        }
+    }
+
+    // Find the insert parent, walking down to the new branch position.
+    last = tree->_m_root;
+    next = tree->_m_root->_m_child[0];
+    while ((next->bpos > last->bpos) && (next->bpos < bpos)) {
+        last = next;
+        pdir = patricia_getbit(key, bitlen, last->bpos);
+        next = last->_m_child[pdir];
+    }
+
+    // The parent is known now, and with it the bytes the new node can elide.
+    e = _ecap(bitlen, last->bpos);
+    if (NULL == (node = _enode_alloc(tree, bitlen, e))) {
+        return NULL;
+    }
+    memset(node, 0, offsetof(PTSetNodeT, data));
+    node->nbit = bitlen;
+    node->bpos = (uint16_t)bpos;
+    _eskip_set(node, e);
+    memcpy(node->data + ESKIP_SIZE, (const char *)key + e, _nbytes(bitlen) - e);
+
+    ndir = patricia_getbit(key, bitlen, bpos);
+    node->_m_child[ ndir] = node;
+    node->_m_child[!ndir] = next;
+    last->_m_child[pdir]  = node;
+
+    if (inserted) {
+        *inserted = true;
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+// Replace node 'n' by a copy 'c' that elides only 'e' bytes.  The bytes no longer elided
+// are taken from 'key', which shares them with 'n'.  'owner' holds the downlink to 'n';
+// the uplink to 'n' is found by a walk down from the copy.  'n' is freed.
+static void
+_erelocate(
+    PatriciaSetT        *tree  ,
+    PTSetNodeT          *owner ,
+    PTSetNodeT          *n     ,
+    PTSetNodeT          *c     ,
+    unsigned             e     ,
+    const unsigned char *key   ,
+    unsigned             bitlen)
+{
+    unsigned       i, eold = _eskip(n);
+    unsigned char *frag;
+    PTSetNodeT    *last, *next;
+    bool           dir;
+
+    memcpy(c, n, offsetof(PTSetNodeT, data));
+    _eskip_set(c, e);
+    frag = (unsigned char *)c->data + ESKIP_SIZE;
+    for (i = e; i < eold; ++i) {
+        frag[i - e] = (unsigned char)_xbyte(key, bitlen, i);
+    }
+    memcpy(frag + (eold - e), _efrag(n), _nbytes(n->nbit) - eold);
+    for (i = 0; i < 2; ++i) {
+        if (c->_m_child[i] == n) {
+            c->_m_child[i] = c;
+        }
+    }
+    owner->_m_child[owner->_m_child[1] == n] = c;
+
+    last = c;
+    next = c->_m_child[dir = _ngetbit(c, c->bpos)];
+    while (next->bpos > last->bpos) {
+        last = next;
+        next = last->_m_child[dir = _ngetbit(c, last->bpos)];
+    }
+    if (next == n) {
+        last->_m_child[dir] = c;
+    }
+    _enode_free(tree, n);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a key from the set
+///
+/// Removal moves up to two nodes under a parent with a lower branch position.  If such
+/// a node elides bytes the new position no longer implies, it is replaced by a copy
+/// with these bytes.  The copies are allocated first, so on allocation failure the set
+/// is left unchanged.
+///
+/// @param t        set to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @return         @c true on success, @c false if the key is not in the set or the
+///                 memory for the node copies is not available
+bool
+patrielide_remove(
+    PatriciaElideT *t     ,
+    const void     *key   ,
+    uint16_t        bitlen)
+{
+    PatriciaSetT *tree = &t->_m_set;
+    PTSetNodeT   *x, *z, *g, *p, *c;
+    PTSetNodeT   *cc = NULL, *pc = NULL; // copies of 'c' and 'p', if needed
+    unsigned      ce = 0, pe = 0;        // new elided byte counts for the copies
+
+    if (NULL == (x = (PTSetNodeT *)patrielide_lookup(t, key, bitlen))) {
+        return false;
+    }
+
+    // the tracked walk of the plain set, led by the search key
+    PT_TRACKED_WALK(PTSetNodeT, tree->_m_root, x, key, bitlen, g, p, z);
+    c = p->_m_child[_otherIdx(p, x)];
+
+    // 'c' (if a real node) goes under 'g' or takes its branch position, 'p' goes into
+    // the place of 'x'
+    if ((c->bpos > p->bpos) && (_eskip(c) > (ce = _ecap(c->nbit, g->bpos)))) {
+        if (NULL == (cc = _enode_alloc(tree, c->nbit, ce))) {
+            return false;
+        }
+    }
+    if ((x != p) && (_eskip(p) > (pe = _ecap(p->nbit, z->bpos)))) {
+        if (NULL == (pc = _enode_alloc(tree, p->nbit, pe))) {
+            if (NULL != cc) {
+                _enode_free(tree, cc);
+            }
+            return false;
+        }
+    }
+
+    // the eviction of the plain set
+    PT_UNLINK(g, p, x, z);
+
+    // now fix up the moved nodes; 'c' first, its link may be in 'p' now
+    if (NULL != cc) {
+        _erelocate(tree, ((g == x) && (x != p)) ? p : g, c, cc, ce, key, bitlen);
+    }
+    if (NULL != pc) {
+        _erelocate(tree, z, p, pc, pe, key, bitlen);
+    }
+
+    memset(x, 0, offsetof(PTSetNodeT, data));
+    _enode_free(tree, x);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Key reconstruction                                                          ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an iterator with key reconstruction
+///
+/// The iterator walks depth-first over all nodes, in pre-order, with an explicit stack.
+/// Going down, it copies the bytes a child elides from its parent into a key buffer, so
+/// every node comes with its full key.  The stack lives in the iterator for trees up to
+/// @c PATRIELIDE_ITER_SBUF levels deep and moves to the heap beyond; the key buffer is
+/// always on the heap.  Release both with @c pelideiter_fini().
+///
+/// @param iter     iterator to operate on
+/// @param t        set to walk; must not change while iterating
+/// @param dir      @c true for left-to-right, false for right-to-left
+/// @return         @c true on success, @c false if the key buffer could not be allocated
+bool
+pelideiter_init(
+    PTElideIterT         *iter,
+    const PatriciaElideT *t   ,
+    bool                  dir )
+{
+    const PTSetNodeT *root = t->_m_set._m_root;
+
+    memset(iter, 0, sizeof(*iter));
+    iter->_m_stk = iter->_m_sbuf;
+    iter->_m_cap = PATRIELIDE_ITER_SBUF;
+    iter->_m_dir = dir;
+    if (NULL == (iter->_m_kbuf = malloc(_nbytes(UINT16_MAX)))) {
+        return false;
+    }
+    if (root->_m_child[0] != root) {
+        iter->_m_stk[0].node = root->_m_child[0];
+        iter->_m_stk[0].cidx = 0;
+        iter->_m_len = 1;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief step to the next node in pre-order
+///
+/// @param iter     iterator to step
+/// @param key      opt. storage for the full key of the node; valid until the next step
+/// @return         next node or @c NULL if the end is reached (or the walk stack could
+///                 not grow, see @c failed)
+const PTSetNodeT *
+pelideiter_next(
+    PTElideIterT  *iter,
+    const void   **key )
+{
+    while (0 != iter->_m_len) {
+        PTElideFrameT    *frm  = &iter->_m_stk[iter->_m_len - 1];
+        const PTSetNodeT *node = frm->node, *next;
+        unsigned          cidx = frm->cidx++;
+
+        if (0 == cidx) {
+            // first visit: complete the key and hand it out
+            _ecopy(iter->_m_kbuf, node, _eskip(node), _nbytes(node->nbit));
+            if (NULL != key) {
+                *key = iter->_m_kbuf;
+            }
+            return node;
+        }
+        if (3 == cidx) {
+            // both children done
+            --iter->_m_len;
+            continue;
+        }
+        next = node->_m_child[(cidx == 1) != iter->_m_dir];
+        if (next->bpos <= node->bpos) {
+            continue;
+        }
+
+        // going down: the child's elided bytes come from this node
+        if (_eskip(next) > _eskip(node)) {
+            _ecopy(iter->_m_kbuf, node, _eskip(node), _eskip(next));
+        }
+        if (iter->_m_len == iter->_m_cap) {
+            PTElideFrameT *tmp = (iter->_m_stk == iter->_m_sbuf)
+                ? malloc(2 * iter->_m_cap * sizeof(*tmp))
+                : realloc(iter->_m_stk, 2 * iter->_m_cap * sizeof(*tmp));
+            if (NULL == tmp) {
+                iter->failed = true;
+                iter->_m_len = 0;
+                break;
+            }
+            if (iter->_m_stk == iter->_m_sbuf) {
+                memcpy(tmp, iter->_m_sbuf, sizeof(iter->_m_sbuf));
+            }
+            iter->_m_stk  = tmp;
+            iter->_m_cap *= 2;
+        }
+        iter->_m_stk[iter->_m_len].node = next;
+        iter->_m_stk[iter->_m_len].cidx = 0;
+        ++iter->_m_len;
+    }
+    return NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief release the memory of an iterator
+/// @param iter     iterator to finalise
+void
+pelideiter_fini(
+    PTElideIterT *iter)
+{
+    if (iter->_m_stk != iter->_m_sbuf) {
+        free(iter->_m_stk);
+    }
+    free(iter->_m_kbuf);
+    iter->_m_stk  = iter->_m_sbuf;
+    iter->_m_kbuf = NULL;
+    iter->_m_len  = 0;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief call a function with the full key of every node
+///
+/// A pre-order walk with @c pelideiter_next(); the key passed to @c fn is only valid
+/// during the call.  The walk stops early if @c fn returns @c false.
+///
+/// @param t        set to walk
+/// @param fn       function to call with key, key length and @c ctx
+/// @param ctx      opaque context passed to @c fn
+/// @return         number of keys passed to @c fn, or @c (size_t)-1 if the key buffer or
+///                 the walk stack could not be allocated
+size_t
+patrielide_foreach(
+    const PatriciaElideT *t  ,
+    bool                (*fn)(const void *key, uint16_t bitlen, void *ctx),
+    void                 *ctx)
+{
+    PTElideIterT      iter;
+    const PTSetNodeT *node;
+    const void       *key;
+    size_t            count = 0;
+
+    if (!pelideiter_init(&iter, t, true)) {
+        return (size_t)-1;
+    }
+    while (NULL != (node = pelideiter_next(&iter, &key))) {
+        ++count;
+        if (!fn(key, node->nbit, ctx)) {
+            break;
+        }
+    }
+    if (iter.failed) {
+        count = (size_t)-1;
+    }
+    pelideiter_fini(&iter);
+    return count;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief compute shape statistics of an elided-key set
+///
+/// The shape figures are those of @c patriset_stats(); the byte counts are taken from
+/// the nodes, counting only the key bytes they store.
+///
+/// @param t        set to inspect
+/// @param out      where to store the statistics
+/// @return         @c true on success, @c false if the walk memory could not be allocated
+bool
+patrielide_stats(
+    const PatriciaElideT *t  ,
+    PTSetStatsT          *out)
+{
+    PTElideIterT      iter;
+    const PTSetNodeT *node;
+    bool              retv;
+
+    if (!patriset_stats(&t->_m_set, out) || !pelideiter_init(&iter, t, true)) {
+        return false;
+    }
+    out->key_bytes  = 0;
+    out->node_bytes = 0;
+    while (NULL != (node = pelideiter_next(&iter, NULL))) {
+        size_t bytes = patrielide_keybytes(node);
+        out->key_bytes  += bytes;
+        out->node_bytes += offsetof(PTSetNodeT, data) + ESKIP_SIZE + bytes;
+    }
+    retv = !iter.failed;
+    pelideiter_fini(&iter);
+    return retv;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief number of key bytes stored in a node of an elided-key set
+/// @param node     node to inspect
+/// @return         key bytes stored, not counting the elided ones
+size_t
+patrielide_keybytes(
+    const PTSetNodeT *node)
+{
+    return _nbytes(node->nbit) - _eskip(node);
+}
+
+// -*- that's all folks -*-
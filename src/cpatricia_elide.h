@@ -0,0 +1,91 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with prefix-elided key storage (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - same tree structure and memory policy as the plain set
+//  - a node stores only the key bytes its position in the tree does not imply
+//  - full keys are rebuilt (or compared) piecewise along the path from the root
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_ELIDE_25D22DAF_3034_4E09_9C42_D9C79A521963
+#define CPATRICIA_ELIDE_25D22DAF_3034_4E09_9C42_D9C79A521963
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpatricia_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief PATRICIA set with prefix-elided keys
+/// All keys in the subtree below a node agree on the bits before the node's branch
+/// position.  A node whose downlink parent branches at bit @c b therefore shares its
+/// first @c (b-1) bits with that parent, and so on up to the root; it stores only the
+/// full bytes after that shared prefix.  For key sets with long common prefixes (URLs,
+/// file paths) this saves most of the key storage.
+///
+/// The price is paid on access: a lookup checks the key piecewise against the nodes on
+/// its way down, and keys can only be rebuilt by walking from the root.  The nodes are
+/// plain @c PTSetNodeT structures, but their @c data does not hold the key; do not use
+/// the @c patriset_*() key functions or the @c psetiter_*() iterators on the wrapped
+/// set.  Their parent recovery walks need key bits a node does not store.  Iterate with
+/// @c pelideiter_*() or @c patrielide_foreach(), and take statistics with
+/// @c patrielide_stats().
+typedef struct {
+    PatriciaSetT        _m_set;      ///< @brief the basic set we're extending
+} PatriciaElideT;
+
+extern void              patrielide_init_ex(PatriciaElideT *t, const PTMemFuncT *fp, void *arena);
+extern void              patrielide_init(PatriciaElideT *t);
+extern void              patrielide_fini(PatriciaElideT *t);
+
+extern const PTSetNodeT *patrielide_lookup(const PatriciaElideT *t, const void *key, uint16_t bitlen);
+extern const PTSetNodeT *patrielide_insert(PatriciaElideT *t, const void *key, uint16_t bitlen, bool *inserted);
+extern bool              patrielide_remove(PatriciaElideT *t, const void *key, uint16_t bitlen);
+extern size_t            patrielide_foreach(const PatriciaElideT *t, bool (*fn)(const void *key, uint16_t bitlen, void *ctx), void *ctx);
+extern size_t            patrielide_keybytes(const PTSetNodeT *node);
+extern bool              patrielide_stats(const PatriciaElideT *t, PTSetStatsT *out);
+
+/// @brief walk frames kept in the iterator before the stack moves to the heap
+#ifndef PATRIELIDE_ITER_SBUF
+# define PATRIELIDE_ITER_SBUF 32
+#endif
+
+/// @brief one frame of the iterator walk: node and next child to process
+typedef struct {
+    const PTSetNodeT   *node;        ///< @brief node of the frame
+    unsigned            cidx;        ///< @brief 0: visit node, 1/2: children, 3: done
+} PTElideFrameT;
+
+/// @brief elided-key set iterator
+/// A pre-order walk with a full stack that assembles the key of every node on the way
+/// down.  Unlike the set iterator, it needs no key bits to find a parent again, but it
+/// only steps forward.  The iterator refers to its own storage; do not copy it.
+typedef struct {
+    PTElideFrameT      *_m_stk;      ///< @brief walk stack, @c _m_sbuf or on the heap
+    unsigned char      *_m_kbuf;     ///< @brief key assembly buffer
+    unsigned            _m_len;      ///< @brief frames on the stack
+    unsigned            _m_cap;      ///< @brief capacity of the stack
+    bool                _m_dir;      ///< @brief direction, true is left-to-right
+    bool                failed;      ///< @brief \bold{(RO)} walk stopped for lack of memory
+    PTElideFrameT       _m_sbuf[PATRIELIDE_ITER_SBUF]; ///< @brief initial stack storage
+} PTElideIterT;
+
+extern bool              pelideiter_init(PTElideIterT *i, const PatriciaElideT *t, bool dir);
+extern const PTSetNodeT *pelideiter_next(PTElideIterT *i, const void **key);
+extern void              pelideiter_fini(PTElideIterT *i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_ELIDE_25D22DAF_3034_4E09_9C42_D9C79A521963 */
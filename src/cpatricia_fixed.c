@@ -0,0 +1,283 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET for keys of one fixed length (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// The plain set gives the root sentinel the empty key.  Every other key differs from it
+// somewhere, at the latest one bit past its end, where the extension kicks in.  With a
+// fixed key length that would be the only reason to look past the end of a key, so the
+// root gets the all-ones key of full length instead: it extends nothing, and every real
+// difference is then inside the key.  The price is a membership flag for that key.
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_fixed.h"
+#include "cpatricia_node.h"
+
+#include <string.h>
+#include <assert.h>
+
+// -------------------------------------------------------------------------------------
+// ==== helpers                                                                     ====
+// -------------------------------------------------------------------------------------
+
+// unity-indexed key bit, no clamping: 'bitidx' is never beyond the key
+static inline unsigned
+_fgetbit(
+    const unsigned char *key   ,
+    unsigned             bitidx)
+{
+    --bitidx;
+    return (key[bitidx / CHAR_BIT] >> (CHAR_BIT - 1 - bitidx % CHAR_BIT)) & 1u;
+}
+
+// key equality; the common sizes compare as integers
+static inline bool
+_fequkey(
+    const PatriciaFixT  *t  ,
+    const unsigned char *key,
+    const char          *ref)
+{
+    unsigned full = t->_m_nbit / CHAR_BIT, tail = t->_m_nbit % CHAR_BIT;
+    uint64_t a[2], b[2];
+    uint32_t a4, b4;
+
+    if (0 == tail) {
+        switch (full) {
+        case 4:
+            memcpy(&a4, key, 4); memcpy(&b4, ref, 4);
+            return a4 == b4;
+        case 8:
+            memcpy(a, key, 8); memcpy(b, ref, 8);
+            return a[0] == b[0];
+        case 16:
+            memcpy(a, key, 16); memcpy(b, ref, 16);
+            return ((a[0] ^ b[0]) | (a[1] ^ b[1])) == 0;
+        default:
+            return 0 == memcmp(key, ref, full);
+        }
+    }
+    return (0 == memcmp(key, ref, full))
+        && (0 == ((key[full] ^ (unsigned char)ref[full]) & (UCHAR_MAX << (CHAR_BIT - tail)) & UCHAR_MAX));
+}
+
+// free a node through the memory policy
+static void
+_ffree(
+    const PatriciaFixT *t   ,
+    PTFixNodeT         *node)
+{
+    ptnode_release(t->_m_mfunc, t->_m_arena, node, offsetof(PTFixNodeT, data));
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a fixed-length set with the given memory management scheme
+/// The root sentinel is allocated through the memory policy, too.
+/// @param t        set to initialise
+/// @param bitlen   length of all keys in bits
+/// @param fp       function pointer block with memory policy functions
+/// @param arena    additional data for policy functions
+/// @return         @c true on success, @c false if the root could not be allocated
+bool
+patrifix_init_ex(
+    PatriciaFixT     *t     ,
+    uint16_t          bitlen,
+    const PTMemFuncT *fp    ,
+    void             *arena )
+{
+    unsigned nbytes = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+
+    memset(t, 0, sizeof(*t));
+    t->_m_mfunc = fp;
+    t->_m_arena = arena;
+    t->_m_nbit  = bitlen;
+    if (NULL == (t->_m_root = fp->fp_alloc(arena, PATRIFIX_NODE_SIZE(bitlen)))) {
+        return false;
+    }
+    memset(t->_m_root, 0, offsetof(PTFixNodeT, data));
+    memset(t->_m_root->data, UCHAR_MAX, nbytes);
+    t->_m_root->_m_child[0] = t->_m_root->_m_child[1] = t->_m_root;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a fixed-length set with default memory functions
+/// @param t        set to initialise
+/// @param bitlen   length of all keys in bits
+/// @return         @c true on success, @c false if the root could not be allocated
+bool
+patrifix_init(
+    PatriciaFixT *t     ,
+    uint16_t      bitlen)
+{
+    static const PTMemFuncT mf_memfunc = {
+        alloc_wrap,
+        free_wrap,
+        NULL
+    };
+    return patrifix_init_ex(t, bitlen, &mf_memfunc, NULL);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief finalize a fixed-length set
+/// Destroy all nodes in the set, including the root.
+/// @param t        set to flush
+void
+patrifix_fini(
+    PatriciaFixT *t)
+{
+    PTFixNodeT *root = t->_m_root, *list, *hold;
+
+    if (NULL == root) {
+        return;
+    }
+    PT_FUNNEL(PTFixNodeT, root, list);
+    root->_m_child[0] = list;   // the root heads the list
+
+    for (list = root; NULL != (hold = list); ) {
+        list = hold->_m_child[0];
+        _ffree(t, hold);
+    }
+    if (NULL != t->_m_mfunc->fp_kill) {
+        (*t->_m_mfunc->fp_kill)(t->_m_arena);
+    }
+    t->_m_root = NULL;
+    t->_m_ones = false;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key
+/// @param t        set to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits, must be the set's key length
+/// @return         node with exact matching key or @c NULL
+const PTFixNodeT *
+patrifix_lookup(
+    const PatriciaFixT *t     ,
+    const void         *key   ,
+    uint16_t            bitlen)
+{
+    const PTFixNodeT *node = t->_m_root->_m_child[0];
+    unsigned npos, opos = 0;
+
+    if (bitlen != t->_m_nbit) {
+        return NULL;
+    }
+    while ((npos = node->bpos) > opos) {
+        opos = npos;
+        node = node->_m_child[_fgetbit(key, npos)];
+    }
+    if ((node == t->_m_root) && !t->_m_ones) {
+        return NULL;
+    }
+    return _fequkey(t, key, node->data) ? node : NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with a copy of the given key, insert into the set
+/// @param t        set to insert into
+/// @param key      key data storage
+/// @param bitlen   number of bits in key, must be the set's key length
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error or
+///                 key length mismatch
+const PTFixNodeT *
+patrifix_insert(
+    PatriciaFixT *t       ,
+    const void   *key     ,
+    uint16_t      bitlen  ,
+    bool         *inserted)
+{
+    PTFixNodeT *last, *next, *node;
+    unsigned    bpos, nbytes = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+    bool        pdir = false, ndir;
+
+    if (inserted) {
+        *inserted = false;
+    }
+    if (bitlen != t->_m_nbit) {
+        return NULL;
+    }
+    last = t->_m_root;
+    next = last->_m_child[0];
+    while (next->bpos > last->bpos) {
+        last = next;
+        next = last->_m_child[_fgetbit(key, last->bpos)];
+    }
+    if (_fequkey(t, key, next->data)) {
+        if ((next == t->_m_root) && !t->_m_ones) {
+            t->_m_ones = true;  // the all-ones key needs no node
+            if (inserted) {
+                *inserted = true;
+            }
+        }
+        return next;
+    }
+
+    // keys of equal length differ inside the key, so 'bpos' never exceeds it
+    bpos = patricia_bitdiff(key, bitlen, next->data, bitlen);
+    assert((0 != bpos) && (bpos <= bitlen));
+
+    if (NULL == (node = t->_m_mfunc->fp_alloc(t->_m_arena, PATRIFIX_NODE_SIZE(bitlen)))) {
+        return NULL;
+    }
+    node->bpos = (uint16_t)bpos;
+    memcpy(node->data, key, nbytes);
+
+    // second walk, limited by the new branch position, to find the insert parent
+    last = t->_m_root;
+    next = last->_m_child[0];
+    while ((next->bpos > last->bpos) && (next->bpos < bpos)) {
+        last = next;
+        next = last->_m_child[pdir = _fgetbit(key, last->bpos)];
+    }
+    ndir = _fgetbit(key, bpos);
+    node->_m_child[ ndir] = node;
+    node->_m_child[!ndir] = next;
+    last->_m_child[pdir] = node;
+
+    if (inserted) {
+        *inserted = true;
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a key from the set
+/// The node is unlinked the same way as in @c patriset_remove().
+/// @param t        set to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key, must be the set's key length
+/// @return         @c true on success, @c false if the key is not in the set
+bool
+patrifix_remove(
+    PatriciaFixT *t     ,
+    const void   *key   ,
+    uint16_t      bitlen)
+{
+    PTFixNodeT *x, *z, *p, *g;
+
+    if (NULL == (x = (PTFixNodeT *)patrifix_lookup(t, key, bitlen))) {
+        return false;
+    }
+    if (x == t->_m_root) {
+        t->_m_ones = false;
+        return true;
+    }
+
+    // the walk and eviction of the plain set, led by the search key
+    PT_TRACKED_WALK(PTFixNodeT, t->_m_root, x, key, bitlen, g, p, z);
+    PT_UNLINK(g, p, x, z);
+    _ffree(t, x);
+    return true;
+}
+
+// -*- that's all folks -*-
@@ -0,0 +1,67 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET for keys of one fixed length (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - same tree structure and memory policy as the plain set
+//  - the key length is declared at init; keys of other lengths are rejected
+//  - nodes store no key length, all nodes have the same size
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_FIXED_5DE1772B_DCBE_4BA1_9072_BE8B148EFA71
+#define CPATRICIA_FIXED_5DE1772B_DCBE_4BA1_9072_BE8B148EFA71
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "cpatricia_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief node of a fixed-length PATRICIA set
+typedef struct pt_fix_node_ {
+    struct pt_fix_node_ *_m_child[2];///< @brief child[0]=left, child[1]=right
+    uint16_t             bpos;       ///< @brief \bold{(RO)} branching bit position (Pascal index)
+    char                 data[1];    ///< @brief \bold{(RO)} key bytes, no NUL sentinel
+} PTFixNodeT;
+
+/// @brief size of every node block requested from the memory policy
+#define PATRIFIX_NODE_SIZE(bitlen) \
+    (offsetof(PTFixNodeT, data) + ((size_t)(bitlen) + CHAR_BIT - 1) / CHAR_BIT)
+
+/// @brief PATRICIA set with keys of a single length
+/// With all keys of the same length, no key bit beyond the end is ever needed, so bit
+/// extraction needs no clamping or extension, and a key compare needs no length check.
+/// The root sentinel holds the all-ones key, which then is the one key every search
+/// can end at without a real difference; whether it is a member is kept in a flag.
+/// Consequently the node returned for the all-ones key is the root.
+typedef struct {
+    PTFixNodeT         *_m_root;     ///< @brief root & sentinel with the all-ones key
+    const PTMemFuncT   *_m_mfunc;    ///< @brief memory core functions
+    void               *_m_arena;    ///< @brief allocator arena (or NULL)
+    uint16_t            _m_nbit;     ///< @brief key length in bits
+    bool                _m_ones;     ///< @brief all-ones key is in the set
+} PatriciaFixT;
+
+extern bool              patrifix_init_ex(PatriciaFixT *t, uint16_t bitlen, const PTMemFuncT *fp, void *arena);
+extern bool              patrifix_init(PatriciaFixT *t, uint16_t bitlen);
+extern void              patrifix_fini(PatriciaFixT *t);
+
+extern const PTFixNodeT *patrifix_lookup(const PatriciaFixT *t, const void *key, uint16_t bitlen);
+extern const PTFixNodeT *patrifix_insert(PatriciaFixT *t, const void *key, uint16_t bitlen, bool *inserted);
+extern bool              patrifix_remove(PatriciaFixT *t, const void *key, uint16_t bitlen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_FIXED_5DE1772B_DCBE_4BA1_9072_BE8B148EFA71 */
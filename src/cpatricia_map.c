@@ -168,6 +168,14 @@ pool_wrap(void *arena)
 }
 #endif
 
+// -------------------------------------------------------------------------------------
+// the default memory policy for maps
+static const PTMemFuncT mf_memfunc = {
+    alloc_wrap,
+    free_wrap,
+    kill_wrap
+};
+
 // -------------------------------------------------------------------------------------
 // ==== Core operations                                                             ====
 // -------------------------------------------------------------------------------------
@@ -186,6 +194,22 @@ patrimap_init_ex(
     patriset_init_ex(&t->_m_set, fp, arena);
 }
 
+// -------------------------------------------------------------------------------------
+/// @brief set up a PATRICIA tree with the given memory management scheme and batch hooks
+/// @param t        tree to initialise
+/// @param fp       function pointer block with memory policy functions
+/// @param batch    optional batch hooks of the memory policy, or @c NULL
+/// @param arena    additional data for policy functions
+void
+patrimap_init_ex2(
+    PatriciaMapT      *t    ,
+    const PTMemFuncT  *fp   ,
+    const PTMemBatchT *batch,
+    void              *arena)
+{
+    patriset_init_ex2(&t->_m_set, fp, batch, arena);
+}
+
 // -------------------------------------------------------------------------------------
 /// @brief set up a PATRICIA tree with default memory functions
 /// @param t        tree to initialise
@@ -193,11 +217,6 @@ void
 patrimap_init(
     PatriciaMapT* t)
 {
-    static const PTMemFuncT mf_memfunc = {
-        alloc_wrap,
-        free_wrap,
-        kill_wrap
-    };
     patriset_init_ex(&t->_m_set, &mf_memfunc, pool_wrap(&t->_m_mem));
 }
 
@@ -213,6 +232,110 @@ patrimap_fini(
     patriset_fini(&t->_m_set);
 }
 
+// -------------------------------------------------------------------------------------
+// node data copier for cloning: the set layer copies the key, we copy the payload
+static void
+_mcopy(
+    PTSetNodeT       *dst,
+    const PTSetNodeT *src)
+{
+    s2m(dst)->payload = s2m(src)->payload;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief clone a PATRICIA map by copying its structure, with batch memory hooks
+/// The payload is copied bitwise; if it refers to other resources, you might have to
+/// adjust it afterwards.
+///
+/// @param dst      map to create; initialised here
+/// @param src      map to copy
+/// @param fp       memory policy for @c dst or @c NULL for the default policy
+/// @param batch    optional batch hooks of the memory policy (ignored for the default)
+/// @param arena    arena for the memory policy (ignored for the default policy)
+/// @return         @c true on success; on failure, @c dst is left finalised
+bool
+patrimap_clone_ex(
+    PatriciaMapT       *dst  ,
+    const PatriciaMapT *src  ,
+    const PTMemFuncT   *fp   ,
+    const PTMemBatchT  *batch,
+    void               *arena)
+{
+    if (NULL == fp) {
+        fp    = &mf_memfunc;
+        batch = NULL;
+        arena = pool_wrap(&dst->_m_mem);
+    }
+    return patriset_clone_ex(&dst->_m_set, &src->_m_set, fp, batch, arena, _mcopy);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief clone a PATRICIA map by copying its structure
+/// The payload is copied bitwise; if it refers to other resources, you might have to
+/// adjust it afterwards.
+///
+/// @param dst      map to create; initialised here
+/// @param src      map to copy
+/// @param fp       memory policy for @c dst or @c NULL for the default policy
+/// @param arena    arena for the memory policy (ignored for the default policy)
+/// @return         @c true on success; on failure, @c dst is left finalised
+bool
+patrimap_clone(
+    PatriciaMapT       *dst  ,
+    const PatriciaMapT *src  ,
+    const PTMemFuncT   *fp   ,
+    void               *arena)
+{
+    return patrimap_clone_ex(dst, src, fp, NULL, arena);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief read (and optionally clear) the operation counters of a map
+/// @param t        map to inspect
+/// @param out      (opt) where to store the counters
+/// @param reset    clear the counters after reading
+/// @return         @c true if counters are compiled in, @c false otherwise
+bool
+patrimap_counters(
+    const PatriciaMapT *t    ,
+    PTOpCountT         *out  ,
+    bool                reset)
+{
+    return patriset_counters(&t->_m_set, out, reset);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief compute shape statistics of a map; node bytes include the payload
+/// @param t        map to inspect
+/// @param out      where to store the statistics
+/// @return         @c true on success, @c false if the walk stack could not be allocated
+bool
+patrimap_stats(
+    const PatriciaMapT *t  ,
+    PTSetStatsT        *out)
+{
+    bool retv = patriset_stats(&t->_m_set, out);
+    out->node_bytes += out->keys * offsetof(PTMapNodeT, _m_node);
+    return retv;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief estimate shape statistics of a map from random descents
+/// @param t        map to inspect
+/// @param out      where to store the estimates
+/// @param samples  number of random descents
+/// @param seed     random seed
+void
+patrimap_stats_sampled(
+    const PatriciaMapT *t      ,
+    PTSetStatsT        *out    ,
+    size_t              samples,
+    uint64_t            seed   )
+{
+    patriset_stats_sampled(&t->_m_set, out, samples, seed);
+    out->node_bytes += out->keys * offsetof(PTMapNodeT, _m_node);
+}
+
 // -------------------------------------------------------------------------------------
 /// @brief  lookup (exact match) for a key in the patricia tree
 /// @param t        tree to search
@@ -292,6 +415,38 @@ patrimap_remove(
     return patriset_remove(&t->_m_set, key, bitlen);
 }
 
+// -------------------------------------------------------------------------------------
+// predicate adapter: the set layer calls us with set nodes, the user wants map nodes
+typedef struct {
+    bool (*pred)(const PTMapNodeT *, void *);
+    void  *ctx;
+} MapPredT;
+
+static bool
+_mpred(
+    const PTSetNodeT *node,
+    void             *ctx )
+{
+    const MapPredT *mp = ctx;
+    return mp->pred(s2m(node), mp->ctx);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove all nodes matching a predicate in a single traversal
+/// @param t        tree to purge
+/// @param pred     predicate; nodes for which it returns @c true are removed
+/// @param ctx      opaque context passed to the predicate
+/// @return         number of removed nodes
+size_t
+patrimap_remove_if(
+    PatriciaMapT *t,
+    bool        (*pred)(const PTMapNodeT *, void *),
+    void         *ctx)
+{
+    MapPredT mp = { pred, ctx };
+    return patriset_remove_if(&t->_m_set, _mpred, &mp);
+}
+
 // -------------------------------------------------------------------------------------
 // ==== Iteration can be fun, actually ;)                                           ====
 // -------------------------------------------------------------------------------------
@@ -40,14 +40,22 @@ typedef struct {
 } PatriciaMapT;
 
 extern void              patrimap_init_ex(PatriciaMapT *t, const PTMemFuncT *fp, void *arena);
+extern void              patrimap_init_ex2(PatriciaMapT *t, const PTMemFuncT *fp, const PTMemBatchT *batch, void *arena);
 extern void              patrimap_init(PatriciaMapT *t);
 extern void              patrimap_fini(PatriciaMapT *t);
+extern bool              patrimap_clone(PatriciaMapT *dst, const PatriciaMapT *src, const PTMemFuncT *fp, void *arena);
+extern bool              patrimap_clone_ex(PatriciaMapT *dst, const PatriciaMapT *src, const PTMemFuncT *fp,
+                                           const PTMemBatchT *batch, void *arena);
+extern bool              patrimap_counters(const PatriciaMapT *t, PTOpCountT *out, bool reset);
+extern bool              patrimap_stats(const PatriciaMapT *t, PTSetStatsT *out);
+extern void              patrimap_stats_sampled(const PatriciaMapT *t, PTSetStatsT *out, size_t samples, uint64_t seed);
 
 extern const PTMapNodeT *patrimap_lookup(const PatriciaMapT *t, const void *key, uint16_t bitlen);
 extern const PTMapNodeT *patrimap_prefix(const PatriciaMapT *t, const void *key, uint16_t bitlen);
 extern const PTMapNodeT *patrimap_insert(PatriciaMapT *t, const void *key, uint16_t bitlen, bool *inserted);
 extern bool              patrimap_evict(PatriciaMapT *t, PTMapNodeT *node);
 extern bool              patrimap_remove(PatriciaMapT *t, const void *key, uint16_t bitlen);
+extern size_t            patrimap_remove_if(PatriciaMapT *t, bool (*pred)(const PTMapNodeT *, void *), void *ctx);
 
 typedef struct {
     PTSetIterT _m_inner; ///< @brief the inner iterator we're using
@@ -0,0 +1,152 @@
+// -------------------------------------------------------------------------------------
+// Node and topology helpers shared by the PatriciaC sources -- internal header
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - not part of the API; functions are 'static inline' in every includer
+//  - the topology helpers are macros: they work on any node type that has the child
+//    links in '_m_child[2]' and the branch position in 'bpos', like 'PTSetNodeT' and
+//    'PTFixNodeT'
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_NODE_A624045B_F45A_41AD_BC23_FE6546BF79AD
+#define CPATRICIA_NODE_A624045B_F45A_41AD_BC23_FE6546BF79AD
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "cpatricia_set.h"
+
+// -------------------------------------------------------------------------------------
+// ==== default memory policy                                                       ====
+// -------------------------------------------------------------------------------------
+
+// default node allocator using 'malloc()'
+static inline void*
+alloc_wrap(
+    void  *unused,
+    size_t bytes )
+{
+    (void)unused;
+    return malloc(bytes);
+}
+
+// default node deallocator using 'free()'
+static inline void
+free_wrap(
+    void *unused,
+    void *obj   )
+{
+    (void)unused;
+    free(obj);
+}
+
+// Hand a node back to the memory policy.  The first 'head' bytes (the links and branch
+// position) are filled with an easy to recognize pattern first.  A policy without a
+// free hook releases its memory in bulk only; the node is just dropped then.
+static inline void
+ptnode_release(
+    const PTMemFuncT *mfunc,
+    void             *arena,
+    void             *node ,
+    size_t            head )
+{
+    memset(node, 0xFE, head);
+    if (NULL != mfunc->fp_free) {
+        mfunc->fp_free(arena, node);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+// ==== tree topology relation helpers                                              ====
+// -------------------------------------------------------------------------------------
+
+// 'p' links to 'x' (down or up)
+#define _isParentOf(_p_, _x_)     ((bool)(((_p_)->_m_child[0] == (_x_)) | ((_p_)->_m_child[1] == (_x_))))
+
+// index of the link in 'p' that does NOT go to 'x'
+#define _otherIdx(_p_, _x_)   ((unsigned)((_p_)->_m_child[0] == (_x_)))
+
+// index of the link in 'p' that goes to 'x'
+#define _childIdx(_p_, _x_)   ((unsigned)((_p_)->_m_child[1] == (_x_)))
+
+// -------------------------------------------------------------------------------------
+// ==== removal                                                                     ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+// Tracked walk for the removal of node '_x_' (of type '_T_'), led by its key of
+// '_bitlen_' bits at '_key_', from the root sentinel '_root_' down to the uplink to
+// '_x_'.  Afterwards '_z_' is the downlink parent of '_x_', '_p_' holds the uplink to
+// '_x_' and '_g_' is the parent of '_p_'.  '_x_' must be in the tree.
+#define PT_TRACKED_WALK(_T_, _root_, _x_, _key_, _bitlen_, _g_, _p_, _z_)               \
+    do {                                                                                \
+        _T_ *next_;                                                                     \
+        (_z_) = NULL;                                                                   \
+        (_g_) = (_p_) = (_root_);                                                       \
+        next_ = (_p_)->_m_child[0];                                                     \
+        while (next_->bpos > (_p_)->bpos) {                                             \
+            if (next_ == (_x_)) {                                                       \
+                (_z_) = (_p_);                                                          \
+            }                                                                           \
+            (_g_) = (_p_);                                                              \
+            (_p_) = next_;                                                              \
+            next_ = (_p_)->_m_child[patricia_getbit((_key_), (_bitlen_), (_p_)->bpos)]; \
+        }                                                                               \
+        assert(next_ == (_x_));                                                         \
+        assert(NULL != (_z_));                                                          \
+    } while (0)
+
+// -------------------------------------------------------------------------------------
+// Unlink node '_x_' from the tree, given the links of a tracked walk to it: '_p_' holds
+// the uplink to '_x_', '_g_' is the parent of '_p_' and '_z_' the downlink parent of
+// '_x_'.  The node itself is left alone.  See '_evict()' in 'cpatricia_set.c' for the
+// why; in short:
+//
+//  Step I:  bypass 'p' in the path 'g' -> 'p' -> 'x', linking 'g' to the survivor
+//  Step II: if 'x' != 'p', 'p' takes the place of 'x' below 'z', with its links and
+//           branch position
+#define PT_UNLINK(_g_, _p_, _x_, _z_)                                                   \
+    do {                                                                                \
+        assert(_isParentOf((_p_), (_x_)));                                              \
+        assert(_isParentOf((_g_), (_p_)));                                              \
+        (_g_)->_m_child[_childIdx((_g_), (_p_))] =                                      \
+            (_p_)->_m_child[_otherIdx((_p_), (_x_))];                                   \
+        if ((_x_) != (_p_)) {                                                           \
+            assert(_isParentOf((_z_), (_x_)));                                          \
+            (_z_)->_m_child[_childIdx((_z_), (_x_))] = (_p_);                           \
+            (_p_)->_m_child[0] = (_x_)->_m_child[0];                                    \
+            (_p_)->_m_child[1] = (_x_)->_m_child[1];                                    \
+            (_p_)->bpos = (_x_)->bpos;                                                  \
+        }                                                                               \
+    } while (0)
+
+// -------------------------------------------------------------------------------------
+// ==== tree destruction                                                            ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+// Cut all nodes of type '_T_' from the root sentinel '_root_' and collect them in
+// '_list_', linked by '_m_child[0]'.  The root is left as the empty tree.
+//
+// Squeezing the tree through a funnel to create a single-linked list of nodes is the
+// only iterative O(N) solution for cleaning up a Sedgewick-style PATRICIA tree.  The
+// rightmost leaf is forced to the root ONCE, which gives the funnel an unambigeous
+// termination condition; the bit-position relation is destroyed on the right subtrees
+// on the way.  Where a node has a left subtree, the tail is grafted to the rightmost
+// link on the right spine of that subtree, effectively funnelling the nodes into a
+// sequence.  Every node is visited at most twice.
+//
+// The funnelled nodes MUST NOT be freed immediately, or we would end with dangling
+// uplink pointers.  Instead they are pushed to the list with a zero branch position,
+// so remaining references to them are seen as uplinks.
+#define PT_FUNNEL(_T_, _root_, _list_)                                                      do {                                                                                        _T_ *hold_ = (_root_)->_m_child[0], *scan_;                                             (_root_)->_m_child[0] = (_root_)->_m_child[1] = (_root_);                               (_list_) = NULL;                                                                        for (scan_ = hold_; scan_->_m_child[1]->bpos > scan_->bpos; ) {                             scan_ = scan_->_m_child[1];                                                         }                                                                                       scan_->_m_child[1] = (_root_);                                                          while ((_root_) != hold_) {                                                                 _T_ *next_ = hold_->_m_child[0];    /* never NULL, subtree intact        */             _T_ *tail_ = hold_->_m_child[1];    /* never NULL, degraded by funnel    */             if (next_->bpos <= hold_->bpos) {                                                           next_ = tail_;                  /* left is an uplink, go right       */             } else {                                                                                    for (scan_ = next_; scan_->_m_child[1]->bpos > scan_->bpos; ) {                             scan_ = scan_->_m_child[1];                                                         }                                                                                       scan_->_m_child[1] = tail_;     /* graft tail to the right spine     */             }                                                                                       hold_->bpos = 0;                                                                        hold_->_m_child[0] = (_list_);                                                          (_list_) = hold_;                                                                       hold_ = next_;                                                                      }                                                                                   } while (0)
+
+#endif /* CPATRICIA_NODE_A624045B_F45A_41AD_BC23_FE6546BF79AD */
@@ -0,0 +1,607 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, PERSISTENT variant (compressed radix-2 tree, path copying)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// The dual-use node design of the mutable set cannot be shared between versions: every
+// node is both a router and a key holder, and the uplinks point back into the tree, so
+// any change ripples through pointers that other versions would see.  This variant uses
+// the classical layout instead: internal nodes carry only the branch position and two
+// children, leaves carry the key, and all links point downward.
+//
+// With downward-only links, a version is fully described by its root pointer.  Nodes
+// are reference counted; the count is the number of links from other nodes plus the
+// number of handles that use the node as root.  A change copies only the nodes on the
+// path from the root to the point of change, and each copy adds one reference to the
+// children it shares with the original.  The rule for when to copy is thus local:
+// a node with a reference count of one is reachable only through the path we just
+// made private, and can be changed in place; anything else is copied.  If a version
+// has never been snapshotted, nothing is ever copied and the tree is updated in place.
+//
+// Taking a snapshot is O(1): copy the handle and increment the root count.  Releasing
+// a version decrements the root count and frees whatever drops to zero, without any
+// recursion.
+//
+// The bit semantics are the same as for the mutable set: keys extend with the
+// complement of their last bit, so no key is a bit-prefix of another one and every key
+// ends up in its own leaf.
+// -------------------------------------------------------------------------------------
+//  - memory management can be dealt with via user-provided policy
+//  - keys are piggy-packed into the leaves
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_pers.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+#if (defined(__GNUC__) || defined(__clang__))
+# define UNLIKELY(x)    __builtin_expect(!!(x), 0)
+# define LIKELY(x)      __builtin_expect(!!(x), 1)
+#else
+# define UNLIKELY(x)    x
+# define LIKELY(x)      x
+#endif
+
+// -------------------------------------------------------------------------------------
+// ==== memory allocation & helpers                                                 ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+// default node allocator using 'malloc()'
+static void*
+alloc_wrap(
+    void  *unused,
+    size_t bytes )
+{
+    (void)unused;
+    return malloc(bytes);
+}
+
+// -------------------------------------------------------------------------------------
+// default node deallocator using 'free()'
+static void
+free_wrap(
+    void *unused,
+    void *obj   )
+{
+    (void)unused;
+    free(obj);
+}
+
+static const PTMemFuncT mf_memfunc = {
+    alloc_wrap,
+    free_wrap,
+    NULL
+};
+
+// -------------------------------------------------------------------------------------
+// Create a leaf from a bit string.  Like the mutable set nodes, leaves get one extra
+// NUL byte at the end of the key for safe string processing.
+static PTPersNodeT*
+ppnode_leaf(
+    const PatriciaPersT *tree  ,
+    const void          *keystr,
+    uint16_t             bitlen)
+{
+    unsigned     bytelen = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+    size_t       nodelen = offsetof(PTPersNodeT, u.data) + bytelen + 1;
+    PTPersNodeT *nodeptr = tree->_m_mfunc->fp_alloc(tree->_m_arena, nodelen);
+    if (LIKELY(NULL != nodeptr)) {
+        nodeptr->_m_refs = 1;
+        nodeptr->bpos = 0;
+        nodeptr->nbit = bitlen;
+        memcpy(nodeptr->u.data, keystr, bytelen);
+        nodeptr->u.data[bytelen] = '\0';  // ASCIIZ sentinel
+    }
+    return nodeptr;
+}
+
+// -------------------------------------------------------------------------------------
+// Create an internal node with the given branch position and no children yet.
+static PTPersNodeT*
+ppnode_inner(
+    const PatriciaPersT *tree,
+    uint16_t             bpos)
+{
+    PTPersNodeT *nodeptr = tree->_m_mfunc->fp_alloc(tree->_m_arena, sizeof(PTPersNodeT));
+    if (LIKELY(NULL != nodeptr)) {
+        nodeptr->_m_refs = 1;
+        nodeptr->bpos = bpos;
+        nodeptr->nbit = 0;
+        nodeptr->u._m_child[0] = nodeptr->u._m_child[1] = NULL;
+    }
+    return nodeptr;
+}
+
+// -------------------------------------------------------------------------------------
+// Node deallocation helper; a missing free function is fine for bulk-release arenas.
+static void
+ppnode_free(
+    const PatriciaPersT *tree,
+    PTPersNodeT         *node)
+{
+    if (NULL != tree->_m_mfunc->fp_free) {
+        tree->_m_mfunc->fp_free(tree->_m_arena, node);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+// Drop one reference to a node and free everything that becomes unreachable.  The
+// nodes being freed double as the DFS stack: a dead internal node keeps its right
+// child and links to the next pending node through its left child slot.
+static void
+ppnode_release(
+    const PatriciaPersT *tree,
+    PTPersNodeT         *node)
+{
+    PTPersNodeT *stack = NULL, *next;
+
+    for (;;) {
+        if (NULL != node && 0 == --node->_m_refs) {
+            if (0 == node->bpos) {
+                ppnode_free(tree, node);
+            } else {
+                next = node->u._m_child[0];
+                node->u._m_child[0] = stack;
+                stack = node;
+                node = next;
+                continue;
+            }
+        }
+        if (NULL == (next = stack)) {
+            break;
+        }
+        stack = next->u._m_child[0];
+        node  = next->u._m_child[1];
+        ppnode_free(tree, next);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+// Make a node private to the path being modified.  A node referenced exactly once is
+// only reachable through that path and is returned as-is.  Otherwise a copy is made
+// that shares the children with the original, and the reference that is about to be
+// redirected to the copy is taken from the original.  Returns NULL on allocation error.
+static PTPersNodeT*
+ppnode_own(
+    const PatriciaPersT *tree,
+    PTPersNodeT         *node)
+{
+    PTPersNodeT *copy;
+
+    if (1 == node->_m_refs) {
+        return node;
+    }
+    if (NULL != (copy = ppnode_inner(tree, node->bpos))) {
+        copy->u._m_child[0] = node->u._m_child[0];
+        copy->u._m_child[1] = node->u._m_child[1];
+        ++copy->u._m_child[0]->_m_refs;
+        ++copy->u._m_child[1]->_m_refs;
+        --node->_m_refs;
+    }
+    return copy;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Version management                                                          ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an empty persistent set with the given memory management scheme
+///
+/// All versions derived from this handle share nodes, so the memory policy has to
+/// support freeing single nodes or bulk release by the caller.  The arena killer of
+/// the policy is never called: no single version knows when the arena is unused.
+///
+/// @param tree     handle to initialise
+/// @param fp       function pointer block with memory policy functions
+/// @param arena    additional data for policy functions
+void
+patripers_init_ex(
+    PatriciaPersT    *tree ,
+    const PTMemFuncT *fp   ,
+    void             *arena)
+{
+    memset(tree, 0, sizeof(*tree));
+    tree->_m_mfunc = fp;
+    tree->_m_arena = arena;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an empty persistent set with default memory functions
+/// @param tree     handle to initialise
+void
+patripers_init(
+    PatriciaPersT *tree)
+{
+    patripers_init_ex(tree, &mf_memfunc, NULL);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief release a version
+/// Nodes still shared with other versions stay alive.  The handle is left empty and
+/// can be used again.
+///
+/// @param tree     handle of the version to drop
+void
+patripers_fini(
+    PatriciaPersT *tree)
+{
+    PTPersNodeT *root = tree->_m_root;
+
+    tree->_m_root  = NULL;
+    tree->_m_count = 0;
+    ppnode_release(tree, root);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief take an O(1) snapshot of a version
+///
+/// The new handle shares all nodes with the source.  Both handles can be modified
+/// independently afterwards; the first change on either side copies the affected path.
+/// @p dst must not hold a version (initialised or not).
+///
+/// @param dst      handle that receives the snapshot
+/// @param src      version to take a snapshot of
+void
+patripers_snapshot(
+    PatriciaPersT       *dst,
+    const PatriciaPersT *src)
+{
+    *dst = *src;
+    if (NULL != dst->_m_root) {
+        ++dst->_m_root->_m_refs;
+    }
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief get the number of keys in a version
+/// @param tree     version to inspect
+/// @return         number of keys
+size_t
+patripers_count(
+    const PatriciaPersT *tree)
+{
+    return tree->_m_count;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief  lookup (exact match) for a key in a version
+/// @param tree     version to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         leaf with exact matching key or @c NULL
+const PTPersNodeT *
+patripers_lookup(
+    const PatriciaPersT *tree,
+    const void          *key ,
+    uint16_t           bitlen)
+{
+    const PTPersNodeT *node = tree->_m_root;
+
+    if (NULL == node) {
+        return NULL;
+    }
+    while (0 != node->bpos) {
+        node = node->u._m_child[patricia_getbit(key, bitlen, node->bpos)];
+    }
+    return patricia_equkey(key, bitlen, node->u.data, node->nbit) ? node : NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief longest prefix match for a key in a version
+///
+/// Without keys in the internal nodes, the candidates are not on the search path.  A
+/// key of length L that is a prefix of the search key continues with the complement
+/// of its last bit, and leaves the search path at the first internal node where the
+/// search key has the same bit again.  From there it follows the opposite direction
+/// down to its leaf.  So at each internal node, there is at most one candidate, found
+/// by going to the other child and keeping that direction.  This costs O(depth²) in
+/// the worst case, but the side walks are short for typical trees.
+///
+/// @param tree     version to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         leaf with longest prefix key or @c NULL
+const PTPersNodeT *
+patripers_prefix(
+    const PatriciaPersT *tree,
+    const void          *key ,
+    uint16_t           bitlen)
+{
+    const PTPersNodeT *best = NULL, *node = tree->_m_root, *side;
+    bool               dir;
+
+    if (NULL == node) {
+        return NULL;
+    }
+    while (0 != node->bpos) {
+        dir  = patricia_getbit(key, bitlen, node->bpos);
+        side = node->u._m_child[!dir];
+        while (0 != side->bpos) {
+            side = side->u._m_child[!dir];
+        }
+        if ((side->nbit < node->bpos) && (side->nbit <= bitlen)
+            && (NULL == best || side->nbit > best->nbit)
+            && patricia_equkey(key, side->nbit, side->u.data, side->nbit))
+        {
+            best = side;
+        }
+        node = node->u._m_child[dir];
+    }
+    if ((node->nbit <= bitlen) && (NULL == best || node->nbit > best->nbit)
+        && patricia_equkey(key, node->nbit, node->u.data, node->nbit))
+    {
+        best = node;
+    }
+    return best;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief  create a leaf with the given key, insert it into a version
+///
+/// Nodes on the path from the root to the new branch point are copied if they are
+/// shared with other versions; unshared nodes are updated in place.
+///
+/// @param tree     version to insert into
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @param inserted opt. storage for 'node created' flag
+/// @return         leaf with matching key (new or existing) or @c NULL on error
+const PTPersNodeT *
+patripers_insert(
+    PatriciaPersT *tree,
+    const void    *key ,
+    uint16_t     bitlen,
+    bool      *inserted)
+{
+    PTPersNodeT *next, *leaf, *node, **link;
+    unsigned     bpos;
+    bool         dir;
+
+    if (inserted) {
+        *inserted = false;
+    }
+
+    // -- empty set: the new leaf becomes the root ------------------------------------
+    if (NULL == (next = tree->_m_root)) {
+        if (NULL != (leaf = ppnode_leaf(tree, key, bitlen))) {
+            tree->_m_root  = leaf;
+            tree->_m_count = 1;
+            if (inserted) {
+                *inserted = true;
+            }
+        }
+        return leaf;
+    }
+
+    // -- find the closest leaf and the branch position --------------------------------
+    while (0 != next->bpos) {
+        next = next->u._m_child[patricia_getbit(key, bitlen, next->bpos)];
+    }
+    if (patricia_equkey(key, bitlen, next->u.data, next->nbit)) {
+        return next; // existing leaf
+    }
+    bpos = patricia_bitdiff(key, bitlen, next->u.data, next->nbit);
+    assert(0 != bpos);
+
+    // -- allocate up front, so the path copy cannot fail halfway ----------------------
+    leaf = ppnode_leaf(tree, key, bitlen);
+    node = ppnode_inner(tree, (uint16_t)bpos);
+    if (NULL == leaf || NULL == node) {
+        if (leaf) ppnode_free(tree, leaf);
+        if (node) ppnode_free(tree, node);
+        return NULL;
+    }
+
+    // -- copy the path down to the branch point ---------------------------------------
+    // If copying fails, the part copied so far is still a valid tree for the same set
+    // of keys, so we can just bail out.
+    link = &tree->_m_root;
+    while (0 != (next = *link)->bpos && next->bpos < bpos) {
+        if (NULL == (next = ppnode_own(tree, next))) {
+            ppnode_free(tree, leaf);
+            ppnode_free(tree, node);
+            return NULL;
+        }
+        *link = next;
+        link  = &next->u._m_child[patricia_getbit(key, bitlen, next->bpos)];
+    }
+
+    // -- splice in the new internal node: the old subtree just changes its owner ------
+    dir = patricia_getbit(key, bitlen, (uint16_t)bpos);
+    node->u._m_child[ dir] = leaf;
+    node->u._m_child[!dir] = next;
+    *link = node;
+    ++tree->_m_count;
+    if (inserted) {
+        *inserted = true;
+    }
+    return leaf;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief  remove a key from a version
+///
+/// The parent of the leaf is replaced by the sibling subtree; nodes above it are copied
+/// if shared.  The leaf and its parent are released, so they stay alive as long as
+/// other versions use them.
+///
+/// @param tree     version to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @return         @c true if the key was found and removed
+bool
+patripers_remove(
+    PatriciaPersT *tree,
+    const void    *key ,
+    uint16_t     bitlen)
+{
+    PTPersNodeT *node, *next, *sibl, **link;
+    bool         dir;
+
+    if (NULL == patripers_lookup(tree, key, bitlen)) {
+        return false;
+    }
+
+    // -- single leaf: the set becomes empty -------------------------------------------
+    link = &tree->_m_root;
+    if (0 == (node = *link)->bpos) {
+        patripers_fini(tree);
+        return true;
+    }
+
+    // -- copy the path down to the grandparent of the leaf ----------------------------
+    // Invariant: 'node' is internal and '*link == node', with all nodes above owned.
+    for (;;) {
+        dir  = patricia_getbit(key, bitlen, node->bpos);
+        next = node->u._m_child[dir];
+        if (0 == next->bpos) {
+            break;
+        }
+        if (NULL == (node = ppnode_own(tree, node))) {
+            return false;
+        }
+        *link = node;
+        link  = &node->u._m_child[dir];
+        node  = next;
+    }
+
+    // -- replace the parent by the sibling, then drop the parent ----------------------
+    // The new link to the sibling takes its own reference; releasing the parent either
+    // frees it (and then drops the references to leaf & sibling), or leaves it with the
+    // other versions that share it.
+    sibl = node->u._m_child[!dir];
+    ++sibl->_m_refs;
+    *link = sibl;
+    ppnode_release(tree, node);
+    --tree->_m_count;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Iterator                                                                    ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+// get the first leaf of a subtree when walking in direction 'dir'
+static const PTPersNodeT *
+iter_first(
+    const PTPersNodeT *node,
+    bool               dir )
+{
+    while (0 != node->bpos) {
+        node = node->u._m_child[!dir];
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+// Get the leaf following 'leaf' in direction 'dir'.  Walk down to the leaf by its key
+// and remember the last subtree we did not take on the 'dir' side; its first leaf is
+// the successor.
+static const PTPersNodeT *
+iter_succ(
+    const PTPersNodeT *root,
+    const PTPersNodeT *leaf,
+    bool               dir )
+{
+    const PTPersNodeT *hold = NULL;
+
+    while (0 != root->bpos) {
+        bool bit = patricia_getbit(leaf->u.data, leaf->nbit, root->bpos);
+        if (bit != dir) {
+            hold = root->u._m_child[dir];
+        }
+        root = root->u._m_child[bit];
+    }
+    return hold ? iter_first(hold, dir) : NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief initialise an iterator over a version
+/// @param iter     iterator to set up
+/// @param tree     version to iterate
+/// @param dir      direction, @c true is left-to-right (ascending bit order)
+void
+ppersiter_init(
+    PTPersIterT         *iter,
+    const PatriciaPersT *tree,
+    bool                 dir )
+{
+    iter->_m_root = tree->_m_root;
+    iter->_m_dir  = dir;
+    ppersiter_reset(iter);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief step forward to the next leaf
+/// @param iter     iterator to advance
+/// @return         next leaf, or @c NULL at the end
+const PTPersNodeT *
+ppersiter_next(
+    PTPersIterT *iter)
+{
+    if (NULL == iter->_m_root || iter->_m_tail) {
+        iter->_m_tail = true;
+        iter->_m_leaf = NULL;
+    } else if (NULL == iter->_m_leaf) {
+        iter->_m_leaf = iter_first(iter->_m_root, iter->_m_dir);
+    } else if (!iter->_m_back) {
+        iter->_m_leaf = iter_succ(iter->_m_root, iter->_m_leaf, iter->_m_dir);
+        iter->_m_tail = (NULL == iter->_m_leaf);
+    }
+    iter->_m_back = false;
+    return iter->_m_leaf;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief step back to the previous leaf
+/// Stepping back from the end yields the last leaf; stepping back from the first leaf
+/// returns to the start.
+///
+/// @param iter     iterator to move
+/// @return         previous leaf, or @c NULL at the start
+const PTPersNodeT *
+ppersiter_prev(
+    PTPersIterT *iter)
+{
+    if (NULL == iter->_m_root) {
+        iter->_m_leaf = NULL;
+    } else if (iter->_m_tail) {
+        iter->_m_tail = false;
+        iter->_m_leaf = iter_first(iter->_m_root, !iter->_m_dir);
+    } else if (NULL != iter->_m_leaf && iter->_m_back) {
+        iter->_m_leaf = iter_succ(iter->_m_root, iter->_m_leaf, !iter->_m_dir);
+    }
+    iter->_m_back = true;
+    return iter->_m_leaf;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief reset the iterator to the start
+/// @param iter     iterator to reset
+void
+ppersiter_reset(
+    PTPersIterT *iter)
+{
+    iter->_m_leaf = NULL;
+    iter->_m_tail = false;
+    iter->_m_back = false;
+}
+
+// -*- that's all folks -*-
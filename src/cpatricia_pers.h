@@ -0,0 +1,88 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, PERSISTENT variant (compressed radix-2 tree, path copying)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - classic layout with explicit internal nodes and key-holding leaves
+//  - nodes are reference counted and shared between versions
+//  - modifications copy the path from the root to the change point
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_PERS_66DD4A18_7A24_4757_AF50_4E3D0676A31D
+#define CPATRICIA_PERS_66DD4A18_7A24_4757_AF50_4E3D0676A31D
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpatricia_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief node of a persistent PATRICIA set
+/// Internal nodes have a branch position and two children; leaves have a zero branch
+/// position and hold the key.  Leaves are allocated only as big as the key needs.
+typedef struct pt_pers_node_ {
+    uint32_t                  _m_refs;    ///< @brief reference count (links + handles)
+    uint16_t                  bpos;       ///< @brief \bold{(RO)} branch bit position, 0 for leaves
+    uint16_t                  nbit;       ///< @brief \bold{(RO)} key length in bits (leaves)
+    union {
+        struct pt_pers_node_ *_m_child[2];///< @brief children of internal nodes
+        char                  data[1];    ///< @brief \bold{(RO)} piggy-packed key bytes (leaves)
+    } u;
+} PTPersNodeT;
+
+/// @brief handle to one version of a persistent PATRICIA set
+/// Every handle owns a reference to its root; taking a snapshot is just copying the
+/// root pointer and bumping the reference count.  Versions never see changes made
+/// through other handles.
+typedef struct patricia_pers_ {
+    PTPersNodeT        *_m_root;     ///< @brief root node or @c NULL for empty set
+    size_t              _m_count;    ///< @brief number of keys in this version
+    const PTMemFuncT   *_m_mfunc;    ///< @brief memory core functions
+    void               *_m_arena;    ///< @brief allocator arena (or NULL)
+} PatriciaPersT;
+
+extern void               patripers_init_ex(PatriciaPersT *t, const PTMemFuncT *fp, void *arena);
+extern void               patripers_init(PatriciaPersT *t);
+extern void               patripers_fini(PatriciaPersT *t);
+extern void               patripers_snapshot(PatriciaPersT *dst, const PatriciaPersT *src);
+extern size_t             patripers_count(const PatriciaPersT *t);
+
+extern const PTPersNodeT *patripers_lookup(const PatriciaPersT *t, const void *key, uint16_t bitlen);
+extern const PTPersNodeT *patripers_prefix(const PatriciaPersT *t, const void *key, uint16_t bitlen);
+extern const PTPersNodeT *patripers_insert(PatriciaPersT *t, const void *key, uint16_t bitlen, bool *inserted);
+extern bool               patripers_remove(PatriciaPersT *t, const void *key, uint16_t bitlen);
+
+/// @brief persistent set iterator
+/// Only leaves hold keys, so pre-, in- and post-order are all the same here.  There is
+/// no parent stack: the successor is found by a walk from the root, remembering the
+/// last point where the search went to the first child.  The iterator pins the version
+/// seen at initialisation, but does not own it; keep the handle alive while iterating.
+/// Like the set iterator, it is a cursor between leaves: stepping back right after a
+/// step forward yields the same leaf again.
+typedef struct {
+    const PTPersNodeT  *_m_root;     ///< @brief root of the version to iterate
+    const PTPersNodeT  *_m_leaf;     ///< @brief leaf yielded last or @c NULL
+    bool                _m_tail;     ///< @brief @c true if after the last leaf
+    bool                _m_back;     ///< @brief @c true if cursor is before @c _m_leaf
+    bool                _m_dir;      ///< @brief direction, true is left-to-right
+} PTPersIterT;
+
+extern void               ppersiter_init(PTPersIterT *i, const PatriciaPersT *t, bool dir);
+extern const PTPersNodeT *ppersiter_next(PTPersIterT *i);
+extern const PTPersNodeT *ppersiter_prev(PTPersIterT *i);
+extern void               ppersiter_reset(PTPersIterT *i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_PERS_66DD4A18_7A24_4757_AF50_4E3D0676A31D */
@@ -0,0 +1,42 @@
+// -------------------------------------------------------------------------------------
+// Static tracepoints (USDT) for PatriciaC -- internal header
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - compiled in only with PATRICIA_USDT defined; needs <sys/sdt.h> from SystemTap
+//  - a probe site is a single NOP until a tracer attaches to it
+//  - without PATRICIA_USDT, the probe arguments are evaluated for nothing and the
+//    optimiser drops them; local counters feeding only probes cost nothing, either
+//
+// Provider is 'patriciac'; probes and arguments:
+//
+//   set_insert       (key bits, nodes passed, 1 if a node was created)
+//   set_remove       (key bits, 1 if the key was found)
+//   set_lookup_miss  (key bits, nodes passed)
+//   iter_rewalk      (key bits of the node, nodes passed on the recovery walk)
+//   arena_morecore   (bytes reserved for the new block, arena total)
+//   arena_commit     (bytes committed, arena total)
+//
+// 'set_remove' looks the key up first, so removing an absent key also fires
+// 'set_lookup_miss'.  Map operations run through the set code and fire the same probes.
+//
+// Example:  bpftrace -e 'usdt:./app:patriciac:set_lookup_miss { @[arg1] = count(); }'
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_PROBES_CBB61FC7_95F9_489C_BDCA_17F703641666
+#define CPATRICIA_PROBES_CBB61FC7_95F9_489C_BDCA_17F703641666
+
+#ifdef PATRICIA_USDT
+# include <sys/sdt.h>
+# define PT_PROBE2(_n_, _a_, _b_)       DTRACE_PROBE2(patriciac, _n_, _a_, _b_)
+# define PT_PROBE3(_n_, _a_, _b_, _c_)  DTRACE_PROBE3(patriciac, _n_, _a_, _b_, _c_)
+#else
+# define PT_PROBE2(_n_, _a_, _b_)       ((void)(_a_), (void)(_b_))
+# define PT_PROBE3(_n_, _a_, _b_, _c_)  ((void)(_a_), (void)(_b_), (void)(_c_))
+#endif
+
+#endif /* CPATRICIA_PROBES_CBB61FC7_95F9_489C_BDCA_17F703641666 */
@@ -0,0 +1,355 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with external key references (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// The tree is a plain set tree; only the key storage differs.  Where the set copies the
+// key into the node, this variant stores an opaque reference (pointer, offset, index)
+// and asks the resolver for the key bits whenever it needs them: once for the final
+// compare of a lookup, and once more for the new key on insert.  The walks themselves
+// cost the same as in the plain set.
+//
+// The sentinel root is a node of the embedded set and holds the empty key; it is never
+// passed to the resolver.
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_ref.h"
+#include "cpatricia_node.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+
+// -------------------------------------------------------------------------------------
+// ==== node references                                                             ====
+// -------------------------------------------------------------------------------------
+
+// the key reference of a node; the data area is not aligned for 'uintptr_t'
+static inline uintptr_t
+_rref(
+    const PTSetNodeT *n)
+{
+    uintptr_t ref;
+    memcpy(&ref, n->data, sizeof(ref));
+    return ref;
+}
+
+// the key bits of a node
+static inline const void *
+_rkey(
+    const PatriciaRefT *t,
+    const PTSetNodeT   *n)
+{
+    return (n == t->_m_set._m_root) ? "" : t->_m_resolve(t->_m_rctx, _rref(n));
+}
+
+// key getter for the set iterator; the context is the reference set
+static const void *
+_ikey(
+    const void       *ctx,
+    const PTSetNodeT *n  )
+{
+    return _rkey((const PatriciaRefT *)ctx, n);
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a reference set with the given memory management scheme
+/// @param t        set to initialise
+/// @param fn       resolver turning references into key pointers
+/// @param ctx      context for the resolver
+/// @param fp       function pointer block with memory policy functions
+/// @param arena    additional data for policy functions
+void
+patriref_init_ex(
+    PatriciaRefT     *t    ,
+    PTKeyResolveT     fn   ,
+    void             *ctx  ,
+    const PTMemFuncT *fp   ,
+    void             *arena)
+{
+    patriset_init_ex(&t->_m_set, fp, arena);
+    t->_m_resolve = fn;
+    t->_m_rctx    = ctx;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a reference set with default memory functions
+/// @param t        set to initialise
+/// @param fn       resolver turning references into key pointers
+/// @param ctx      context for the resolver
+void
+patriref_init(
+    PatriciaRefT  *t  ,
+    PTKeyResolveT  fn ,
+    void          *ctx)
+{
+    patriset_init(&t->_m_set);
+    t->_m_resolve = fn;
+    t->_m_rctx    = ctx;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief finalize a reference set, destroying all nodes (but not the keys)
+/// @param t        set to flush
+void
+patriref_fini(
+    PatriciaRefT *t)
+{
+    patriset_fini(&t->_m_set);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key
+/// @param t        set to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patriref_lookup(
+    const PatriciaRefT *t     ,
+    const void         *key   ,
+    uint16_t            bitlen)
+{
+    const PTSetNodeT *node = t->_m_set._m_root->_m_child[0];
+    unsigned npos, opos = t->_m_set._m_root->bpos;
+
+    while ((npos = node->bpos) > opos) {
+        opos = npos;
+        node = node->_m_child[patricia_getbit(key, bitlen, node->bpos)];
+    }
+    if ((node->nbit == bitlen) && patricia_equkey(key, bitlen, _rkey(t, node), node->nbit)) {
+        return node;
+    }
+    return NULL;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node for a key reference, insert into the set
+///
+/// The key is not copied.  It must stay valid and unchanged as long as the node is in
+/// the set.  If the key is already in the set, the existing node (and reference) is
+/// returned.
+///
+/// @param t        set to insert into
+/// @param ref      reference to the key, resolved by the set's resolver
+/// @param bitlen   number of bits in key
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patriref_insert(
+    PatriciaRefT *t       ,
+    uintptr_t     ref     ,
+    uint16_t      bitlen  ,
+    bool         *inserted)
+{
+    PatriciaSetT *tree = &t->_m_set;
+    PTSetNodeT   *last, *next, *node;
+    const void   *key  = t->_m_resolve(t->_m_rctx, ref), *nkey;
+    unsigned      bpos;
+    bool          pdir = false, ndir;
+
+    if (inserted) {
+        *inserted = false;
+    }
+
+    last = tree->_m_root;
+    next = tree->_m_root->_m_child[0];
+    while (next->bpos > last->bpos) {
+        last = next;
+        next = last->_m_child[patricia_getbit(key, bitlen, last->bpos)];
+    }
+    nkey = _rkey(t, next);
+    if (patricia_equkey(key, bitlen, nkey, next->nbit)) {
+        return next; // existing node
+    }
+    bpos = patricia_bitdiff(key, bitlen, nkey, next->nbit);
+    assert(0 != bpos);
+
+    // all nodes have the same size, and there's no key to copy
+    if (NULL == (node = tree->_m_mfunc->fp_alloc(tree->_m_arena, PATRIREF_NODE_SIZE))) {
+        return NULL;
+    }
+    memset(node, 0, offsetof(PTSetNodeT, data));
+    memcpy(node->data, &ref, sizeof(ref));
+    node->nbit = bitlen;
+    node->bpos = (uint16_t)bpos;
+
+    // find insert parent, depth-limited by the new branch position
+    last = tree->_m_root;
+    next = tree->_m_root->_m_child[0];
+    while ((next->bpos > last->bpos) && (next->bpos < bpos)) {
+        last = next;
+        pdir = patricia_getbit(key, bitlen, last->bpos);
+        next = last->_m_child[pdir];
+    }
+
+    ndir = patricia_getbit(key, bitlen, bpos);
+    node->_m_child[ ndir] = node;
+    node->_m_child[!ndir] = next;
+    last->_m_child[pdir]  = node;
+
+    if (inserted) {
+        *inserted = true;
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a key from the set
+///
+/// Only the node is released; the referenced key storage is left alone.
+///
+/// @param t        set to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @return         @c true on success, @c false if the key is not in the set
+bool
+patriref_remove(
+    PatriciaRefT *t     ,
+    const void   *key   ,
+    uint16_t      bitlen)
+{
+    PatriciaSetT *tree = &t->_m_set;
+    PTSetNodeT   *x, *z, *g, *p;
+
+    if (NULL == (x = (PTSetNodeT *)patriref_lookup(t, key, bitlen))) {
+        return false;
+    }
+
+    // the walk and eviction of the plain set, led by the search key
+    PT_TRACKED_WALK(PTSetNodeT, tree->_m_root, x, key, bitlen, g, p, z);
+    PT_UNLINK(g, p, x, z);
+
+    memset(x, 0, offsetof(PTSetNodeT, data));
+    if (NULL != tree->_m_mfunc->fp_free) {
+        tree->_m_mfunc->fp_free(tree->_m_arena, x);
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief key reference of a node
+/// @param node     node to inspect
+/// @return         the reference given to @c patriref_insert()
+uintptr_t
+patriref_ref(
+    const PTSetNodeT *node)
+{
+    return _rref(node);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief point a node to another copy of its key
+///
+/// For moving keys between storages, e.g. from a caller's buffer to a permanent store
+/// after a successful insert.  The new reference must resolve to the same key bits.
+///
+/// @param node     node to change
+/// @param ref      new key reference
+void
+patriref_rebind(
+    PTSetNodeT *node,
+    uintptr_t   ref )
+{
+    memcpy(node->data, &ref, sizeof(ref));
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief key bits of a node, as resolved by the set's resolver
+/// @param t        set owning the node
+/// @param node     node to inspect
+/// @return         pointer to the key bits; @c node->nbit holds the length
+const void *
+patriref_key(
+    const PatriciaRefT *t   ,
+    const PTSetNodeT   *node)
+{
+    return _rkey(t, node);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief compute shape statistics of a reference set
+///
+/// The shape figures are those of @c patriset_stats().  The keys live outside the set,
+/// so @c key_bytes is zero, and every node has @c PATRIREF_NODE_SIZE bytes.
+///
+/// @param t        set to inspect
+/// @param out      where to store the statistics
+/// @return         @c true on success, @c false if the walk stack could not be allocated
+bool
+patriref_stats(
+    const PatriciaRefT *t  ,
+    PTSetStatsT        *out)
+{
+    if (!patriset_stats(&t->_m_set, out)) {
+        return false;
+    }
+    out->key_bytes  = 0;
+    out->node_bytes = out->keys * PATRIREF_NODE_SIZE;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Iteration                                                                   ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an iterator
+/// @param iter iterator to operate on
+/// @param t    reference set owning the nodes
+/// @param root root of the subtree to iterate or @c NULL for full set
+/// @param dir  @c true for left-to-right, false for right-to-left
+/// @param mode enumeration mode for the nodes
+void
+prefiter_init(
+    PTRefIterT       *iter,
+    PatriciaRefT     *t   ,
+    PTSetNodeT const *root,
+    bool              dir ,
+    EPTIterMode       mode)
+{
+    psetiter_init_ex(&iter->_m_inner, &t->_m_set, root, dir, mode, _ikey, t);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief logical forward step of the iterator
+/// @param iter iterator to step
+/// @return     next node or NULL if end is reached
+const PTSetNodeT*
+prefiter_next(
+    PTRefIterT *iter)
+{
+    return psetiter_next(&iter->_m_inner);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief logical backward step of the iterator
+/// @param iter iterator to step
+/// @return     next node or NULL if end is reached
+const PTSetNodeT*
+prefiter_prev(
+    PTRefIterT *iter)
+{
+    return psetiter_prev(&iter->_m_inner);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief reset iterator to initial position
+/// @param iter iterator to reset
+void
+prefiter_reset(
+    PTRefIterT *iter)
+{
+    psetiter_reset(&iter->_m_inner);
+}
+
+// -*- that's all folks -*-
@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with external key references (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - same tree structure and memory policy as the plain set
+//  - keys stay in caller-owned storage; a node holds a reference and the bit length
+//  - all nodes have the same size, @c PATRIREF_NODE_SIZE
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_REF_363791CF_01FA_42B9_A6D4_61624AE6391F
+#define CPATRICIA_REF_363791CF_01FA_42B9_A6D4_61624AE6391F
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpatricia_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief resolve a key reference to the key bits
+/// A reference is whatever the caller uses to find a key: a pointer cast to
+/// @c uintptr_t, an offset into a string table, an index...  The resolver is called
+/// for every key compare, so it should be cheap.
+/// @param ctx      resolver context given at set initialisation
+/// @param ref      key reference as given to @c patriref_insert()
+/// @return         pointer to the key bits
+typedef const void *(*PTKeyResolveT)(void *ctx, uintptr_t ref);
+
+/// @brief size of every node block requested from the memory policy
+#define PATRIREF_NODE_SIZE (offsetof(PTSetNodeT, data) + sizeof(uintptr_t))
+
+/// @brief PATRICIA set with keys in external storage
+/// The set does not copy keys; it keeps references that a resolver callback turns
+/// into key pointers on demand.  The caller guarantees that the referenced keys stay
+/// valid and unchanged while they are in the set.  The nodes are plain @c PTSetNodeT
+/// structures, but their @c data holds the reference, not the key; do not use the
+/// @c patriset_*() key functions or the @c psetiter_*() iterators on the wrapped set.
+/// Iterate with @c prefiter_*() and take statistics with @c patriref_stats().
+typedef struct {
+    PatriciaSetT        _m_set;      ///< @brief the basic set we're extending
+    PTKeyResolveT       _m_resolve;  ///< @brief reference resolver
+    void               *_m_rctx;     ///< @brief context for the resolver
+} PatriciaRefT;
+
+extern void              patriref_init_ex(PatriciaRefT *t, PTKeyResolveT fn, void *ctx, const PTMemFuncT *fp, void *arena);
+extern void              patriref_init(PatriciaRefT *t, PTKeyResolveT fn, void *ctx);
+extern void              patriref_fini(PatriciaRefT *t);
+
+extern const PTSetNodeT *patriref_lookup(const PatriciaRefT *t, const void *key, uint16_t bitlen);
+extern const PTSetNodeT *patriref_insert(PatriciaRefT *t, uintptr_t ref, uint16_t bitlen, bool *inserted);
+extern bool              patriref_remove(PatriciaRefT *t, const void *key, uint16_t bitlen);
+extern uintptr_t         patriref_ref(const PTSetNodeT *node);
+extern void              patriref_rebind(PTSetNodeT *node, uintptr_t ref);
+extern const void       *patriref_key(const PatriciaRefT *t, const PTSetNodeT *node);
+extern bool              patriref_stats(const PatriciaRefT *t, PTSetStatsT *out);
+
+/// @brief reference set iterator
+/// The set iterator with a key getter that resolves node references, so the parent
+/// recovery walks follow the real key bits.  Modes and directions are those of the set
+/// iterator.
+typedef struct {
+    PTSetIterT _m_inner; ///< @brief the inner iterator we're using
+} PTRefIterT;
+
+extern void              prefiter_init(PTRefIterT *i, PatriciaRefT *t, const PTSetNodeT *root, bool dir, EPTIterMode mode);
+extern const PTSetNodeT *prefiter_next(PTRefIterT *i);
+extern const PTSetNodeT *prefiter_prev(PTRefIterT *i);
+extern void              prefiter_reset(PTRefIterT *i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_REF_363791CF_01FA_42B9_A6D4_61624AE6391F */
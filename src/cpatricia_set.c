@@ -46,6 +46,9 @@
 // -------------------------------------------------------------------------------------
 
 #include "cpatricia_set.h"
+#include "cpatricia_probes.h"
+#include "cpatricia_bits.h"
+#include "cpatricia_node.h"
 
 #include <string.h>
 #include <stddef.h>
@@ -61,46 +64,57 @@
 # define LIKELY(x)      x
 #endif
 
-// -------------------------------------------------------------------------------------
-// ==== tree topology relation helpers                                              ====
-// -------------------------------------------------------------------------------------
-
-static inline bool _isParentOf(const PTSetNodeT *const p, const PTSetNodeT *const x) {
-    return (p->_m_child[0] == x) | (p->_m_child[1] == x); // bitwise OR is intention
-}
+// Operation counters are opt-in.  They are bookkeeping, not tree state, so they are
+// bumped through 'const' tree pointers, too.  The increments are plain stores: with
+// counters compiled in, even lookups write to the tree and concurrent readers race.
+#ifdef PATRICIA_OP_COUNTERS
+# define OPCOUNT(_t_, _f_)  (++((PatriciaSetT *)(_t_))->_m_ops._f_)
+#else
+# define OPCOUNT(_t_, _f_)  ((void)0)
+#endif
 
-static inline unsigned _otherIdx(const PTSetNodeT *const p, const PTSetNodeT *const x) {
-    return p->_m_child[0] == x;
-}
+// Number of nodes handed to the batch hooks of the memory policy in one call
+#ifndef PATRICIA_BATCH
+# define PATRICIA_BATCH 32
+#endif
 
-static inline unsigned _childIdx(const PTSetNodeT *const p, const PTSetNodeT *const x) {
-    return p->_m_child[1] == x;
-}
+// A batch hook of the tree, or NULL if there is none or the caller's PTMemBatchT is too
+// short to hold it
+#define MBATCH(_t_, _f_) \
+    (((NULL != (_t_)->_m_mbatch) && ((_t_)->_m_mbatch->size >= \
+        offsetof(PTMemBatchT, _f_) + sizeof((_t_)->_m_mbatch->_f_))) ? (_t_)->_m_mbatch->_f_ : NULL)
 
 // -------------------------------------------------------------------------------------
 // ==== memory allocation & helpers                                                 ====
 // -------------------------------------------------------------------------------------
 
 // -------------------------------------------------------------------------------------
-// default node allocator using 'malloc()'
-static void*
-alloc_wrap(
-    void  *unused,
-    size_t bytes )
+// Size of the memory block for a node with 'bitlen' key bits.  We count raw key bits --
+// the trailing NUL in an ASCIIZ string is *not* considered to be part of the key! But
+// for the sake of string processing, we add one NUL byte to the end of the key, without
+// accounting for it in the size.  Makes printing much safer, at moderate costs.
+static size_t
+ptnode_size(
+    uint16_t bitlen)
 {
-    (void)unused;
-    return malloc(bytes);
+    return offsetof(PTSetNodeT, data) + ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT + 1;
 }
 
 // -------------------------------------------------------------------------------------
-// default node deallocator using 'free()'
-static void
-free_wrap(
-    void *unused,
-    void *obj   )
+// Set up a freshly allocated node block with a copy of the key
+static PTSetNodeT*
+ptnode_setup(
+    PTSetNodeT *nodeptr,
+    const void *keystr ,
+    uint16_t    bitlen )
 {
-    (void)unused;
-    free(obj);
+    unsigned bytelen = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+
+    memset(nodeptr, 0, offsetof(PTSetNodeT, data));
+    nodeptr->nbit = bitlen;
+    memcpy(nodeptr->data, keystr, bytelen);
+    nodeptr->data[bytelen] = '\0';  // ASCIIZ sentinel
+    return nodeptr;
 }
 
 // -------------------------------------------------------------------------------------
@@ -111,19 +125,11 @@ ptnode_create(
     const void         *keystr,
     uint16_t            bitlen)
 {
-    // We count raw key bits -- the trailing NUL in an ASCIIZ string is *not* considered
-    // to be part of the key! But for the sake of string processing, we add one NUL byte
-    // to the end of the key, without accounting for it in the size.
-    // Makes printing much safer, at moderate costs.
-
-    unsigned    bytelen = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
-    size_t      nodelen = offsetof(PTSetNodeT, data) + bytelen + 1; // reserve one extra NUL byte
-    PTSetNodeT *nodeptr = tree->_m_mfunc->fp_alloc(tree->_m_arena, nodelen);
+    PTSetNodeT *nodeptr = tree->_m_mfunc->fp_alloc(tree->_m_arena, ptnode_size(bitlen));
     if (LIKELY(NULL != nodeptr)) {
-        memset(nodeptr, 0, offsetof(PTSetNodeT, data));
-        nodeptr->nbit = bitlen;
-        memcpy(nodeptr->data, keystr, bytelen);
-        nodeptr->data[bytelen] = '\0';  // ASCIIZ sentinel
+        ptnode_setup(nodeptr, keystr, bitlen);
+    } else {
+        OPCOUNT(tree, allocfail);
     }
     return nodeptr;
 }
@@ -140,11 +146,8 @@ ptnode_free(
     PTSetNodeT         *node)
 {
     if (NULL != node) {
-        memset(node, 0xFE, offsetof(PTSetNodeT, data));
         node->data[0] = '\0';
-        if (NULL != tree->_m_mfunc->fp_free) {
-            tree->_m_mfunc->fp_free(tree->_m_arena, node);
-        }
+        ptnode_release(tree->_m_mfunc, tree->_m_arena, node, offsetof(PTSetNodeT, data));
     }
 }
 
@@ -255,34 +258,6 @@ bswapz(
     return patricia_bswap(v);
 }
 
-// -------------------------------------------------------------------------------------
-// Count leading zeros in a 'size_t' value. Resorts to builtins where practicable, uses
-// a portable implementation as fallback.
-#define EXCESS(_t_) ((sizeof(_t_) - sizeof(size_t)) * CHAR_BIT)
-
-static unsigned
-clzz(
-    size_t v)
-{
-    // Many implementations of CLZ have undefined behaviour if called with zero. We nail
-    // it down ourselves!
-    if (0 == v) {
-        return sizeof(size_t) * CHAR_BIT;
-    }
-
-    // GCC and Clang have builtins. Other compilers might, too...  
-# if (defined(__GNUC__) || defined(__clang__))
-    if (sizeof(int) >= sizeof(size_t))
-        return __builtin_clz((unsigned int)v) - EXCESS(int);
-    if (sizeof(long int) >= sizeof(size_t))
-        return __builtin_clzl((unsigned long int)v) - EXCESS(long int);
-    if (sizeof(long long int) >= sizeof(size_t))
-        return __builtin_clzll((unsigned long long int)v) - EXCESS(long long int);
-# endif
-
-    return patricia_clz(v);
-}
-
 // -------------------------------------------------------------------------------------
 // Create an infinite bit stream from a finite buffer. After the last bit the engine
 // repeats the complement of the last bit ad infinitum.  The result is always a properly
@@ -291,6 +266,7 @@ typedef struct bitstream_ {
     const unsigned char   *ptr;     // current read position
     unsigned               bits;    // remaining bits
     bool                   last;    // last bit from key value
+    unsigned               shift;   // bit offset into first byte, 'nextbits_o()' only
 } BitStreamT;
 
 static size_t
@@ -332,6 +308,55 @@ nextbits(
     return accu.szv;
 }
 
+// -------------------------------------------------------------------------------------
+// Same as 'nextbits()' for a stream that starts 'shift' bits into its first byte.  Each
+// limb is funnel-shifted together from the bytes covering it; no more bytes are read
+// than the remaining key bits touch.
+static size_t
+nextbits_o(
+    BitStreamT *bs)
+{
+    static const unsigned limb_bits = sizeof(size_t) * CHAR_BIT;
+
+    union {
+        size_t        szv;
+        unsigned char acv[sizeof(size_t)];
+    } accu;
+    unsigned char tmp[sizeof(size_t) + 1];
+    unsigned      take, bytes, ebits, idx;
+
+    if (bs->bits == 0) {
+        // bit stream exhausted -- return value with bits complement of the last bit
+        accu.szv = (size_t)bs->last - 1u;
+        return accu.szv;
+    }
+    take  = (bs->bits >= limb_bits) ? limb_bits : bs->bits;
+    bytes = (bs->shift + take + CHAR_BIT - 1) / CHAR_BIT;
+    memcpy(tmp, bs->ptr, bytes);
+    memset(tmp + bytes, 0, sizeof(tmp) - bytes);
+    for (idx = 0; idx < sizeof(size_t); ++idx) {
+        accu.acv[idx] = (unsigned char)((tmp[idx] << bs->shift)
+                                      | (tmp[idx + 1] >> (CHAR_BIT - bs->shift)));
+    }
+    bs->ptr  += take / CHAR_BIT;
+    bs->bits -= take;
+
+    if (take < limb_bits) {
+        // partial limb: fill with the extension, exactly like 'nextbits()'
+        bytes = (take + CHAR_BIT - 1) / CHAR_BIT;
+        ebits = take % CHAR_BIT;
+        memset((accu.acv + bytes), ((unsigned)bs->last - 1u), (sizeof(size_t) - bytes));
+        if (ebits) {
+            if (bs->last) {
+                accu.acv[bytes - 1] &= ~((unsigned)UCHAR_MAX >> ebits); // 0-flush
+            } else {
+                accu.acv[bytes - 1] |= ((unsigned)UCHAR_MAX >> ebits); // 1-flush
+            }
+        }
+    }
+    return accu.szv;
+}
+
 // -------------------------------------------------------------------------------------
 /// @brief get a bit from a bit string, unity indexed
 /// Get the n-th bit of the key string, where bit 1 is the first bit. Bits below index 1
@@ -490,6 +515,80 @@ patricia_equkey(
     return true; // exact match
 }
 
+// -------------------------------------------------------------------------------------
+/// @brief get a bit from a bit string starting at a bit offset, unity indexed
+/// Same as @c patricia_getbit() for the key that starts @c bitoff bits after @c base.
+/// @param base     memory the bit string is embedded in
+/// @param bitoff   bit offset of the key's first bit from the MSB of @c base[0]
+/// @param bitlen   length of bit string
+/// @param bitidx   unity-based index of bit to extract
+/// @return         bit value or extension
+///
+/// @note public only for unit test purposes
+bool
+patricia_getbit_o(
+    const void *base  ,
+    size_t      bitoff,
+    uint16_t    bitlen,
+    uint16_t    bitidx)
+{
+    const unsigned char * const bytes = base;
+    unsigned exmask = -(bitidx > bitlen);
+    size_t   zidx;
+
+    if (UNLIKELY((bitlen == 0) | (bitidx == 0))) { // bitwise OR intentional!
+        return (exmask & 1u);
+    }
+    zidx = bitoff + ((bitidx & ~exmask) | (bitlen & exmask)) - 1u;
+    return ((bytes[zidx / CHAR_BIT] >> ((CHAR_BIT - 1) - zidx % CHAR_BIT)) ^ exmask) & 1u;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief first difference between a bit string at a bit offset and a plain one
+/// Same as @c patricia_bitdiff() with the 1st key starting @c off1 bits after @c p1.
+/// Byte-aligned offsets take the plain path; others load each limb of the 1st key with
+/// a funnel shift.
+/// @param p1   memory the 1st key is embedded in
+/// @param off1 bit offset of the 1st key
+/// @param l1   bit length of 1st key
+/// @param p2   memory base of 2nd key
+/// @param l2   bit length of 2nd key
+/// @return unity-base index of first difference or zero on equality of keys
+///
+/// @note public only for unit test purposes
+uint16_t
+patricia_bitdiff_o(
+    const void *p1, size_t off1, uint16_t l1,
+    const void *p2, uint16_t l2)
+{
+    static const union { uint32_t i; unsigned char c[4]; } endian = { .i = 1 };
+    static const unsigned limb_bits = sizeof(size_t) * CHAR_BIT;
+
+    const unsigned char *b1 = (const unsigned char *)p1 + off1 / CHAR_BIT;
+    uint_least16_t bits = (l2 > l1) ? l2 : l1;
+    uint_least16_t bpos = 1;
+
+    if (0 == off1 % CHAR_BIT) {
+        return patricia_bitdiff(b1, l1, p2, l2);
+    }
+
+    BitStreamT bs1 = {.ptr = b1, .bits = l1, .last = patricia_getbit_o(p1, off1, l1, l1),
+                      .shift = off1 % CHAR_BIT};
+    BitStreamT bs2 = {.ptr = p2, .bits = l2, .last = patricia_getbit(p2, l2, l2)};
+
+    for (unsigned words = (bits + limb_bits - 1) / limb_bits; words; --words) {
+        size_t accu = (nextbits_o(&bs1) ^ nextbits(&bs2));
+        if (0 != accu) {
+            if (endian.c[0] == 1) {
+                accu = bswapz(accu);
+            }
+            return (uint16_t)(bpos + clzz(accu));
+        }
+        bpos += limb_bits;
+    }
+    return (l1 == l2) ? 0 : bits + 1;
+}
+
 // -------------------------------------------------------------------------------------
 // ==== Core operations                                                             ====
 // -------------------------------------------------------------------------------------
@@ -511,6 +610,23 @@ patriset_init_ex(
     tree->_m_root->_m_child[0] = tree->_m_root->_m_child[1] = tree->_m_root;
 }
 
+// -------------------------------------------------------------------------------------
+/// @brief set up a PATRICIA tree with the given memory management scheme and batch hooks
+/// @param tree     tree to initialise
+/// @param fp       function pointer block with memory policy functions
+/// @param batch    optional batch hooks of the memory policy, or @c NULL
+/// @param arena    additional data for policy functions
+void
+patriset_init_ex2(
+    PatriciaSetT      *tree ,
+    const PTMemFuncT  *fp   ,
+    const PTMemBatchT *batch,
+    void              *arena)
+{
+    patriset_init_ex(tree, fp, arena);
+    tree->_m_mbatch = batch;
+}
+
 // -------------------------------------------------------------------------------------
 /// @brief set up a PATRICIA tree with default memory functions
 /// @param tree     tree to initialise
@@ -538,59 +654,30 @@ void
 patriset_fini(
     PatriciaSetT *tree)
 {
-    // Cut tree from root node AASAP
-    PTSetNodeT *scan, *list = NULL;
-    PTSetNodeT *hold = tree->_m_root->_m_child[0];
+    PTSetNodeT *hold, *list;
 
-    tree->_m_root->_m_child[0] = tree->_m_root->_m_child[1] = tree->_m_root;
+    // Cut tree from root node AASAP and flatten it to a list of dead nodes
+    PT_FUNNEL(PTSetNodeT, tree->_m_root, list);
 
-    // -- force the rightmost leaf to ROOT ---------------------------------------------
-    // This is needed ONCE to ensure we have an unambigeous termination condition for
-    // the funnel; the bit-position relation will be detroyed on the right subtrees, so
-    // we have to set a simple sentinel. The root node is convenient.
-    scan = hold;
-    while (scan->_m_child[1]->bpos > scan->bpos) {
-        scan = scan->_m_child[1];
-    }
-    scan->_m_child[1] = tree->_m_root;
-
-    // -- flatten the tree to a list ---------------------------------------------------
-    // Squeezing the tree through a funnel to create a single-linked list of nodes is
-    // the only iterative O(N) solution for cleaning up a Sedgewick-style PATRICIA tree.
-    // The funnel trick works best for trees with NULL-leaf pointers, but using it here
-    // is just more constrained: We MUST NOT delete nodes that went to the funnel
-    // immediately, or we would end with dangling uplink pointers. Instead we collect
-    // the funnelled nodes on a list after setting their branch position to zero.
-
-    while (tree->_m_root != hold) {               // check for sentinel set above
-        PTSetNodeT *next = hold->_m_child[0];  // never NULL, subtree intact
-        PTSetNodeT *tail = hold->_m_child[1];  // never NULL, but degraded by funnel
-        if (next->bpos <= hold->bpos) {
-            // left _m_child is an uplink -- continue through the right _m_child next
-            next = tail;
-        } else {
-            // There IS a left _m_child (or even subtree). We graft our tail to the the
-            // rightmost link on the right spine of the left subtree, efecctively
-            // funnelling the nodes into a sequence.  Every node is visited at most
-            // twice, so the whole decomposition is in O(N), even if it might not look
-            // like it at first glance.
-            scan = next;
-            while (scan->_m_child[1]->bpos > scan->bpos) {
-                scan = scan->_m_child[1];
+    // -- finally freeing the nodes from the list --------------------------------------
+    // With a batch deleter, the nodes are handed back in chunks, saving an indirect call
+    // (and maybe an allocator lock round trip) per node.
+    if (NULL != MBATCH(tree, fp_free_batch)) {
+        void  *batch[PATRICIA_BATCH];
+        size_t nb = 0;
+        while (NULL != (hold = list)) {
+            list = hold->_m_child[0];                   // pop head from list
+            memset(hold, 0, offsetof(PTSetNodeT, data));// purge node; paranoia rulez!
+            batch[nb++] = hold;
+            if (PATRICIA_BATCH == nb) {
+                tree->_m_mbatch->fp_free_batch(tree->_m_arena, batch, nb);
+                nb = 0;
             }
-            scan->_m_child[1] = tail;
         }
-        // Now push node to list of dead nodes, ensuring it will be considered as an
-        // uplink node when inspected again during later flattening steps.
-        hold->bpos = 0;         // make sure remaining references are seen as uplink
-        hold->_m_child[0] = list;  // push to head of the dead-node list
-        list = hold;
-
-        // update point-of-interest for next round
-        hold = next;
+        if (0 != nb) {
+            tree->_m_mbatch->fp_free_batch(tree->_m_arena, batch, nb);
+        }
     }
-
-    // -- finally freeing the nodes from the list --------------------------------------
     while (NULL != (hold = list)) {
         list = hold->_m_child[0];                       // pop head from list
         memset(hold, 0, offsetof(PTSetNodeT, data));    // purge node; paranoia rulez!
@@ -617,12 +704,21 @@ patriset_lookup(
     // access.
 
     const PTSetNodeT *node = tree->_m_root->_m_child[0];
-    unsigned npos, opos = tree->_m_root->bpos;
+    unsigned npos, opos = tree->_m_root->bpos, depth = 0;
+    OPCOUNT(tree, descents);
     while ((npos = node->bpos) > opos) {
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
+        ++depth;
         opos = npos;
         node = node->_m_child[patricia_getbit(key, bitlen, node->bpos)];
     }
-    return patricia_equkey(key, bitlen, node->data, node->nbit) ? node : NULL;
+    OPCOUNT(tree, equkey);
+    if (patricia_equkey(key, bitlen, node->data, node->nbit)) {
+        return node;
+    }
+    PT_PROBE2(set_lookup_miss, bitlen, depth);
+    return NULL;
 }
 
 // -------------------------------------------------------------------------------------
@@ -643,16 +739,59 @@ patriset_prefix(
 
     const PTSetNodeT *best = NULL, *node = tree->_m_root->_m_child[0];
     unsigned npos, opos = tree->_m_root->bpos;
+    OPCOUNT(tree, descents);
     while ((npos = node->bpos) > opos) {
-        if ((node->nbit <= bitlen) && patricia_equkey(key, node->nbit, node->data, node->nbit)) {
-            best = node;
+        OPCOUNT(tree, nodes);
+        if (node->nbit <= bitlen) {
+            OPCOUNT(tree, equkey);
+            if (patricia_equkey(key, node->nbit, node->data, node->nbit)) {
+                best = node;
+            }
         }
+        OPCOUNT(tree, getbit);
         opos = npos;
         node = node->_m_child[patricia_getbit(key, bitlen, node->bpos)];
     }
+    OPCOUNT(tree, equkey);
     return patricia_equkey(key, node->nbit, node->data, node->nbit) ? node : best;
 }
 
+// -------------------------------------------------------------------------------------
+// Link a new node with its key and branch position set up into the tree.  The key must
+// not be in the tree yet, and the branch position must be its first difference to the
+// key found by a lookup.
+static void
+ptnode_link(
+    PatriciaSetT *tree,
+    PTSetNodeT   *node)
+{
+    PTSetNodeT *last, *next;
+
+    // Find insert parent -- another walk, but this time depth-limited by the new branch
+    // position we calculated.
+    bool pdir = false;
+    last = tree->_m_root;
+    next = tree->_m_root->_m_child[0];
+    while ((next->bpos > last->bpos) && (next->bpos < node->bpos)) {
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
+        last = next;
+        pdir = patricia_getbit(node->data, node->nbit, last->bpos);
+        next = last->_m_child[pdir];
+    }
+
+    // Link node between last (parent) and next (a child or uplink!) Note that our own key
+    // bit at the branch position defines which of the link point back to the new node
+    // itself; the child link from the parent goes into the other slot.
+    OPCOUNT(tree, getbit);
+    bool ndir = patricia_getbit(node->data, node->nbit, node->bpos);
+    node->_m_child[ ndir] = node;
+    node->_m_child[!ndir] = next;
+
+    // Now we link the new node into the parent node. We remembered where to do that.
+    last->_m_child[pdir] = node;
+}
+
 // -------------------------------------------------------------------------------------
 /// @brief  create node with given key & payload, insert into tree
 /// @param tree     tree to insert into
@@ -671,9 +810,14 @@ patriset_insert(
     // need them both for the insert position!
 
     PTSetNodeT *last, *next;
+    unsigned depth = 0;
     last = tree->_m_root;
     next = tree->_m_root->_m_child[0];
+    OPCOUNT(tree, descents);
     while (next->bpos > last->bpos) {
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
+        ++depth;
         last = next;
         next = last->_m_child[patricia_getbit(key, bitlen, last->bpos)];
     }
@@ -682,14 +826,17 @@ patriset_insert(
     // the node if there's no difference.  If OTOH duplicates are common, it's cheaper
     // on average to test for equality for quick bail-out and do the heavy lifting only
     // if it's really needed.  We take the 2nd option here!
+    OPCOUNT(tree, equkey);
     if (patricia_equkey(key, bitlen, next->data, next->nbit)) {
         if (inserted) {
             *inserted = false;
         }
+        PT_PROBE3(set_insert, bitlen, depth, 0);
         return next; // existing node
     }
 
     // Ok, time to get serious... We NEED the branch position!
+    OPCOUNT(tree, bitdiff);
     unsigned bpos = patricia_bitdiff(key, bitlen, next->data, next->nbit);
     assert(0 != bpos);
 
@@ -704,31 +851,13 @@ patriset_insert(
     }
     node->bpos = bpos;
 
-    // Find insert parent -- another walk, but this time depth-limited by the new branch
-    // position we calculated.
-    bool pdir = false;
-    last = tree->_m_root;
-    next = tree->_m_root->_m_child[0];
-    while ((next->bpos > last->bpos) && (next->bpos < bpos)) {
-        last = next;
-        pdir = patricia_getbit(key, bitlen, last->bpos);
-        next = last->_m_child[pdir];
-    }
-
-    // Link node between last (parent) and next (a child or uplink!) Note that our own key
-    // bit at the branch position defines which of the link point back to the new node
-    // itself; the child link from the parent goes into the other slot.
-    bool ndir = patricia_getbit(key, bitlen, bpos);
-    node->_m_child[ ndir] = node;
-    node->_m_child[!ndir] = next;
-
-    // Now we link the new node into the parent node. We remembered where to do that.
-    last->_m_child[pdir] = node;
+    ptnode_link(tree, node);
 
     // Ok, that was a real success...
     if (inserted) {
         *inserted = true;
     }
+    PT_PROBE3(set_insert, bitlen, depth, 1);
     return node;
 }
 
@@ -754,17 +883,21 @@ typedef struct {
 // registering the downlink parent of node while going down.
 static bool
 _pwalk(
-    NodeLinksT       * const out ,
-    const PTSetNodeT * const root,
-    const PTSetNodeT * const node)
+    NodeLinksT         * const out ,
+    const PatriciaSetT * const tree,
+    const PTSetNodeT   * const node)
 {
+    const PTSetNodeT *root = tree->_m_root;
     const PTSetNodeT *over = root, *last = root, *next = root->_m_child[0];
 
     if ((NULL == node) || (root == node)) {
         return false;
     }
 
+    OPCOUNT(tree, descents);
     while (next->bpos > last->bpos) {
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
         if (node == next) {
             out->npar = (PTSetNodeT*)last;
         }
@@ -876,30 +1009,9 @@ _evict(
     const NodeLinksT * const walk)
 {
     PTSetNodeT *x = walk->node;
-    PTSetNodeT *p = walk->last;
-    PTSetNodeT *g = walk->over;
-    assert(_isParentOf(p, x));
-    assert(_isParentOf(g, p));
-
-    (void)_isParentOf;    // only used in DEBUG build assertions
-
-    // Step I: In all cases, we have to bypass 'p' in the path 'g' -> 'p' -> 'x'.
-    g->_m_child[_childIdx(g, p)] = p->_m_child[_otherIdx(p, x)];
-
-    // Step II: IF 'x' != 'p', replace 'x' with 'p' in the tree. This needs access
-    // the downward link to 'x', which we have registered on our way down to 'p'.
-    if (x != p) {
-        PTSetNodeT *z = walk->npar;
-        assert(_isParentOf(z, x)); // true downlink parent
 
-        // replace the link to 'x' in 'z' with 'p'
-        z->_m_child[_childIdx(z, x)] = p;
-
-        // re-link 'p' with the children of 'x' and copy the branch position
-        p->_m_child[0] = x->_m_child[0];
-        p->_m_child[1] = x->_m_child[1];
-        p->bpos = x->bpos;
-    }
+    // Step I and, if 'x' != 'p', Step II
+    PT_UNLINK(walk->over, walk->last, x, walk->npar);
 
     memset(x, 0, offsetof(PTSetNodeT, data)); // purge node; paranoia rulez!
     ptnode_free(tree, x);
@@ -916,7 +1028,7 @@ patriset_evict(
     PTSetNodeT   *node)
 {
     NodeLinksT nodes;
-    if (_pwalk(&nodes, tree->_m_root, node)) {
+    if (_pwalk(&nodes, tree, node)) {
         _evict(tree, &nodes);
         return true;
     }
@@ -937,66 +1049,1735 @@ patriset_remove(
     uint16_t    bitlen)
 {
     NodeLinksT nodes;
-    if (_pwalk(&nodes, tree->_m_root, patriset_lookup(tree, key, bitlen))) {
+    if (_pwalk(&nodes, tree, patriset_lookup(tree, key, bitlen))) {
         _evict(tree, &nodes);
+        PT_PROBE2(set_remove, bitlen, 1);
         return true;
     }
+    PT_PROBE2(set_remove, bitlen, 0);
     return false;
 }
 
 // -------------------------------------------------------------------------------------
-// ==== showing tree as crude indented text (strring keys assumed)                  ====
+// ==== Generic key access                                                          ====
 // -------------------------------------------------------------------------------------
-static void
-fprint_tree(
-    FILE *ofp, const PTSetNodeT * const node, unsigned level, unsigned flags)
+
+// The key variants below (segmented keys, keys at a bit offset) differ from plain keys
+// only in how the key bits are read.  They share one implementation of lookup, prefix
+// match, insert and removal, parameterised with a set of key accessors.  The key handle
+// is a cursor of the variant; it is not 'const', as reading may move it.
+
+typedef struct {
+    // unity-indexed key bit with extension, like 'patricia_getbit()'
+    bool     (*getbit )(void *key, uint16_t bitlen, unsigned bitidx);
+    // first difference of the first 'bitlen' key bits to the key of 'node', like
+    // 'patricia_bitdiff()'; 'bitlen' is the key length or, for a prefix test, the
+    // length of the node key
+    unsigned (*bitdiff)(void *key, uint16_t bitlen, const PTSetNodeT *node);
+    // byte-aligned copy of the 'bitlen' key bits to 'dst'
+    void     (*gather )(void *key, uint16_t bitlen, char *dst);
+} KeyAccessT;
+
+// descend to the uplink target for a key, counting the nodes passed
+static const PTSetNodeT *
+_kdescend(
+    const PatriciaSetT *tree  ,
+    const KeyAccessT   *ka    ,
+    void               *key   ,
+    uint16_t            bitlen,
+    unsigned           *depth )
 {
-    if (0 == flags) {
-        for (unsigned i = 0; i < level; ++i)
-            fputs("    ", ofp);
-        fprintf(ofp, "+--(%p)--> '%s(%u)'\n", (void*)node, node->data, node->bpos);
-    } else {
-        if (flags & 2)
-            fprint_tree(ofp, node->_m_child[1], (level + 1), (node->_m_child[1]->bpos > node->bpos ? 3 : 0));
-        for (unsigned i = 0; i < level; ++i)
-            fputs("    ", ofp);
-        fprintf(ofp, "[%2u, %p] \n", node->bpos, (void *)node);
-        if (flags & 1)
-            fprint_tree(ofp, node->_m_child[0], (level + 1), (node->_m_child[0]->bpos > node->bpos ? 3 : 0));
+    const PTSetNodeT *node = tree->_m_root->_m_child[0];
+    unsigned npos, opos = tree->_m_root->bpos, d = 0;
+
+    OPCOUNT(tree, descents);
+    while ((npos = node->bpos) > opos) {
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
+        ++d;
+        opos = npos;
+        node = node->_m_child[ka->getbit(key, bitlen, npos)];
     }
+    *depth = d;
+    return node;
 }
 
-// -------------------------------------------------------------------------------------
-/// @brief dump a tree as crude indented text
-/// @param ofp  where to write to
-/// @param tree what to dump
-/// @note assumes key data is NUL-terminated ASCII text -- be prepared for fun if it's not!
-void
-patriset_print(
-    FILE               *ofp ,
-    PatriciaSetT const *tree)
+// exact match, see 'patriset_lookup()'
+static const PTSetNodeT *
+_klookup(
+    const PatriciaSetT *tree  ,
+    const KeyAccessT   *ka    ,
+    void               *key   ,
+    uint16_t            bitlen)
 {
-    fprint_tree(ofp, tree->_m_root->_m_child[0], 0, 3);
+    unsigned          depth;
+    const PTSetNodeT *node = _kdescend(tree, ka, key, bitlen, &depth);
+
+    OPCOUNT(tree, equkey);
+    if ((node->nbit == bitlen) && (0 == ka->bitdiff(key, bitlen, node))) {
+        return node;
+    }
+    PT_PROBE2(set_lookup_miss, bitlen, depth);
+    return NULL;
 }
 
-// -------------------------------------------------------------------------------------
-// ==== Iteration can be fun, actually ;)                                           ====
-// -------------------------------------------------------------------------------------
-// The description below was for regular depth-first, left-to-right traversal.  Doing a
-// right-to-left traversal is simple enough, just mirroring the procedure by flipping
-// the mapping fro 1st/2nd child to the actual child slot index!
-// This can be expressed by logical bit-flipping transformations, and the step function
-// makes heavy use of these properties: One function that handles both directions as
-// well as all three types of enumeration with minimal fuzz, forward and backward.
-// But it may need careful reading to see that it really covers it all.
-// -------------------------------------------------------------------------------------
+// longest prefix match, see 'patriset_prefix()'
+static const PTSetNodeT *
+_kprefix(
+    const PatriciaSetT *tree  ,
+    const KeyAccessT   *ka    ,
+    void               *key   ,
+    uint16_t            bitlen)
+{
+    const PTSetNodeT *best = NULL, *node = tree->_m_root->_m_child[0];
+    unsigned npos, opos = tree->_m_root->bpos;
+
+    OPCOUNT(tree, descents);
+    while ((npos = node->bpos) > opos) {
+        OPCOUNT(tree, nodes);
+        if (node->nbit <= bitlen) {
+            OPCOUNT(tree, equkey);
+            if (0 == ka->bitdiff(key, node->nbit, node)) {
+                best = node;
+            }
+        }
+        OPCOUNT(tree, getbit);
+        opos = npos;
+        node = node->_m_child[ka->getbit(key, bitlen, npos)];
+    }
+    OPCOUNT(tree, equkey);
+    if ((node->nbit <= bitlen) && (0 == ka->bitdiff(key, node->nbit, node))) {
+        return node;
+    }
+    return best;
+}
+
+// insert with a contiguous copy of the key, see 'patriset_insert()'
+static const PTSetNodeT *
+_kinsert(
+    PatriciaSetT     *tree    ,
+    const KeyAccessT *ka      ,
+    void             *key     ,
+    uint16_t          bitlen  ,
+    bool             *inserted)
+{
+    PTSetNodeT *next, *node;
+    unsigned    depth, bpos, nbytes;
+
+    if (inserted) {
+        *inserted = false;
+    }
+    next = (PTSetNodeT *)_kdescend(tree, ka, key, bitlen, &depth);
+    OPCOUNT(tree, bitdiff);
+    if (0 == (bpos = ka->bitdiff(key, bitlen, next))) {
+        PT_PROBE3(set_insert, bitlen, depth, 0);
+        return next; // existing node
+    }
+
+    // gather the key into the new node, then link it like any other
+    nbytes = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+    node = tree->_m_mfunc->fp_alloc(tree->_m_arena, ptnode_size(bitlen));
+    if (NULL == node) {
+        OPCOUNT(tree, allocfail);
+        return NULL;
+    }
+    memset(node, 0, offsetof(PTSetNodeT, data));
+    node->nbit = bitlen;
+    node->bpos = (uint16_t)bpos;
+    ka->gather(key, bitlen, node->data);
+    node->data[nbytes] = '\0';  // ASCIIZ sentinel
+    ptnode_link(tree, node);
+
+    if (inserted) {
+        *inserted = true;
+    }
+    PT_PROBE3(set_insert, bitlen, depth, 1);
+    return node;
+}
+
+// removal by key, see 'patriset_remove()'
+static bool
+_kremove(
+    PatriciaSetT     *tree  ,
+    const KeyAccessT *ka    ,
+    void             *key   ,
+    uint16_t          bitlen)
+{
+    NodeLinksT nodes;
+    if (_pwalk(&nodes, tree, _klookup(tree, ka, key, bitlen))) {
+        _evict(tree, &nodes);
+        PT_PROBE2(set_remove, bitlen, 1);
+        return true;
+    }
+    PT_PROBE2(set_remove, bitlen, 0);
+    return false;
+}
 
 // -------------------------------------------------------------------------------------
-// Continuation save points for resumable iteration
+// ==== Scatter/gather keys                                                         ====
 // -------------------------------------------------------------------------------------
-// To allow the traversal to pause and resume, the iterator exposes a compact
-// "continuation state" containing:
-//
+
+// A key given as segments is read through a cursor.  Tree descents ask for ascending
+// bit positions, so the cursor only moves forward there; it restarts from the first
+// segment when asked for a bit before its current segment.  Full-byte runs inside a
+// segment that start on a byte boundary of the key are compared with 'memcmp()'.
+
+typedef struct {
+    const PTKeySegT *beg;   // first segment
+    const PTKeySegT *end;   // end of segment array
+    const PTKeySegT *seg;   // current segment
+    unsigned         base;  // key bits in all segments before 'seg'
+    unsigned         total; // key length in bits
+    bool             last;  // last key bit, false for the empty key
+} SegKeyT;
+
+// set up a cursor; the total length is not checked here
+static void
+_vinit(
+    SegKeyT         *k   ,
+    const PTKeySegT *seg ,
+    size_t           nseg)
+{
+    const PTKeySegT *lseg = NULL;
+
+    k->beg = k->seg = seg;
+    k->end = seg + nseg;
+    k->base = k->total = 0;
+    for (; seg != k->end; ++seg) {
+        k->total += seg->bitlen;
+        if (0 != seg->bitlen) {
+            lseg = seg;
+        }
+    }
+    k->last = (NULL != lseg) && patricia_getbit(lseg->ptr, lseg->bitlen, lseg->bitlen);
+}
+
+// move the cursor to the segment holding the zero-based key bit 'bit0' < total
+static inline void
+_vseek(
+    SegKeyT  *k   ,
+    unsigned  bit0)
+{
+    if (bit0 < k->base) {
+        k->seg  = k->beg;
+        k->base = 0;
+    }
+    while (bit0 >= k->base + k->seg->bitlen) {
+        k->base += k->seg->bitlen;
+        ++k->seg;
+    }
+}
+
+// unity-indexed key bit with extension, like 'patricia_getbit()'
+static inline bool
+_vgetbit(
+    SegKeyT  *k     ,
+    unsigned  bitidx)
+{
+    if (UNLIKELY((bitidx == 0) | (bitidx > k->total))) { // bitwise OR intentional!
+        return (bitidx != 0) && !k->last;
+    }
+    _vseek(k, --bitidx);
+    bitidx -= k->base; // inside the segment, no clamping needed
+    return (((const unsigned char *)k->seg->ptr)[bitidx / CHAR_BIT]
+            >> (CHAR_BIT - 1 - bitidx % CHAR_BIT)) & 1u;
+}
+
+// extended byte 'i' of a segmented key
+static unsigned
+_vbyte(
+    SegKeyT  *k,
+    unsigned  i)
+{
+    unsigned b0 = i * CHAR_BIT, off, r = 0, j;
+
+    if (b0 < k->total) {
+        _vseek(k, b0);
+        off = b0 - k->base;
+        if ((0 == off % CHAR_BIT) && (off + CHAR_BIT <= k->seg->bitlen)) {
+            return ((const unsigned char *)k->seg->ptr)[off / CHAR_BIT];
+        }
+    }
+    for (j = 1; j <= CHAR_BIT; ++j) {
+        r = (r << 1) | _vgetbit(k, b0 + j);
+    }
+    return r;
+}
+
+// first difference between a segmented key and a plain key within the first 'nbits'
+// bits of both (logically extended) keys, or zero
+static unsigned
+_vdiff(
+    SegKeyT             *k    ,
+    const unsigned char *p2   ,
+    unsigned             l2   ,
+    unsigned             nbits)
+{
+    unsigned i = 0, nb = (nbits + CHAR_BIT - 1) / CHAR_BIT, full = nbits / CHAR_BIT, d;
+
+    if (full > l2 / CHAR_BIT) {
+        full = l2 / CHAR_BIT;
+    }
+    while (i < nb) {
+        unsigned b0 = i * CHAR_BIT;
+        if ((i < full) && (b0 < k->total)) {
+            _vseek(k, b0);
+            if (0 == (b0 - k->base) % CHAR_BIT) {
+                // byte run inside the segment, compared in one go
+                const unsigned char *a = (const unsigned char *)k->seg->ptr
+                                       + (b0 - k->base) / CHAR_BIT;
+                unsigned run = (k->seg->bitlen - (b0 - k->base)) / CHAR_BIT;
+                if (run > full - i) {
+                    run = full - i;
+                }
+                if (0 != run) {
+                    if (0 != memcmp(a, p2 + i, run)) {
+                        while (*a == p2[i]) {
+                            ++a, ++i;
+                        }
+                        return _bytediff(i, *a ^ p2[i]);
+                    }
+                    i += run;
+                    continue;
+                }
+            }
+        }
+        d = _vbyte(k, i) ^ _xbyte(p2, l2, i);
+        if ((i + 1 == nb) && (0 != nbits % CHAR_BIT)) {
+            d &= UCHAR_MAX & (UCHAR_MAX << (CHAR_BIT - nbits % CHAR_BIT));
+        }
+        if (0 != d) {
+            return _bytediff(i, d);
+        }
+        ++i;
+    }
+    return 0;
+}
+
+// key accessors for segmented keys; the length is that of the cursor or shorter
+static bool
+_vkbit(
+    void     *key   ,
+    uint16_t  bitlen,
+    unsigned  bitidx)
+{
+    (void)bitlen;
+    return _vgetbit((SegKeyT *)key, bitidx);
+}
+
+static unsigned
+_vkdiff(
+    void             *key   ,
+    uint16_t          bitlen,
+    const PTSetNodeT *node  )
+{
+    unsigned bits = (bitlen > node->nbit) ? bitlen : node->nbit, bpos;
+
+    bpos = _vdiff((SegKeyT *)key, (const unsigned char *)node->data, node->nbit, bits);
+    if (0 != bpos) {
+        return bpos;
+    }
+    return (bitlen == node->nbit) ? 0 : bits + 1;
+}
+
+static void
+_vkgather(
+    void     *key   ,
+    uint16_t  bitlen,
+    char     *dst   )
+{
+    unsigned nbytes = ((unsigned)bitlen + CHAR_BIT - 1) / CHAR_BIT, i;
+
+    for (i = 0; i < nbytes; ++i) {
+        dst[i] = (char)_vbyte((SegKeyT *)key, i);
+    }
+}
+
+static const KeyAccessT _vaccess = { _vkbit, _vkdiff, _vkgather };
+
+// -------------------------------------------------------------------------------------
+/// @brief get a bit from a segmented bit string, unity indexed
+/// Same as @c patricia_getbit() for the concatenation of all segments, but without
+/// materialising it.
+/// @param seg      key segments
+/// @param nseg     number of segments
+/// @param bitidx   unity-based index of bit to extract
+/// @return         bit value or extension
+///
+/// @note public only for unit test purposes
+bool
+patricia_getbit_v(
+    const PTKeySegT *seg   ,
+    size_t           nseg  ,
+    uint16_t         bitidx)
+{
+    SegKeyT k;
+    _vinit(&k, seg, nseg);
+    return _vgetbit(&k, bitidx);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief find first difference between a segmented and a plain bit string
+/// Same as @c patricia_bitdiff() with the concatenation of all segments as 1st key.
+/// @param seg      segments of 1st key
+/// @param nseg     number of segments
+/// @param p2       memory base of 2nd key
+/// @param l2       bit length of 2nd key
+/// @return unity-base index of first difference or zero on equality of keys
+///
+/// @note public only for unit test purposes
+uint16_t
+patricia_bitdiff_v(
+    const PTKeySegT *seg ,
+    size_t           nseg,
+    const void      *p2  ,
+    uint16_t         l2  )
+{
+    SegKeyT  k;
+    unsigned bits, bpos;
+
+    _vinit(&k, seg, nseg);
+    bits = (k.total > l2) ? k.total : l2;
+    if (0 != (bpos = _vdiff(&k, p2, l2, bits))) {
+        return (uint16_t)bpos;
+    }
+    return (k.total == l2) ? 0 : (uint16_t)(bits + 1);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a segmented key
+/// @param tree     tree to search
+/// @param seg      key segments
+/// @param nseg     number of segments
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patriset_lookup_v(
+    const PatriciaSetT *tree,
+    const PTKeySegT    *seg ,
+    size_t              nseg)
+{
+    SegKeyT k;
+
+    _vinit(&k, seg, nseg);
+    if (k.total > UINT16_MAX) {
+        return NULL;
+    }
+    return _klookup(tree, &_vaccess, &k, (uint16_t)k.total);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief longest prefix match for a segmented key
+/// @param tree     tree to search
+/// @param seg      key segments
+/// @param nseg     number of segments
+/// @return         node with non-empty longest prefix key or @c NULL
+const PTSetNodeT *
+patriset_prefix_v(
+    const PatriciaSetT *tree,
+    const PTKeySegT    *seg ,
+    size_t              nseg)
+{
+    SegKeyT k;
+
+    _vinit(&k, seg, nseg);
+    if (k.total > UINT16_MAX) {
+        return NULL;
+    }
+    return _kprefix(tree, &_vaccess, &k, (uint16_t)k.total);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with a segmented key, insert into tree
+/// The node gets a contiguous copy of the key; the segments are read only once more
+/// for that copy.
+/// @param tree     tree to insert into
+/// @param seg      key segments
+/// @param nseg     number of segments
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patriset_insert_v(
+    PatriciaSetT    *tree    ,
+    const PTKeySegT *seg     ,
+    size_t           nseg    ,
+    bool            *inserted)
+{
+    SegKeyT k;
+
+    _vinit(&k, seg, nseg);
+    if (k.total > UINT16_MAX) {
+        if (inserted) {
+            *inserted = false;
+        }
+        return NULL;
+    }
+    return _kinsert(tree, &_vaccess, &k, (uint16_t)k.total, inserted);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a node by segmented key
+/// @param tree     tree owning the node
+/// @param seg      key segments
+/// @param nseg     number of segments
+/// @return     @c true on success, @c false on error (node not in tree)
+bool
+patriset_remove_v(
+    PatriciaSetT    *tree,
+    const PTKeySegT *seg ,
+    size_t           nseg)
+{
+    SegKeyT k;
+
+    _vinit(&k, seg, nseg);
+    if (k.total > UINT16_MAX) {
+        return false;
+    }
+    return _kremove(tree, &_vaccess, &k, (uint16_t)k.total);
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Bit-offset keys                                                             ====
+// -------------------------------------------------------------------------------------
+
+// Keys that start somewhere inside a byte, e.g. header fields in a packet buffer.  The
+// key is given as '(base, bitoff, bitlen)' and read in place: single bits directly, and
+// whole limbs for the first difference with funnel shifts of the bytes covering them.
+// Only a new node gets a byte-aligned copy of its key.
+
+// byte-aligned copy of the 'nbits' bits starting 'shift' bits into 'src'; no source
+// byte beyond the last key bit is read
+static void
+_ocopy(
+    unsigned char       *dst  ,
+    const unsigned char *src  ,
+    unsigned             shift,
+    unsigned             nbits)
+{
+    unsigned nbytes = (nbits + CHAR_BIT - 1) / CHAR_BIT, i;
+
+    for (i = 0; i < nbytes; ++i) {
+        unsigned v = (unsigned)src[i] << shift;
+        if ((0 != shift) && ((i + 1) * CHAR_BIT < shift + nbits)) {
+            v |= src[i + 1] >> (CHAR_BIT - shift);
+        }
+        dst[i] = (unsigned char)v;
+    }
+}
+
+// cursor of a bit-offset key
+typedef struct {
+    const void *base;   // memory the key is embedded in
+    size_t      bitoff; // bit offset of the key's first bit
+} OffKeyT;
+
+// key accessors for bit-offset keys
+static bool
+_okbit(
+    void     *key   ,
+    uint16_t  bitlen,
+    unsigned  bitidx)
+{
+    const OffKeyT *o = key;
+    return patricia_getbit_o(o->base, o->bitoff, bitlen, (uint16_t)bitidx);
+}
+
+static unsigned
+_okdiff(
+    void             *key   ,
+    uint16_t          bitlen,
+    const PTSetNodeT *node  )
+{
+    const OffKeyT *o = key;
+    return patricia_bitdiff_o(o->base, o->bitoff, bitlen, node->data, node->nbit);
+}
+
+static void
+_okgather(
+    void     *key   ,
+    uint16_t  bitlen,
+    char     *dst   )
+{
+    const OffKeyT *o = key;
+    _ocopy((unsigned char *)dst, (const unsigned char *)o->base + o->bitoff / CHAR_BIT,
+           o->bitoff % CHAR_BIT, bitlen);
+}
+
+static const KeyAccessT _oaccess = { _okbit, _okdiff, _okgather };
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key at a bit offset
+/// @param tree     tree to search
+/// @param base     memory the key is embedded in
+/// @param bitoff   bit offset of the key's first bit from the MSB of @c base[0]
+/// @param bitlen   number of key bits
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patriset_lookup_o(
+    const PatriciaSetT *tree  ,
+    const void         *base  ,
+    size_t              bitoff,
+    uint16_t            bitlen)
+{
+    OffKeyT o = { base, bitoff };
+    return _klookup(tree, &_oaccess, &o, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief longest prefix match for a key at a bit offset
+/// @param tree     tree to search
+/// @param base     memory the key is embedded in
+/// @param bitoff   bit offset of the key's first bit from the MSB of @c base[0]
+/// @param bitlen   number of key bits
+/// @return         node with non-empty longest prefix key or @c NULL
+const PTSetNodeT *
+patriset_prefix_o(
+    const PatriciaSetT *tree  ,
+    const void         *base  ,
+    size_t              bitoff,
+    uint16_t            bitlen)
+{
+    OffKeyT o = { base, bitoff };
+    return _kprefix(tree, &_oaccess, &o, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with a key at a bit offset, insert into tree
+/// The node gets a byte-aligned copy of the key.
+/// @param tree     tree to insert into
+/// @param base     memory the key is embedded in
+/// @param bitoff   bit offset of the key's first bit from the MSB of @c base[0]
+/// @param bitlen   number of key bits
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patriset_insert_o(
+    PatriciaSetT *tree    ,
+    const void   *base    ,
+    size_t        bitoff  ,
+    uint16_t      bitlen  ,
+    bool         *inserted)
+{
+    OffKeyT o = { base, bitoff };
+    return _kinsert(tree, &_oaccess, &o, bitlen, inserted);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a node by a key at a bit offset
+/// @param tree     tree owning the node
+/// @param base     memory the key is embedded in
+/// @param bitoff   bit offset of the key's first bit from the MSB of @c base[0]
+/// @param bitlen   number of key bits
+/// @return     @c true on success, @c false on error (node not in tree)
+bool
+patriset_remove_o(
+    PatriciaSetT *tree  ,
+    const void   *base  ,
+    size_t        bitoff,
+    uint16_t      bitlen)
+{
+    OffKeyT o = { base, bitoff };
+    return _kremove(tree, &_oaccess, &o, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+// ==== XOR metric queries                                                          ====
+// -------------------------------------------------------------------------------------
+
+// The leaves of the tree (the uplinks) form a binary trie of the keys.  All keys below a
+// downlink share the bits before its branch position, so at every branch the keys on
+// the side of the target's bit are closer in XOR distance than all keys on the other
+// side.  A depth-first walk that always takes the target's side first therefore yields
+// the keys in order of increasing distance, and stops after 'k' of them.  Taking the
+// other side first yields them in order of decreasing distance.
+//
+// The metric is meant for sets of equal-length keys (node IDs, hashes); with mixed
+// lengths, keys are compared by their extended bits like everywhere else.
+
+#define XWALK_SBUF 64   // walk frames buffered on stack before going to the heap
+
+// one pending link of the XOR walk: target node and branch position it hangs off
+typedef struct {
+    const PTSetNodeT *node;
+    unsigned          from;
+} XWalkFrameT;
+
+// collect up to 'k' keys by XOR distance to the target, nearest first or, with 'flip'
+// set, farthest first
+static size_t
+_xwalk(
+    const PatriciaSetT *tree  ,
+    const void         *key   ,
+    uint16_t            bitlen,
+    bool                flip  ,
+    size_t              k     ,
+    const PTSetNodeT  **out   )
+{
+    const PTSetNodeT *root = tree->_m_root;
+    XWalkFrameT       sbuf[XWALK_SBUF], *stk = sbuf;
+    size_t            top = 0, cap = XWALK_SBUF, count = 0;
+
+    OPCOUNT(tree, descents);
+    stk[top].node   = root->_m_child[0];
+    stk[top++].from = root->bpos;
+    while ((count < k) && (0 != top)) {
+        const PTSetNodeT *node = stk[--top].node;
+        bool              dir;
+
+        if (node->bpos <= stk[top].from) {
+            // uplink: a key, unless it is the root sentinel's empty key
+            if (node != root) {
+                out[count++] = node;
+            }
+            continue;
+        }
+        if (top + 2 > cap) {
+            XWalkFrameT *nstk = malloc(2 * cap * sizeof(*stk));
+            if (NULL == nstk) {
+                count = (size_t)-1;
+                break;
+            }
+            memcpy(nstk, stk, top * sizeof(*stk));
+            if (stk != sbuf) {
+                free(stk);
+            }
+            stk  = nstk;
+            cap *= 2;
+        }
+        OPCOUNT(tree, nodes);
+        OPCOUNT(tree, getbit);
+        dir = patricia_getbit(key, bitlen, node->bpos) ^ flip;
+        stk[top].node   = node->_m_child[!dir];   // far side, later
+        stk[top++].from = node->bpos;
+        stk[top].node   = node->_m_child[dir];    // near side, next
+        stk[top++].from = node->bpos;
+    }
+    if (stk != sbuf) {
+        free(stk);
+    }
+    return count;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief the keys closest to a target key by XOR distance
+/// One depth-first walk, in O(depth + k) steps; no key compares are made.
+/// @param tree     tree to search
+/// @param key      storage of target key bits
+/// @param bitlen   number of target key bits
+/// @param k        maximum number of keys to return
+/// @param out      storage for @c k node pointers, nearest first
+/// @return         number of nodes stored, less than @c k if the set is smaller, or
+///                 @c (size_t)-1 if the walk stack could not be allocated
+size_t
+patriset_xor_nearest(
+    const PatriciaSetT *tree  ,
+    const void         *key   ,
+    uint16_t            bitlen,
+    size_t              k     ,
+    const PTSetNodeT  **out   )
+{
+    return _xwalk(tree, key, bitlen, false, k, out);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief the key with the maximum XOR distance to a target key
+/// @param tree     tree to search
+/// @param key      storage of target key bits
+/// @param bitlen   number of target key bits
+/// @return         node with the farthest key, or @c NULL if the set is empty (or the
+///                 walk stack could not be allocated)
+const PTSetNodeT *
+patriset_xor_max(
+    const PatriciaSetT *tree  ,
+    const void         *key   ,
+    uint16_t            bitlen)
+{
+    const PTSetNodeT *node = NULL;
+    return (1 == _xwalk(tree, key, bitlen, true, 1, &node)) ? node : NULL;
+}
+
+// -------------------------------------------------------------------------------------
+// do a local walk from node 'x' down along its own key bits until the uplink back to
+// 'x' is found. 'z' must be the true downward parent of 'x', which the caller knows
+// from its own traversal context.  This yields the same link set as '_pwalk()', but the
+// walk starts at 'x' instead of the root and is bounded by the height of x's subtree.
+static bool
+_lwalk(
+    NodeLinksT       * const out,
+    const PTSetNodeT * const z  ,
+    const PTSetNodeT * const x  )
+{
+    const PTSetNodeT *over = z, *last = x, *next;
+
+    next = x->_m_child[patricia_getbit(x->data, x->nbit, x->bpos)];
+    while (next->bpos > last->bpos) {
+        over = last;
+        last = next;
+        next = next->_m_child[patricia_getbit(x->data, x->nbit, next->bpos)];
+    }
+
+    out->npar = (PTSetNodeT *)z;
+    out->over = (PTSetNodeT *)over;
+    out->last = (PTSetNodeT *)last;
+    out->node = (PTSetNodeT *)next;
+    return (x == next);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove all nodes matching a predicate in a single traversal
+///
+/// The tree is scanned once in post-order.  When the iterator yields a node, it has
+/// already stepped to the true parent of that node, and the whole subtree below the
+/// node has been processed.  Evicting the node changes only that subtree and a single
+/// child link of the parent, so the iteration can continue undisturbed.  The links for
+/// the eviction are collected by a local walk from the node itself; no walk from the
+/// root is needed.
+///
+/// @param tree tree to purge
+/// @param pred predicate; nodes for which it returns @c true are removed
+/// @param ctx  opaque context passed to the predicate
+/// @return     number of removed nodes
+size_t
+patriset_remove_if(
+    PatriciaSetT *tree,
+    bool        (*pred)(const PTSetNodeT *, void *),
+    void         *ctx )
+{
+    PTSetIterT        iter;
+    PTSetNodeT const *node;
+    NodeLinksT        nodes;
+    size_t            count = 0;
+
+    psetiter_init(&iter, tree, NULL, true, ePTMode_postOrder);
+    while (NULL != (node = psetiter_next(&iter))) {
+        if (pred(node, ctx)) {
+            // the iterator's next position IS the true parent -- or NULL for the top node
+            const PTSetNodeT *npar = (NULL != iter._m_nodep) ? iter._m_nodep : tree->_m_root;
+            if (_lwalk(&nodes, npar, node)) {
+                _evict(tree, &nodes);
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Split & join by path surgery                                                ====
+// -------------------------------------------------------------------------------------
+// Take the search path of a pivot key from the top node down to the bit position 'd'
+// where the pivot leaves the tree.  Every path node has one child on the path and one
+// subtree (or just a leaf) hanging off to the side; the part of the tree where the
+// pivot leaves is the final item.  All keys in an item hanging to the left are smaller
+// than the pivot, all keys in an item hanging to the right are greater or equal.  So
+// splitting at the pivot is nothing more than sorting the items into two piles and
+// building a new path for each pile.  The items themselves are not touched at all.
+//
+// The tricky part are the dual-use nodes on the old path.  Each item has exactly one
+// leaf whose uplink escapes to a node above the item -- a node on the path or the root
+// sentinel.  That node holds a key of the item, and it must end up on a position above
+// the item in the new path.  Which item a path node belongs to is easy to find: it is
+// the item at the position where the node's key differs from the pivot.  The sentinel
+// (logically an all-ones key) belongs to the item at the first zero bit of the pivot.
+//
+// Building a path from a list of items (ordered by position, the last one being the
+// final item) needs one node less than there are items, plus the root.  Going down,
+// every position takes the node of its own item, until we hit the item escaping to the
+// root.  From there, every position takes the node of the next item, which is also in
+// its subtree.  So no key is copied and no node is allocated; only the nodes from the
+// old path are re-linked, plus one uplink that has to be re-homed to a new root.
+//
+// The lower part needs a synthetic item: its all-ones sentinel leaf has to branch off
+// at the first zero bit of the pivot, because the keys below that position do not
+// share the all-ones prefix anymore.
+//
+// All this is O(depth), plus a log factor for matching path nodes to items.  The path
+// is buffered on the stack if it is not too deep, in heap memory otherwise.
+// -------------------------------------------------------------------------------------
+
+// one item on a path, with the branch position where it hangs off the path
+typedef struct {
+    PTSetNodeT *node;   // path node the item was taken from (NULL for the final item)
+    PTSetNodeT *link;   // subtree or leaf hanging off the path at this position
+    PTSetNodeT *key;    // node holding the key that escapes from the item to the path
+    unsigned    bpos;   // branch position of the item; 'd' for the final item
+} PathItemT;
+
+#define PATH_SBUF 64    // path items buffered on stack before going to the heap
+
+// -------------------------------------------------------------------------------------
+// walk down the search path of a key; get number of path nodes and the position where
+// the key leaves the tree (zero if the key is in the tree)
+static unsigned
+_pathlen(
+    const PatriciaSetT *tree  ,
+    const void         *key   ,
+    uint16_t            bitlen,
+    unsigned           *dpos  )
+{
+    const PTSetNodeT *last = tree->_m_root, *next = last->_m_child[0];
+    unsigned          nlen = 0;
+
+    while (next->bpos > last->bpos) {
+        last = next;
+        next = last->_m_child[patricia_getbit(key, bitlen, last->bpos)];
+        ++nlen;
+    }
+    *dpos = patricia_bitdiff(key, bitlen, next->data, next->nbit);
+    return nlen;
+}
+
+// -------------------------------------------------------------------------------------
+// Cut the search path of a key into items, and find the escaping node for each of them.
+// Read-only on the tree; the result goes to 'out', which must have room for the number
+// of path nodes plus one.  Returns the number of items, including the final item.
+static unsigned
+_pathcut(
+    const PatriciaSetT *tree  ,
+    const void         *key   ,
+    uint16_t            bitlen,
+    unsigned            dpos  ,
+    PathItemT          *out   )
+{
+    const PTSetNodeT *last = tree->_m_root, *next = last->_m_child[0];
+    unsigned          nitem = 0;
+
+    while ((next->bpos > last->bpos) && ((0 == dpos) || (next->bpos < dpos))) {
+        bool dir = patricia_getbit(key, bitlen, next->bpos);
+        out[nitem].node = (PTSetNodeT *)next;
+        out[nitem].link = next->_m_child[!dir];
+        out[nitem].key  = NULL;
+        out[nitem].bpos = next->bpos;
+        ++nitem;
+        last = next;
+        next = next->_m_child[dir];
+    }
+    out[nitem].node = NULL;
+    out[nitem].link = (PTSetNodeT *)next;
+    out[nitem].key  = NULL;
+    out[nitem].bpos = dpos;
+    ++nitem;
+
+    // Now assign the escaping nodes. The root sentinel is handled as extra node after
+    // the path nodes.  Items are sorted by position, so a binary search does the trick.
+    for (unsigned idx = 0; idx < nitem; ++idx) {
+        PTSetNodeT *node = (idx + 1 < nitem) ? out[idx].node : (PTSetNodeT *)tree->_m_root;
+        unsigned    diff = patricia_bitdiff(key, bitlen, node->data, node->nbit);
+        unsigned    lo = 0, hi = nitem - 1;
+
+        if (diff == dpos) {
+            lo = hi;
+        } else {
+            while (lo < hi) {
+                unsigned mid = (lo + hi) / 2;
+                if (out[mid].bpos < diff) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+        }
+        assert((out[lo].bpos == diff) && (NULL == out[lo].key));
+        out[lo].key = node;
+    }
+    return nitem;
+}
+
+// -------------------------------------------------------------------------------------
+// Re-home the uplink to the root sentinel found in an item to a new root.  The sentinel
+// leaf is where the all-ones key ends, so we just follow the right spine.
+static void
+_rehome(
+    PathItemT  *item,
+    PTSetNodeT *oroot,
+    PTSetNodeT *nroot)
+{
+    PTSetNodeT *last, *next = item->link;
+
+    if (next == oroot) {
+        item->link = nroot;
+    } else {
+        do {
+            last = next;
+            next = last->_m_child[1];
+        } while (next->bpos > last->bpos);
+        assert(next == oroot);
+        last->_m_child[1] = nroot;
+    }
+    item->key = nroot;
+}
+
+// -------------------------------------------------------------------------------------
+// Build a new path below 'root' from a list of items, see above.  One of the items must
+// have the root as escaping node.
+static void
+_pathjoin(
+    PTSetNodeT      *root  ,
+    const void      *key   ,
+    uint16_t         bitlen,
+    const PathItemT *item  ,
+    unsigned         nitem )
+{
+    PTSetNodeT *last = root;
+    bool        ldir = false;
+    unsigned    skip = 0;
+
+    for (unsigned idx = 0; idx + 1 < nitem; ++idx) {
+        skip |= (item[idx].key == root);
+        PTSetNodeT *node = item[idx + skip].key;
+        bool        side = !patricia_getbit(key, bitlen, item[idx].bpos);
+
+        node->bpos = item[idx].bpos;
+        node->_m_child[side] = item[idx].link;
+        last->_m_child[ldir] = node;
+        last = node;
+        ldir = !side;
+    }
+    last->_m_child[ldir] = item[nitem - 1].link;
+    root->_m_child[1] = root;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief split a set at a pivot key
+///
+/// Moves all keys smaller than the pivot to @c lo and all keys greater or equal to
+/// @c hi, leaving @c src empty.  Only the nodes on the search path of the pivot are
+/// re-linked; no key is copied and no node is allocated or freed.  Both output sets
+/// get the memory policy and arena of the source.  If the arena killer of that policy
+/// really destroys the arena, make sure it is called only once!
+///
+/// @param src      set to split; empty afterwards
+/// @param key      pivot key storage
+/// @param bitlen   number of bits in pivot key
+/// @param lo       (OUT) set for keys below the pivot; initialised here
+/// @param hi       (OUT) set for keys at or above the pivot; initialised here
+/// @return         @c true on success, @c false if no scratch memory was available
+bool
+patriset_split(
+    PatriciaSetT *src   ,
+    const void   *key   ,
+    uint16_t      bitlen,
+    PatriciaSetT *lo    ,
+    PatriciaSetT *hi    )
+{
+    PathItemT  sbuf[PATH_SBUF], *item = sbuf, *ilo, *ihi;
+    unsigned   dpos, nitem, nlo = 0, nhi = 0;
+
+    assert((src != lo) && (src != hi) && (lo != hi));
+
+    patriset_init_ex2(lo, src->_m_mfunc, src->_m_mbatch, src->_m_arena);
+    patriset_init_ex2(hi, src->_m_mfunc, src->_m_mbatch, src->_m_arena);
+
+    // The empty key is logically the all-ones sentinel key, and all keys are below.
+    if (0 == bitlen) {
+        PathItemT all = { NULL, src->_m_root->_m_child[0], NULL, 0 };
+        _rehome(&all, src->_m_root, lo->_m_root);
+        lo->_m_root->_m_child[0] = all.link;
+        src->_m_root->_m_child[0] = src->_m_root;
+        return true;
+    }
+
+    nitem = _pathlen(src, key, bitlen, &dpos) + 1;
+    if ((3 * nitem + 1) > PATH_SBUF) {
+        item = malloc((3 * nitem + 1) * sizeof(*item));
+        if (NULL == item) {
+            return false;
+        }
+    }
+    nitem = _pathcut(src, key, bitlen, dpos, item);
+    ilo   = item + nitem;
+    ihi   = ilo + nitem + 1;
+
+    // Sort the items into the two piles.  The synthetic sentinel item of the lower pile
+    // goes in at the first zero bit of the pivot.
+    PathItemT sentinel = { NULL, lo->_m_root, lo->_m_root,
+                           patricia_bitdiff(key, bitlen, lo->_m_root->data, 0) };
+    for (unsigned idx = 0; idx < nitem; ++idx) {
+        if (patricia_getbit(key, bitlen, item[idx].bpos)) {
+            if ((NULL != sentinel.link) && (sentinel.bpos < item[idx].bpos)) {
+                ilo[nlo++] = sentinel;
+                sentinel.link = NULL;
+            }
+            ilo[nlo++] = item[idx];
+        } else {
+            if (item[idx].key == src->_m_root) {
+                _rehome(&item[idx], src->_m_root, hi->_m_root);
+            }
+            ihi[nhi++] = item[idx];
+        }
+    }
+    if (NULL != sentinel.link) {
+        ilo[nlo++] = sentinel;
+    }
+
+    _pathjoin(lo->_m_root, key, bitlen, ilo, nlo);
+    _pathjoin(hi->_m_root, key, bitlen, ihi, nhi);
+    src->_m_root->_m_child[0] = src->_m_root->_m_child[1] = src->_m_root;
+
+    if (item != sbuf) {
+        free(item);
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief join two sets with disjoint key ranges
+///
+/// All keys of @c b must be greater than all keys in @c a.  The nodes of @c b are moved
+/// to @c a, and @c b is left empty.  Like splitting, this works on the search path of
+/// the smallest key in @c b and needs no key copies.  Both sets must use the same memory
+/// policy, since @c a will take care of the moved nodes from now on.
+///
+/// @param a    set with the lower keys; receives all keys
+/// @param b    set with the upper keys; empty afterwards
+/// @return     @c true on success, @c false if the ranges overlap or no scratch memory
+///             was available
+bool
+patriset_join(
+    PatriciaSetT *a,
+    PatriciaSetT *b)
+{
+    PathItemT         sbuf[PATH_SBUF], *item = sbuf, *ia, *ib, *ij;
+    PTSetNodeT const *last, *next;
+    unsigned          da, db, na, nb, nj = 0;
+    bool              retv = true;
+
+    assert(a != b);
+
+    // The smallest key of 'b' is the leftmost leaf.  Nothing to do if 'b' is empty!
+    last = b->_m_root;
+    next = last->_m_child[0];
+    if (next == last) {
+        return true;
+    }
+    do {
+        last = next;
+        next = last->_m_child[0];
+    } while (next->bpos > last->bpos);
+
+    na = _pathlen(a, next->data, next->nbit, &da) + 1;
+    nb = _pathlen(b, next->data, next->nbit, &db) + 1;
+    if ((2 * (na + nb)) > PATH_SBUF) {
+        item = malloc(2 * (na + nb) * sizeof(*item));
+        if (NULL == item) {
+            return false;
+        }
+    }
+    ia = item;
+    na = _pathcut(a, next->data, next->nbit, da, ia);
+    ib = ia + na;
+    nb = _pathcut(b, next->data, next->nbit, db, ib);
+    ij = ib + nb;
+
+    // All items of 'a' must be below the pivot, except the bare sentinel leaf; all items
+    // of 'b' must be at or above it.  Merge by position, keeping the final item last.
+    for (unsigned ka = 0, kb = 0; retv && (kb < nb);) {
+        if ((ka < na) && ((kb + 1 == nb) || (ia[ka].bpos < ib[kb].bpos))) {
+            if (patricia_getbit(next->data, next->nbit, ia[ka].bpos)) {
+                ij[nj++] = ia[ka];
+            } else {
+                retv = (ia[ka].link == a->_m_root);
+            }
+            ++ka;
+        } else {
+            retv = !patricia_getbit(next->data, next->nbit, ib[kb].bpos);
+            ij[nj++] = ib[kb++];
+        }
+    }
+
+    if (retv) {
+        for (unsigned idx = 0; idx < nj; ++idx) {
+            if (ij[idx].key == b->_m_root) {
+                _rehome(&ij[idx], b->_m_root, a->_m_root);
+            }
+        }
+        _pathjoin(a->_m_root, next->data, next->nbit, ij, nj);
+        b->_m_root->_m_child[0] = b->_m_root->_m_child[1] = b->_m_root;
+    }
+
+    if (item != sbuf) {
+        free(item);
+    }
+    return retv;
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Structural cloning                                                          ====
+// -------------------------------------------------------------------------------------
+// Cloning by re-inserting all keys costs two walks per key.  Copying the structure is
+// much cheaper: A depth-first walk copies every node once, and only the links need
+// translation.  Downlinks are easy, since the target is copied right after the link
+// was followed.  Uplinks always point to an ancestor (or the node itself, or the root
+// sentinel), and the ancestors are on the walk stack -- sorted by branch position, so a
+// binary search finds the copy of the target.
+// -------------------------------------------------------------------------------------
+
+// one frame of the clone walk stack
+typedef struct {
+    const PTSetNodeT *snode;    // source node
+    PTSetNodeT       *dnode;    // copy of source node
+    unsigned          cidx;     // next child index to process
+} CloneFrameT;
+
+// -------------------------------------------------------------------------------------
+// find the copy of an uplink target on the clone stack
+static PTSetNodeT*
+_clone_xlat(
+    const CloneFrameT *stk,
+    unsigned           top,
+    const PTSetNodeT  *node)
+{
+    unsigned lo = 0, hi = top;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (stk[mid].snode->bpos < node->bpos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    assert(stk[lo].snode == node);
+    return stk[lo].dnode;
+}
+
+// Node blocks from the batch allocator, prepared for the next source nodes.  The clone
+// walk visits the source nodes in pre-order, so a second, lighter pre-order walk running
+// ahead of it tells the sizes of the nodes needed next.  That walk only keeps a stack of
+// the downlinks still to visit, on the C stack for shallow trees and on the heap beyond.
+typedef struct {
+    const PTSetNodeT  *tbuf[PATH_SBUF];         // look-ahead stack, initial storage
+    const PTSetNodeT **todo;                    // look-ahead stack
+    unsigned           tlen, tcap;              // fill & capacity of look-ahead stack
+    bool               done;                    // look-ahead or allocator exhausted
+    size_t             have;                    // number of blocks allocated
+    size_t             next;                    // next block to hand out
+    const PTSetNodeT  *snode[PATRICIA_BATCH];   // source nodes, in walk order
+    void              *block[PATRICIA_BATCH];   // memory for their copies
+} CloneBatchT;
+
+// -------------------------------------------------------------------------------------
+// push child 'cnode' of 'pnode' to the look-ahead stack if it is a downlink
+static bool
+_clone_push(
+    CloneBatchT      *batch,
+    const PTSetNodeT *pnode,
+    const PTSetNodeT *cnode)
+{
+    if (cnode->bpos <= pnode->bpos) {
+        return true;
+    }
+    if (batch->tlen == batch->tcap) {
+        const PTSetNodeT **tmp = (batch->todo == batch->tbuf)
+            ? malloc(2 * batch->tcap * sizeof(*tmp))
+            : realloc((void *)batch->todo, 2 * batch->tcap * sizeof(*tmp));
+        if (NULL == tmp) {
+            return false;
+        }
+        if (batch->todo == batch->tbuf) {
+            memcpy((void *)tmp, batch->tbuf, sizeof(batch->tbuf));
+        }
+        batch->todo  = tmp;
+        batch->tcap *= 2;
+    }
+    batch->todo[batch->tlen++] = cnode;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+// get the copy of source node 'snode' from the batch, refilling it as needed
+static PTSetNodeT*
+_clone_take(
+    const PatriciaSetT *dst  ,
+    CloneBatchT        *batch,
+    const PTSetNodeT   *snode)
+{
+    if (batch->next == batch->have) {
+        size_t bytes[PATRICIA_BATCH], want = 0;
+
+        if (batch->done) {
+            OPCOUNT(dst, allocfail);
+            return NULL;
+        }
+        while ((want < PATRICIA_BATCH) && (0 != batch->tlen)) {
+            const PTSetNodeT *scan = batch->todo[--batch->tlen];
+            batch->snode[want] = scan;
+            bytes[want++]      = ptnode_size(scan->nbit);
+            // right pushed first, so the left subtree comes next
+            if (!_clone_push(batch, scan, scan->_m_child[1]) ||
+                !_clone_push(batch, scan, scan->_m_child[0])  ) {
+                batch->tlen = 0;
+                break;
+            }
+        }
+        batch->have = (0 != want)
+            ? dst->_m_mbatch->fp_alloc_batch(dst->_m_arena, batch->block, bytes, want)
+            : 0;
+        batch->next = 0;
+        batch->done = (batch->have < want) || (0 == batch->tlen);
+        if (0 == batch->have) {
+            OPCOUNT(dst, allocfail);
+            return NULL;
+        }
+    }
+    assert(batch->snode[batch->next] == snode);
+    return ptnode_setup(batch->block[batch->next++], snode->data, snode->nbit);
+}
+
+// -------------------------------------------------------------------------------------
+// release the blocks of a batch that were not handed out, and the look-ahead stack
+static void
+_clone_drop(
+    const PatriciaSetT *dst  ,
+    CloneBatchT        *batch)
+{
+    size_t left = batch->have - batch->next;
+    void **objs = batch->block + batch->next;
+
+    if (batch->todo != batch->tbuf) {
+        free((void *)batch->todo);
+    }
+    if (0 == left) {
+        return;
+    }
+    if (NULL != MBATCH(dst, fp_free_batch)) {
+        dst->_m_mbatch->fp_free_batch(dst->_m_arena, objs, left);
+    } else if (NULL != dst->_m_mfunc->fp_free) {
+        while (0 != left--) {
+            dst->_m_mfunc->fp_free(dst->_m_arena, *objs++);
+        }
+    }
+    batch->next = batch->have;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief clone a set by copying its structure, with a hook for extra node data
+///
+/// Like @c patriset_clone(), but calls @c fp_copy (if not NULL) for every node copied,
+/// after the key was copied.  This is the hook a map needs to copy its payload.
+///
+/// With batch hooks, the nodes are allocated through the batch allocator.
+///
+/// @param dst      set to create; initialised here
+/// @param src      set to copy
+/// @param fp       memory policy for @c dst or @c NULL for the default policy
+/// @param batch    optional batch hooks of the memory policy (ignored for the default)
+/// @param arena    arena for the memory policy
+/// @param fp_copy  optional node data copier
+/// @return         @c true on success; on failure, @c dst is left finalised
+bool
+patriset_clone_ex(
+    PatriciaSetT       *dst    ,
+    const PatriciaSetT *src    ,
+    const PTMemFuncT   *fp     ,
+    const PTMemBatchT  *batch  ,
+    void               *arena  ,
+    void              (*fp_copy)(PTSetNodeT *, const PTSetNodeT *))
+{
+    CloneFrameT  sbuf[PATH_SBUF], *stk = sbuf;
+    CloneBatchT  cbat, *pbatch = NULL;
+    unsigned     top = 0, cap = PATH_SBUF;
+    bool         retv = true;
+
+    if (NULL != fp) {
+        patriset_init_ex2(dst, fp, batch, arena);
+    } else {
+        patriset_init(dst);
+    }
+    if (NULL != MBATCH(dst, fp_alloc_batch)) {
+        pbatch = &cbat;
+        pbatch->todo = pbatch->tbuf;
+        pbatch->tlen = 0;
+        pbatch->tcap = PATH_SBUF;
+        pbatch->have = pbatch->next = 0;
+        pbatch->done = false;
+        (void)_clone_push(pbatch, src->_m_root, src->_m_root->_m_child[0]);
+    }
+
+    stk[0].snode = src->_m_root;
+    stk[0].dnode = dst->_m_root;
+    stk[0].cidx  = 0;
+    while (retv) {
+        CloneFrameT      *frm  = &stk[top];
+        const PTSetNodeT *next;
+        unsigned          cidx = frm->cidx++;
+
+        if (2 == cidx) {
+            // node done -- back to parent, if there is one
+            if (0 == top--) {
+                break;
+            }
+            continue;
+        }
+        next = frm->snode->_m_child[cidx];
+        if (next->bpos <= frm->snode->bpos) {
+            frm->dnode->_m_child[cidx] = _clone_xlat(stk, top, next);
+            continue;
+        }
+
+        // a real downlink: copy node (key and all) and make it a new frame
+        PTSetNodeT *node = (NULL != pbatch) ? _clone_take(dst, pbatch, next)
+                                            : ptnode_create(dst, next->data, next->nbit);
+        if (NULL == node) {
+            retv = false;
+            break;
+        }
+        node->bpos = next->bpos;
+        node->_m_child[0] = node->_m_child[1] = node; // safe for 'fini' until linked
+        frm->dnode->_m_child[cidx] = node;
+        if (NULL != fp_copy) {
+            fp_copy(node, next);
+        }
+
+        if (++top == cap) {
+            CloneFrameT *tmp = (stk == sbuf) ? malloc(2 * cap * sizeof(*stk))
+                                             : realloc(stk, 2 * cap * sizeof(*stk));
+            if (NULL == tmp) {
+                retv = false;
+                break;
+            }
+            if (stk == sbuf) {
+                memcpy(tmp, sbuf, sizeof(sbuf));
+            }
+            stk  = tmp;
+            cap *= 2;
+        }
+        stk[top].snode = next;
+        stk[top].dnode = node;
+        stk[top].cidx  = 0;
+    }
+
+    if (stk != sbuf) {
+        free(stk);
+    }
+    if (NULL != pbatch) {
+        _clone_drop(dst, pbatch);
+    }
+    if (!retv) {
+        patriset_fini(dst);
+    }
+    return retv;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief clone a set by copying its structure
+///
+/// Every node is copied exactly once in a single depth-first walk, and the links are
+/// translated to the copies.  If the memory policy allocates from a fresh arena, the
+/// copy is also nicely packed in memory.
+///
+/// @param dst      set to create; initialised here
+/// @param src      set to copy
+/// @param fp       memory policy for @c dst or @c NULL for the default policy
+/// @param arena    arena for the memory policy
+/// @return         @c true on success; on failure, @c dst is left finalised
+bool
+patriset_clone(
+    PatriciaSetT       *dst  ,
+    const PatriciaSetT *src  ,
+    const PTMemFuncT   *fp   ,
+    void               *arena)
+{
+    return patriset_clone_ex(dst, src, fp, NULL, arena, NULL);
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Operation counters                                                          ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief read (and optionally clear) the operation counters of a tree
+///
+/// The counters are maintained only if the library is built with @c PATRICIA_OP_COUNTERS
+/// defined.  Without it the tree has no counters, the operations pay nothing, and this
+/// function reports zeros.  Counters are per tree and not synchronised: with them
+/// compiled in, lookups write to the tree and are no longer safe for concurrent readers.
+/// Read them from the thread that owns the tree.
+///
+/// @param tree     tree to inspect
+/// @param out      (opt) where to store the counters
+/// @param reset    clear the counters after reading
+/// @return         @c true if counters are compiled in, @c false otherwise
+bool
+patriset_counters(
+    const PatriciaSetT *tree ,
+    PTOpCountT         *out  ,
+    bool                reset)
+{
+#ifdef PATRICIA_OP_COUNTERS
+    if (NULL != out) {
+        *out = tree->_m_ops;
+    }
+    if (reset) {
+        memset(&((PatriciaSetT *)tree)->_m_ops, 0, sizeof(tree->_m_ops));
+    }
+    return true;
+#else
+    (void)tree;
+    (void)reset;
+    if (NULL != out) {
+        memset(out, 0, sizeof(*out));
+    }
+    return false;
+#endif
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Shape statistics                                                            ====
+// -------------------------------------------------------------------------------------
+
+// one frame of the statistics walk: node and its depth (top node has depth 1)
+typedef struct {
+    const PTSetNodeT *node;
+    unsigned          depth;
+} StatFrameT;
+
+// bucket index of a branch position gap: floor(log2(gap))
+static unsigned
+_stats_gapidx(
+    unsigned gap)
+{
+    return (unsigned)(sizeof(size_t) * CHAR_BIT) - 1u - clzz((size_t)gap);
+}
+
+// bytes of key storage in a node
+static size_t
+_stats_keybytes(
+    const PTSetNodeT *node)
+{
+    return ((size_t)node->nbit + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief compute shape statistics of a tree
+///
+/// One depth-first walk over all nodes with an explicit stack; no recursion.  The stack
+/// lives on the C stack for trees up to 64 levels deep and moves to the heap beyond.
+///
+/// @param tree     tree to inspect
+/// @param out      where to store the statistics
+/// @return         @c true on success, @c false if the walk stack could not be allocated
+bool
+patriset_stats(
+    const PatriciaSetT *tree,
+    PTSetStatsT        *out )
+{
+    StatFrameT        sbuf[PATH_SBUF], *stk = sbuf;
+    unsigned          top = 0, cap = PATH_SBUF;
+    const PTSetNodeT *node = tree->_m_root->_m_child[0];
+    size_t            dsum = 0;
+
+    memset(out, 0, sizeof(*out));
+    if (node->bpos <= tree->_m_root->bpos) {
+        return true;    // empty tree
+    }
+    out->gap[_stats_gapidx(node->bpos)] += 1;
+    stk[top].node  = node;
+    stk[top].depth = 1;
+    ++top;
+
+    while (0 != top) {
+        StatFrameT frm = stk[--top];
+        unsigned   downs = 0;
+        size_t     bytes = _stats_keybytes(frm.node);
+
+        out->keys       += 1;
+        out->key_bytes  += bytes;
+        out->node_bytes += offsetof(PTSetNodeT, data) + bytes + 1;
+        for (unsigned idx = 0; idx < 2; ++idx) {
+            const PTSetNodeT *next = frm.node->_m_child[idx];
+            if (next->bpos <= frm.node->bpos) {
+                // uplink: the key of 'next' is found after passing 'depth' nodes
+                if (next != tree->_m_root) {
+                    unsigned d = frm.depth;
+                    out->depth[(d < PATRICIA_STATS_DEPTHS) ? d : (PATRICIA_STATS_DEPTHS - 1)] += 1;
+                    out->max_depth = (d > out->max_depth) ? d : out->max_depth;
+                    dsum += d;
+                }
+                continue;
+            }
+            ++downs;
+            out->gap[_stats_gapidx(next->bpos - frm.node->bpos)] += 1;
+            if (top == cap) {
+                StatFrameT *tmp = (stk == sbuf) ? malloc(2 * cap * sizeof(*stk))
+                                                : realloc(stk, 2 * cap * sizeof(*stk));
+                if (NULL == tmp) {
+                    if (stk != sbuf) {
+                        free(stk);
+                    }
+                    return false;
+                }
+                if (stk == sbuf) {
+                    memcpy(tmp, sbuf, sizeof(sbuf));
+                }
+                stk  = tmp;
+                cap *= 2;
+            }
+            stk[top].node  = next;
+            stk[top].depth = frm.depth + 1;
+            ++top;
+        }
+        if (0 == downs) {
+            ++out->leaves;
+        } else {
+            ++out->inner;
+        }
+    }
+    if (stk != sbuf) {
+        free(stk);
+    }
+
+    out->avg_depth  = out->keys ? (double)dsum / (double)out->keys : 0.0;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief estimate shape statistics of a tree from random descents
+///
+/// Every descent starts at the top node and follows a random child at each node until it
+/// takes an uplink.  An uplink after passing @c d nodes is reached with probability
+/// 2^-d, so weighting what is seen on the way with the inverse probability gives
+/// unbiased estimates of all sums (Knuth's estimator for the size of a search tree).
+/// Costs are O(samples * depth), independent of the tree size.
+///
+/// The estimates are good for reasonably balanced trees.  For degenerated, very deep
+/// trees the variance explodes and the exact @c patriset_stats() should be used.  The
+/// maximum depth is the largest depth seen and a lower bound only.
+///
+/// @param tree     tree to inspect
+/// @param out      where to store the estimates; @c out->samples is set
+/// @param samples  number of random descents, 0 is taken as 1
+/// @param seed     random seed; same seed and tree give the same estimate
+void
+patriset_stats_sampled(
+    const PatriciaSetT *tree   ,
+    PTSetStatsT        *out    ,
+    size_t              samples,
+    uint64_t            seed   )
+{
+    const PTSetNodeT *top = tree->_m_root->_m_child[0];
+    double            wnode = 0.0, wkbytes = 0.0, wnbytes = 0.0;
+    double            wdepth[PATRICIA_STATS_DEPTHS] = { 0.0 };
+    double            wgap[sizeof(out->gap) / sizeof(out->gap[0])] = { 0.0 };
+    double            wleaf = 0.0, winner = 0.0, wkeys = 0.0, dsum = 0.0;
+    uint64_t          rng = seed ^ UINT64_C(0x9E3779B97F4A7C15);
+
+    memset(out, 0, sizeof(*out));
+    samples = samples ? samples : 1;
+    out->samples = samples;
+    if (top->bpos <= tree->_m_root->bpos) {
+        return;     // empty tree
+    }
+
+    for (size_t run = 0; run < samples; ++run) {
+        const PTSetNodeT *node = top;
+        unsigned          depth = 1;
+        double            wgt = 1.0;    // inverse probability of reaching 'node'
+
+        wgap[_stats_gapidx(node->bpos)] += wgt;
+        for (;;) {
+            const PTSetNodeT *next;
+            unsigned          downs;
+            size_t            bytes = _stats_keybytes(node);
+
+            wnode   += wgt;
+            wkbytes += wgt * (double)bytes;
+            wnbytes += wgt * (double)(offsetof(PTSetNodeT, data) + bytes + 1);
+            downs = (node->_m_child[0]->bpos > node->bpos) + (node->_m_child[1]->bpos > node->bpos);
+            if (0 == downs) {
+                wleaf  += wgt;
+            } else {
+                winner += wgt;
+            }
+
+            // xorshift64: good enough to pick a direction
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            next = node->_m_child[rng >> 63];
+            wgt *= 2.0;
+            if (next->bpos <= node->bpos) {
+                if (next != tree->_m_root) {
+                    wkeys += wgt;
+                    dsum  += wgt * depth;
+                    wdepth[(depth < PATRICIA_STATS_DEPTHS) ? depth : (PATRICIA_STATS_DEPTHS - 1)] += wgt;
+                    out->max_depth = (depth > out->max_depth) ? depth : out->max_depth;
+                }
+                break;
+            }
+            wgap[_stats_gapidx(next->bpos - node->bpos)] += wgt;
+            node = next;
+            ++depth;
+        }
+    }
+
+    // averages over all runs, rounded to whole numbers for the counts
+    const double scale = 1.0 / (double)samples;
+    out->keys       = (size_t)(wnode   * scale + 0.5);
+    out->key_bytes  = (size_t)(wkbytes * scale + 0.5);
+    out->node_bytes = (size_t)(wnbytes * scale + 0.5);
+    out->leaves     = (size_t)(wleaf  * scale + 0.5);
+    out->inner      = (size_t)(winner * scale + 0.5);
+    out->avg_depth  = (wkeys > 0.0) ? dsum / wkeys : 0.0;
+    for (unsigned idx = 0; idx < PATRICIA_STATS_DEPTHS; ++idx) {
+        out->depth[idx] = (size_t)(wdepth[idx] * scale + 0.5);
+    }
+    for (unsigned idx = 0; idx < sizeof(wgap) / sizeof(wgap[0]); ++idx) {
+        out->gap[idx] = (size_t)(wgap[idx] * scale + 0.5);
+    }
+}
+
+// -------------------------------------------------------------------------------------
+// ==== showing tree as crude indented text (strring keys assumed)                  ====
+// -------------------------------------------------------------------------------------
+static void
+fprint_tree(
+    FILE *ofp, const PTSetNodeT * const node, unsigned level, unsigned flags)
+{
+    if (0 == flags) {
+        for (unsigned i = 0; i < level; ++i)
+            fputs("    ", ofp);
+        fprintf(ofp, "+--(%p)--> '%s(%u)'\n", (void*)node, node->data, node->bpos);
+    } else {
+        if (flags & 2)
+            fprint_tree(ofp, node->_m_child[1], (level + 1), (node->_m_child[1]->bpos > node->bpos ? 3 : 0));
+        for (unsigned i = 0; i < level; ++i)
+            fputs("    ", ofp);
+        fprintf(ofp, "[%2u, %p] \n", node->bpos, (void *)node);
+        if (flags & 1)
+            fprint_tree(ofp, node->_m_child[0], (level + 1), (node->_m_child[0]->bpos > node->bpos ? 3 : 0));
+    }
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief dump a tree as crude indented text
+/// @param ofp  where to write to
+/// @param tree what to dump
+/// @note assumes key data is NUL-terminated ASCII text -- be prepared for fun if it's not!
+void
+patriset_print(
+    FILE               *ofp ,
+    PatriciaSetT const *tree)
+{
+    fprint_tree(ofp, tree->_m_root->_m_child[0], 0, 3);
+}
+
+// -------------------------------------------------------------------------------------
+// ==== Iteration can be fun, actually ;)                                           ====
+// -------------------------------------------------------------------------------------
+// The description below was for regular depth-first, left-to-right traversal.  Doing a
+// right-to-left traversal is simple enough, just mirroring the procedure by flipping
+// the mapping fro 1st/2nd child to the actual child slot index!
+// This can be expressed by logical bit-flipping transformations, and the step function
+// makes heavy use of these properties: One function that handles both directions as
+// well as all three types of enumeration with minimal fuzz, forward and backward.
+// But it may need careful reading to see that it really covers it all.
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+// Continuation save points for resumable iteration
+// -------------------------------------------------------------------------------------
+// To allow the traversal to pause and resume, the iterator exposes a compact
+// "continuation state" containing:
+//
 //     * The current `node` pointer.
 //     * The `dir` (DOWN, LEFTUP, RIGHTUP).
 //     * The parent stack (only necessary ancestors).
@@ -1079,6 +2860,8 @@ iter_parentPop(
     static const unsigned pstkSize = sizeof(iter->_m_pstk) / sizeof(*iter->_m_pstk);
 
     const PTSetNodeT *last, *next;
+    const void       *key;
+    unsigned steps = 0;
 
     // try to pop nod from stack first
     while (0 != iter->_m_stkLen) {
@@ -1097,13 +2880,20 @@ iter_parentPop(
     }
 
     // stack exhausted. Walk down the tree and register parents on the way down
+#   ifdef PATRICIA_ITER_STATS
+    ++iter->rwcount;
+#   endif
+    OPCOUNT(iter->_m_tree, rewalks);
+    key  = (NULL != iter->_m_keyfn) ? iter->_m_keyfn(iter->_m_kctx, node) : node->data;
     last = iter->_m_root;
-    next = last->_m_child[patricia_getbit(node->data, node->nbit, last->bpos)];
+    next = last->_m_child[patricia_getbit(key, node->nbit, last->bpos)];
     while ((next != node) && (next->bpos > last->bpos)) {
         iter_parentPush(iter, last);
+        ++steps;
         last = next;
-        next = last->_m_child[patricia_getbit(node->data, node->nbit, last->bpos)];
+        next = last->_m_child[patricia_getbit(key, node->nbit, last->bpos)];
     }
+    PT_PROBE2(iter_rewalk, node->nbit, steps);
 
     // We really should have ended at 'node' here, but if we don't, flag failure!
     if ((next != node) || (next->bpos <= last->bpos)) {
@@ -1179,22 +2969,45 @@ static const IterTableT revTable = {
     /* iDir_tail */ {oDir_root, iDir_head, -1               }
 };
 
+// Both tables walk the same Euler tour of the tree, in opposite directions, but they
+// label the tour points differently: a node entered from above when walking backward
+// is at the point where the forward walk leaves it upward, and so on.  These tables
+// translate the state labels when the walking direction changes.
+static const uint8_t fwd2rev[1 + iDir_tail - iDir_head] = {
+    iDir_head, iDir_upC1, iDir_upC2, iDir_down, iDir_tail
+};
+static const uint8_t rev2fwd[1 + iDir_tail - iDir_head] = {
+    iDir_head, iDir_upC2, iDir_down, iDir_upC1, iDir_tail
+};
+
 // -------------------------------------------------------------------------------------
 // the stpping function
 static const PTSetNodeT*
 iter_step(
     PTSetIterT      *iter  ,
-    const IterTableT ttable)
+    const IterTableT ttable,
+    bool             back  )
 {
     bool              yield;
+    bool              skip = (back != iter->_m_back);
     EWayOut           odir;
     EWayIn            idir = iter->_m_state;
     PTSetNodeT const *next = iter->_m_nodep, *last = NULL;
 
+    if (skip) {
+        // Turning around: the saved state is the tour point right *after* the node
+        // yielded last.  Relabel it for the other table and take one transition without
+        // yielding, so the next yield is that node again -- like a cursor sitting between
+        // two nodes.  HEAD & TAIL are the same in both directions.
+        idir = back ? fwd2rev[idir] : rev2fwd[idir];
+        iter->_m_back = back;
+    }
+
     do {
         last = next;
 
-        yield = ttable[idir].mode == iter->_m_mode;
+        yield = !skip && (ttable[idir].mode == iter->_m_mode);
+        skip  = false;
         odir  = ttable[idir].odir;
         // stepping 'idir' must be LAST in this 3 steps!
         idir  = ttable[idir].idir;  // failure default -- normally replaced below
@@ -1252,12 +3065,43 @@ psetiter_init(
     PTSetNodeT const *root,
     bool              dir ,
     EPTIterMode       mode)
+{
+    psetiter_init_ex(iter, tree, root, dir, mode, NULL, NULL);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief set up an iterator for a set that does not keep the keys in the nodes
+///
+/// Like @c psetiter_init(), but the parent recovery walk takes the key bits of a node
+/// from @c keyfn instead of the node's @c data.
+///
+/// @param iter  iterator to operate on
+/// @param tree  patricia tree owning the nodes
+/// @param root  root of the subtree to iterate or @c NULL for full tree
+/// @param dir   @c true for left-to-right, false for right-to-left
+/// @param mode  enumeration mode for the nodes
+/// @param keyfn key getter or @c NULL for the node's @c data
+/// @param kctx  context for the key getter
+void
+psetiter_init_ex(
+    PTSetIterT       *iter ,
+    PatriciaSetT     *tree ,
+    PTSetNodeT const *root ,
+    bool              dir  ,
+    EPTIterMode       mode ,
+    PTIterKeyT        keyfn,
+    const void       *kctx )
 {
     memset(iter, 0, sizeof(*iter));
+#   ifdef PATRICIA_OP_COUNTERS
+    iter->_m_tree  = tree;
+#   endif
     iter->_m_root  = root ? root : iter_child(tree->_m_root, 0);
     iter->_m_dir   = dir;
     iter->_m_mode  = mode;
     iter->_m_state = iDir_head;
+    iter->_m_keyfn = keyfn;
+    iter->_m_kctx  = kctx;
 }
 
 // -------------------------------------------------------------------------------------
@@ -1268,7 +3112,7 @@ const PTSetNodeT*
 psetiter_next(
     PTSetIterT *iter)
 {
-    return iter_step(iter, fwdTable);
+    return iter_step(iter, fwdTable, false);
 }
 
 // -------------------------------------------------------------------------------------
@@ -1279,7 +3123,7 @@ const PTSetNodeT*
 psetiter_prev(
     PTSetIterT *iter)
 {
-    return iter_step(iter, revTable);
+    return iter_step(iter, revTable, true);
 }
 
 // -------------------------------------------------------------------------------------
@@ -1290,6 +3134,7 @@ psetiter_reset(
     PTSetIterT *iter)
 {
     iter->_m_state  = iDir_head;
+    iter->_m_back   = false;
 }
 
 // -------------------------------------------------------------------------------------
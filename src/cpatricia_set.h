@@ -53,6 +53,27 @@ typedef struct pt_memfunc_ {
     void  (*fp_kill )(void *);                    ///< @brief optional arena killer
 } PTMemFuncT;
 
+/// @brief optional batch hooks of a memory policy, see @c patriset_init_ex2()
+/// Cloning into a set allocates nodes through the batch allocator, and finalising
+/// releases them through the batch deleter, if set.  The batch allocator fills
+/// @c objs[i] with a block of @c bytes[i] bytes, just like @c fp_alloc would, and
+/// returns the number of blocks allocated from the front; less than @c count means out
+/// of memory.  The batch deleter gets node pointers, just like @c fp_free.
+///
+/// The caller sets @c size to @c sizeof(PTMemBatchT).  Members that do not fit into
+/// @c size are taken as NULL, so hooks added later do not break older callers.
+///
+/// The hooks are kept out of @c PTMemFuncT, whose layout stays as it was.  A tree keeps a
+/// pointer to them, though: @c PatriciaSetT, and every handle embedding it, is one
+/// pointer larger than before, so code allocating handles must be recompiled.
+typedef struct pt_membatch_ {
+    size_t   size;                                 ///< @brief sizeof(PTMemBatchT) as seen by the caller
+    size_t (*fp_alloc_batch)(void *arena, void **objs, const size_t *bytes, size_t count);
+                                                   ///< @brief optional batch allocator or NULL
+    void   (*fp_free_batch )(void *arena, void **objs, size_t count);
+                                                   ///< @brief optional batch deleter or NULL
+} PTMemBatchT;
+
 /// @brief core structure of a PATRICIA set node
 typedef struct pt_set_node_ {
     struct pt_set_node_ *_m_child[2];///< @brief child[0]=left, child[1]=right
@@ -64,14 +85,64 @@ typedef struct pt_set_node_ {
     char                 data[1];    ///< @brief \bold{(RO)} piggy-packed key bytes
 } PTSetNodeT;
 
+/// @brief one segment of a scatter/gather key
+/// A key given as an array of segments is the concatenation of all segment bits, in
+/// order; segments need not be byte multiples.  The total must fit into 16 bits.
+typedef struct {
+    const void          *ptr;        ///< @brief segment bits, MSB of first byte first
+    uint16_t             bitlen;     ///< @brief number of bits in segment
+} PTKeySegT;
+
+/// @brief operation counters of a tree, see @c patriset_counters()
+/// The counters are only maintained if the library is built with @c PATRICIA_OP_COUNTERS
+/// defined; otherwise the tree carries no counters and all values read as zero.
+/// With counters enabled, lookups and other read-only operations write to the tree, so
+/// a tree is no longer safe for concurrent readers.
+typedef struct pt_opcount_ {
+    uint64_t             descents;   ///< @brief walks from the root (lookup/prefix/insert/remove)
+    uint64_t             nodes;      ///< @brief nodes passed on these walks
+    uint64_t             getbit;     ///< @brief key bit extractions
+    uint64_t             equkey;     ///< @brief full key compares
+    uint64_t             bitdiff;    ///< @brief first-difference searches
+    uint64_t             rewalks;    ///< @brief iterator parent recovery walks from the top
+    uint64_t             allocfail;  ///< @brief failed node allocations
+} PTOpCountT;
+
+/// @brief number of buckets in the lookup path length histogram of @c PTSetStatsT
+#ifndef PATRICIA_STATS_DEPTHS
+# define PATRICIA_STATS_DEPTHS 64
+#endif
+
+/// @brief shape statistics of a tree, see @c patriset_stats()
+/// The lookup path length of a key is the number of nodes passed when searching for it;
+/// this is also the depth of the node holding the uplink to the key.  Branch position
+/// gaps are counted per downlink in power-of-two buckets: [1], [2..3], [4..7] and so on.
+typedef struct pt_set_stats_ {
+    size_t               keys;       ///< @brief number of keys (= nodes)
+    size_t               leaves;     ///< @brief nodes without downlinks, both links are uplinks
+    size_t               inner;      ///< @brief nodes with one or two downlinks
+    size_t               key_bytes;  ///< @brief total bytes of key storage
+    size_t               node_bytes; ///< @brief total bytes requested for nodes
+    unsigned             max_depth;  ///< @brief longest lookup path
+    double               avg_depth;  ///< @brief average lookup path over all keys
+    size_t               depth[PATRICIA_STATS_DEPTHS]; ///< @brief keys by lookup path length, last bucket takes the rest
+    size_t               gap[16];    ///< @brief downlinks by branch position gap, log2 buckets
+    size_t               samples;    ///< @brief zero for exact figures, else number of random descents
+} PTSetStatsT;
+
 /// @brief the PATRICIA node container structure
 typedef struct patricia_set_ {
     PTSetNodeT          _m_root[1];  ///< @brief root & sentinel
     const PTMemFuncT   *_m_mfunc;    ///< @brief memory core functions
     void               *_m_arena;    ///< @brief allocator arena (or NULL)
+    const PTMemBatchT  *_m_mbatch;   ///< @brief batch hooks of the memory policy (or NULL)
+# ifdef PATRICIA_OP_COUNTERS
+    PTOpCountT          _m_ops;      ///< @brief operation counters
+# endif
 } PatriciaSetT;
 
 extern void              patriset_init_ex(PatriciaSetT *t, const PTMemFuncT *fp, void *arena);
+extern void              patriset_init_ex2(PatriciaSetT *t, const PTMemFuncT *fp, const PTMemBatchT *batch, void *arena);
 extern void              patriset_init(PatriciaSetT *t);
 extern void              patriset_fini(PatriciaSetT *t);
 
@@ -80,6 +151,26 @@ extern const PTSetNodeT *patriset_prefix(const PatriciaSetT *t, const void *key,
 extern const PTSetNodeT *patriset_insert(PatriciaSetT *t, const void *key, uint16_t bitlen, bool *inserted);
 extern bool              patriset_evict(PatriciaSetT *t, PTSetNodeT *node);
 extern bool              patriset_remove(PatriciaSetT *t, const void *key, uint16_t bitlen);
+extern const PTSetNodeT *patriset_lookup_v(const PatriciaSetT *t, const PTKeySegT *seg, size_t nseg);
+extern const PTSetNodeT *patriset_prefix_v(const PatriciaSetT *t, const PTKeySegT *seg, size_t nseg);
+extern const PTSetNodeT *patriset_insert_v(PatriciaSetT *t, const PTKeySegT *seg, size_t nseg, bool *inserted);
+extern bool              patriset_remove_v(PatriciaSetT *t, const PTKeySegT *seg, size_t nseg);
+extern const PTSetNodeT *patriset_lookup_o(const PatriciaSetT *t, const void *base, size_t bitoff, uint16_t bitlen);
+extern const PTSetNodeT *patriset_prefix_o(const PatriciaSetT *t, const void *base, size_t bitoff, uint16_t bitlen);
+extern const PTSetNodeT *patriset_insert_o(PatriciaSetT *t, const void *base, size_t bitoff, uint16_t bitlen, bool *inserted);
+extern bool              patriset_remove_o(PatriciaSetT *t, const void *base, size_t bitoff, uint16_t bitlen);
+extern size_t            patriset_xor_nearest(const PatriciaSetT *t, const void *key, uint16_t bitlen, size_t k, const PTSetNodeT **out);
+extern const PTSetNodeT *patriset_xor_max(const PatriciaSetT *t, const void *key, uint16_t bitlen);
+extern size_t            patriset_remove_if(PatriciaSetT *t, bool (*pred)(const PTSetNodeT *, void *), void *ctx);
+extern bool              patriset_split(PatriciaSetT *src, const void *key, uint16_t bitlen, PatriciaSetT *lo, PatriciaSetT *hi);
+extern bool              patriset_join(PatriciaSetT *a, PatriciaSetT *b);
+extern bool              patriset_clone(PatriciaSetT *dst, const PatriciaSetT *src, const PTMemFuncT *fp, void *arena);
+extern bool              patriset_clone_ex(PatriciaSetT *dst, const PatriciaSetT *src, const PTMemFuncT *fp,
+                                           const PTMemBatchT *batch, void *arena,
+                                           void (*fp_copy)(PTSetNodeT *, const PTSetNodeT *));
+extern bool              patriset_counters(const PatriciaSetT *t, PTOpCountT *out, bool reset);
+extern bool              patriset_stats(const PatriciaSetT *t, PTSetStatsT *out);
+extern void              patriset_stats_sampled(const PatriciaSetT *t, PTSetStatsT *out, size_t samples, uint64_t seed);
 
 // the next are exported for easy unit testing
 extern unsigned int      patricia_clz(size_t v);
@@ -87,6 +178,10 @@ extern size_t            patricia_bswap(size_t v);
 extern bool              patricia_getbit(const void *base, uint16_t bitlen, uint16_t bitidx);
 extern uint16_t          patricia_bitdiff(const void *p1, uint16_t l1, const void *p2, uint16_t l2);
 extern bool              patricia_equkey(const void *p1, uint16_t l1, const void *p2, uint16_t l2);
+extern bool              patricia_getbit_v(const PTKeySegT *seg, size_t nseg, uint16_t bitidx);
+extern uint16_t          patricia_bitdiff_v(const PTKeySegT *seg, size_t nseg, const void *p2, uint16_t l2);
+extern bool              patricia_getbit_o(const void *base, size_t bitoff, uint16_t bitlen, uint16_t bitidx);
+extern uint16_t          patricia_bitdiff_o(const void *p1, size_t off1, uint16_t l1, const void *p2, uint16_t l2);
 
 // iteration can be fun...
 
@@ -97,6 +192,20 @@ typedef enum {
     ePTMode_postOrder = 2
 } EPTIterMode;
 
+/// @brief capacity of the iterator parent FIFO; a power of two from 2 to 128
+#ifndef PATRICIA_ITER_PSTK
+# define PATRICIA_ITER_PSTK 8
+#endif
+#if (PATRICIA_ITER_PSTK < 2) || (PATRICIA_ITER_PSTK > 128) || (PATRICIA_ITER_PSTK & (PATRICIA_ITER_PSTK - 1))
+# error "PATRICIA_ITER_PSTK must be a power of two in [2..128]"
+#endif
+
+/// @brief key bits of a node for the iterator, see @c psetiter_init_ex()
+/// @param ctx      context given at iterator initialisation
+/// @param node     node to get the key bits for; never the root sentinel
+/// @return         pointer to the @c node->nbit key bits of the node
+typedef const void *(*PTIterKeyT)(const void *ctx, const PTSetNodeT *node);
+
 /// @brief PATRICIA set iterator structure
 /// Iterating a tree without parent pointers or full threading links requires either
 /// a full stack of parent nodes or a search for the true parent of the node when
@@ -108,18 +217,32 @@ typedef enum {
 /// the queue capicity is reached.  Of course, the cache has to be rebuild regularely.
 /// But with a size of 8, this happens after doing 256 steps, and walking down a
 /// PATRICIA tree is fast as only bits are extracted -- no full key compares here!
+///
+/// The recovery walk needs the key bits of the node.  Sets that keep something else
+/// in @c data hand in a key getter with @c psetiter_init_ex().
 typedef struct {
     const PTSetNodeT   *_m_root;        ///< @brief root node for iteration, can be subtree 
     const PTSetNodeT   *_m_nodep;       ///< @brief node to pick up un next step
-    const PTSetNodeT   *_m_pstk[8];     ///< @brief bounded parent FIFO stack, should be 4/8/16
+    const PTSetNodeT   *_m_pstk[PATRICIA_ITER_PSTK]; ///< @brief bounded parent FIFO stack, should be 4/8/16
+    PTIterKeyT          _m_keyfn;       ///< @brief key getter for recovery walks, or NULL for @c data
+    const void         *_m_kctx;        ///< @brief context for the key getter
+# ifdef PATRICIA_ITER_STATS
+    unsigned int        rwcount;        ///< bench only: number of parent recovery walks
+# endif
+# ifdef PATRICIA_OP_COUNTERS
+    PatriciaSetT       *_m_tree;        ///< @brief tree for operation counters
+# endif
     uint8_t             _m_stkLen;      ///< @brief number of nodes in stack
     uint8_t             _m_stkTop;      ///< @brief current top index of stack, round robin fifo!
     uint8_t             _m_state : 3;   ///< @brief state / way node was entered
     uint8_t             _m_mode  : 2;   ///< @brief pre/in/post order mode flag
+    uint8_t             _m_back  : 1;   ///< @brief last step was backward
     bool                _m_dir;         ///< @brief direction, true is laft-to-right
 } PTSetIterT;
 
 extern void              psetiter_init(PTSetIterT *i, PatriciaSetT *t, const PTSetNodeT *root, bool dir, EPTIterMode mode);
+extern void              psetiter_init_ex(PTSetIterT *i, PatriciaSetT *t, const PTSetNodeT *root, bool dir, EPTIterMode mode,
+                                          PTIterKeyT keyfn, const void *kctx);
 extern const PTSetNodeT *psetiter_next(PTSetIterT *i);
 extern const PTSetNodeT *psetiter_prev(PTSetIterT *i);
 extern void              psetiter_reset(PTSetIterT *i);
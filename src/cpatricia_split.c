@@ -0,0 +1,202 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with separate node and key arenas (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//
+// A thin layer over the reference set: the key reference is the address of a key copy
+// in the key arena, and the memory policy hands out fixed-size nodes from the node
+// arena.  Inserting goes through the reference set with the caller's key first; only
+// if a node was created, the key is copied and the node rebound to the copy.
+// -------------------------------------------------------------------------------------
+
+#include "cpatricia_split.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <assert.h>
+
+#ifndef PATRISPLIT_BLOCK
+# define PATRISPLIT_BLOCK (64u << 10)  // arena block size, multiple of the page size
+#endif
+
+// -------------------------------------------------------------------------------------
+// ==== memory policy & resolver                                                    ====
+// -------------------------------------------------------------------------------------
+
+// keys are referenced by address
+static const void *
+_sresolve(
+    void      *unused,
+    uintptr_t  ref   )
+{
+    (void)unused;
+    return (const void *)ref;
+}
+
+// node from the free list, or fresh from the node arena
+static void *
+_salloc(
+    void  *arena,
+    size_t bytes)
+{
+    PatriciaSplitT *t = arena;
+    PTSetNodeT     *node;
+
+    assert(PATRIREF_NODE_SIZE == bytes);
+    if (NULL != (node = t->_m_free)) {
+        t->_m_free = node->_m_child[0];
+        return node;
+    }
+    return vmBump_alloc(&t->_m_nodes, bytes, sizeof(void *));
+}
+
+// node back to the free list
+static void
+_sfree(
+    void *arena,
+    void *obj  )
+{
+    PatriciaSplitT *t    = arena;
+    PTSetNodeT     *node = obj;
+
+    node->_m_child[0] = t->_m_free;
+    t->_m_free = node;
+}
+
+static const PTMemFuncT s_memfunc = {
+    _salloc,
+    _sfree,
+    NULL
+};
+
+// -------------------------------------------------------------------------------------
+// ==== Core operations                                                             ====
+// -------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------
+/// @brief set up a split set
+/// @param t        set to initialise
+/// @param limit    upper limit for each of the arenas, in bytes
+/// @return         @c true on success, @c false if the arenas could not be set up
+bool
+patrisplit_init(
+    PatriciaSplitT *t    ,
+    size_t          limit)
+{
+    size_t blocks = limit / PATRISPLIT_BLOCK + 1;
+
+    memset(t, 0, sizeof(*t));
+    patriref_init_ex(&t->_m_ref, _sresolve, NULL, &s_memfunc, t);
+    if (!vmBump_init(&t->_m_nodes, PATRISPLIT_BLOCK, blocks)) {
+        return false;
+    }
+    if (!vmBump_init(&t->_m_keys, PATRISPLIT_BLOCK, blocks)) {
+        vmBump_fini(&t->_m_nodes);
+        return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief finalize a split set, releasing both arenas in one go
+/// @param t        set to flush
+void
+patrisplit_fini(
+    PatriciaSplitT *t)
+{
+    // no need to visit the nodes -- they all live in the node arena
+    vmBump_fini(&t->_m_nodes);
+    vmBump_fini(&t->_m_keys);
+    t->_m_free = NULL;
+    patriref_init_ex(&t->_m_ref, _sresolve, NULL, &s_memfunc, t);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief lookup (exact match) for a key
+/// @param t        set to search
+/// @param key      storage of key bits
+/// @param bitlen   number of key bits
+/// @return         node with exact matching key or @c NULL
+const PTSetNodeT *
+patrisplit_lookup(
+    const PatriciaSplitT *t     ,
+    const void           *key   ,
+    uint16_t              bitlen)
+{
+    return patriref_lookup(&t->_m_ref, key, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief create node with a copy of the given key, insert into the set
+/// @param t        set to insert into
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @param inserted opt. storage for 'node created' flag
+/// @return         node with matching key (new or existing) or @c NULL on error
+const PTSetNodeT *
+patrisplit_insert(
+    PatriciaSplitT *t       ,
+    const void     *key     ,
+    uint16_t        bitlen  ,
+    bool           *inserted)
+{
+    const PTSetNodeT *node;
+    bool              ins;
+    void             *copy;
+    size_t            nbytes = ((size_t)bitlen + CHAR_BIT - 1) / CHAR_BIT;
+
+    if (inserted) {
+        *inserted = false;
+    }
+    node = patriref_insert(&t->_m_ref, (uintptr_t)key, bitlen, &ins);
+    if ((NULL == node) || !ins) {
+        return node;
+    }
+
+    // new node: move its key from the caller's buffer to the key arena
+    if (NULL == (copy = vmBump_alloc(&t->_m_keys, nbytes ? nbytes : 1, 1))) {
+        patriref_remove(&t->_m_ref, key, bitlen);
+        return NULL;
+    }
+    memcpy(copy, key, nbytes);
+    patriref_rebind((PTSetNodeT *)node, (uintptr_t)copy);
+
+    if (inserted) {
+        *inserted = true;
+    }
+    return node;
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief remove a key from the set
+/// @param t        set to remove from
+/// @param key      key data storage
+/// @param bitlen   number of bits in key
+/// @return         @c true on success, @c false if the key is not in the set
+bool
+patrisplit_remove(
+    PatriciaSplitT *t     ,
+    const void     *key   ,
+    uint16_t        bitlen)
+{
+    return patriref_remove(&t->_m_ref, key, bitlen);
+}
+
+// -------------------------------------------------------------------------------------
+/// @brief key bits of a node
+/// @param node     node to inspect
+/// @return         pointer to the key copy in the key arena
+const void *
+patrisplit_key(
+    const PTSetNodeT *node)
+{
+    return (const void *)patriref_ref(node);
+}
+
+// -*- that's all folks -*-
@@ -0,0 +1,61 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree SET with separate node and key arenas (dual-use node design)
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+//  - a reference set whose keys are copied into an arena of their own
+//  - the fixed-size topology nodes come from a dense node arena
+//  - bit indexing is PASCAL-like: 0 is invalid, the first bit has index 1
+// -------------------------------------------------------------------------------------
+
+#ifndef CPATRICIA_SPLIT_95D2C25B_D09C_4DC8_8DD5_DCC8C0C5B8A9
+#define CPATRICIA_SPLIT_95D2C25B_D09C_4DC8_8DD5_DCC8C0C5B8A9
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpatricia_ref.h"
+#include "vmbumppool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief PATRICIA set with split node / key storage
+/// A walk down the tree reads only child links and branch positions, but with inline
+/// keys every node drags its key bytes into the cache lines and pages around it.  This
+/// set keeps the nodes (links, branch position, length, key reference) packed in one
+/// arena and the key bytes in another, so a descent touches far fewer lines; the key
+/// arena is read once, for the final compare.
+///
+/// Removed nodes are recycled; key bytes of removed keys are not, they are released
+/// with the set.  Both arenas are limited to the size given at initialisation.
+///
+/// The nodes are those of the reference set in @c _m_ref: iterate with the
+/// @c prefiter_*() functions and take statistics with @c patriref_stats() on it.  The
+/// plain set iterators and statistics do not apply.
+typedef struct {
+    PatriciaRefT        _m_ref;      ///< @brief the reference set we're extending
+    VmBumpPoolT         _m_nodes;    ///< @brief node arena
+    VmBumpPoolT         _m_keys;     ///< @brief key arena
+    PTSetNodeT         *_m_free;     ///< @brief recycled nodes, linked by child[0]
+} PatriciaSplitT;
+
+extern bool              patrisplit_init(PatriciaSplitT *t, size_t limit);
+extern void              patrisplit_fini(PatriciaSplitT *t);
+
+extern const PTSetNodeT *patrisplit_lookup(const PatriciaSplitT *t, const void *key, uint16_t bitlen);
+extern const PTSetNodeT *patrisplit_insert(PatriciaSplitT *t, const void *key, uint16_t bitlen, bool *inserted);
+extern bool              patrisplit_remove(PatriciaSplitT *t, const void *key, uint16_t bitlen);
+extern const void       *patrisplit_key(const PTSetNodeT *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPATRICIA_SPLIT_95D2C25B_D09C_4DC8_8DD5_DCC8C0C5B8A9 */
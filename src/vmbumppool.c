@@ -57,6 +57,7 @@ everywhere, so it might get runtime-disabled after the first failed attempt...
 
 #include <assert.h>
 #include "vmbumppool.h"
+#include "cpatricia_probes.h"
 
 #if defined(__unix__)
 # include <unistd.h>
@@ -390,6 +391,7 @@ mpool_morecore(
         (void)_arena_release(pblock, msize);
         return retv;
     }
+    PT_PROBE2(arena_commit, s_pagesize, arena->_m_total);
 
     // Now we've finally got it! Push the new block onto the chain and
     // initialise the block header.
@@ -399,6 +401,7 @@ mpool_morecore(
     pblock->_m_next  = arena->_m_head;
     arena->_m_head  = pblock;
     arena->_m_total += pblock->_m_used + mslag;
+    PT_PROBE2(arena_morecore, msize, arena->_m_total);
 
     return 0;
 }
@@ -460,6 +463,7 @@ again:  // we might come back to this if 1st block cannot fullfill the request!
             errno = retv;
             return NULL;
         }
+        PT_PROBE2(arena_commit, (cphi - cplo), arena->_m_total);
     }
     // If we reach this point, we have enough writeable memory mapped into our address
     // space to honor the request.  Keep track of the new end-of-allocation and return
@@ -162,6 +162,417 @@ static void test_delete(void)
     }
 }
 
+// split a string key into up to three segments at random bit positions
+static size_t segsplit(PTKeySegT *seg, unsigned char (*buf)[64], const char *key)
+{
+    unsigned len = str2bits(key), a = (unsigned)rand() % (len + 1), b = (unsigned)rand() % (len + 1);
+    unsigned cut[4] = { 0, (a < b) ? a : b, (a < b) ? b : a, len };
+
+    for (unsigned s = 0; s < 3; ++s) {
+        memset(buf[s], 0, 64);
+        for (unsigned i = cut[s]; i < cut[s + 1]; ++i) {
+            if (patricia_getbit(key, (uint16_t)len, (uint16_t)(i + 1))) {
+                buf[s][(i - cut[s]) / 8] |= (unsigned char)(0x80u >> ((i - cut[s]) % 8));
+            }
+        }
+        seg[s].ptr = buf[s];
+        seg[s].bitlen = (uint16_t)(cut[s + 1] - cut[s]);
+    }
+    return 3;
+}
+
+static void test_segmented(void)
+{
+    unsigned char     buf[3][64];
+    PTKeySegT         seg[3];
+    char              key[64];
+    const PTSetNodeT *np;
+    unsigned          idx;
+    bool              ins;
+
+    srand(31);
+    for (idx = 0; names[idx]; ++idx) {
+        np = patriset_insert_v(&map, seg, segsplit(seg, buf, names[idx]), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->data);
+    }
+    validate(map._m_root);
+
+    for (idx = 0; names[idx]; ++idx) {
+        TEST_ASSERT_EQUAL_PTR(patriset_lookup(&map, names[idx], str2bits(names[idx])),
+                              patriset_lookup_v(&map, seg, segsplit(seg, buf, names[idx])));
+        TEST_ASSERT_NOT_NULL(patriset_insert_v(&map, seg, segsplit(seg, buf, names[idx]), &ins));
+        TEST_ASSERT_FALSE(ins);
+
+        snprintf(key, sizeof(key), "%sXX", names[idx]);
+        TEST_ASSERT_NULL(patriset_lookup_v(&map, seg, segsplit(seg, buf, key)));
+        np = patriset_prefix_v(&map, seg, segsplit(seg, buf, key));
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->data);
+    }
+
+    for (idx = 0; names[idx]; ++idx) {
+        TEST_ASSERT_TRUE(patriset_remove_v(&map, seg, segsplit(seg, buf, names[idx])));
+        TEST_ASSERT_FALSE(patriset_remove_v(&map, seg, segsplit(seg, buf, names[idx])));
+        validate(map._m_root);
+        if (names[idx + 1]) {
+            TEST_ASSERT_NOT_NULL(patriset_lookup(&map, names[idx + 1], str2bits(names[idx + 1])));
+        }
+    }
+}
+
+// embed a string key into 'buf' after 'off' random bits
+static void bitembed(unsigned char *buf, unsigned off, const char *key)
+{
+    unsigned len = str2bits(key);
+
+    for (unsigned i = 0; i < off + len; ++i) {
+        bool bit = (i < off) ? (rand() % 2)
+                             : patricia_getbit(key, (uint16_t)len, (uint16_t)(i - off + 1));
+        buf[i / 8] = (unsigned char)((buf[i / 8] & ~(0x80u >> (i % 8))) | ((unsigned)bit << (7 - i % 8)));
+    }
+}
+
+static void test_bitoffset(void)
+{
+    unsigned char     buf[80];
+    char              key[64];
+    const PTSetNodeT *np;
+    unsigned          idx, off;
+    bool              ins;
+
+    srand(37);
+    for (idx = 0; names[idx]; ++idx) {
+        bitembed(buf, off = (unsigned)rand() % 100, names[idx]);
+        np = patriset_insert_o(&map, buf, off, str2bits(names[idx]), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->data);
+    }
+    validate(map._m_root);
+
+    for (idx = 0; names[idx]; ++idx) {
+        bitembed(buf, off = (unsigned)rand() % 100, names[idx]);
+        TEST_ASSERT_EQUAL_PTR(patriset_lookup(&map, names[idx], str2bits(names[idx])),
+                              patriset_lookup_o(&map, buf, off, str2bits(names[idx])));
+        TEST_ASSERT_NOT_NULL(patriset_insert_o(&map, buf, off, str2bits(names[idx]), &ins));
+        TEST_ASSERT_FALSE(ins);
+
+        snprintf(key, sizeof(key), "%sXX", names[idx]);
+        bitembed(buf, off = (unsigned)rand() % 100, key);
+        TEST_ASSERT_NULL(patriset_lookup_o(&map, buf, off, str2bits(key)));
+        np = patriset_prefix_o(&map, buf, off, str2bits(key));
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->data);
+    }
+
+    for (idx = 0; names[idx]; ++idx) {
+        bitembed(buf, off = (unsigned)rand() % 100, names[idx]);
+        TEST_ASSERT_TRUE(patriset_remove_o(&map, buf, off, str2bits(names[idx])));
+        TEST_ASSERT_FALSE(patriset_remove_o(&map, buf, off, str2bits(names[idx])));
+        validate(map._m_root);
+    }
+}
+
+// XOR distance of two 40-bit keys
+static uint64_t xdist(const void *a, const void *b)
+{
+    uint64_t d = 0;
+    for (unsigned i = 0; i < 5; ++i) {
+        d = (d << 8) | (((const unsigned char *)a)[i] ^ ((const unsigned char *)b)[i]);
+    }
+    return d;
+}
+
+static void test_xor(void)
+{
+    enum { NKEYS = 600, K = 20 };
+    static unsigned char keys[NKEYS][5];
+    const PTSetNodeT    *out[K];
+    unsigned char        tgt[5] = { 0 };
+
+    TEST_ASSERT_EQUAL(0, patriset_xor_nearest(&map, tgt, 40, K, out));
+    TEST_ASSERT_NULL(patriset_xor_max(&map, tgt, 40));
+
+    srand(59);
+    for (unsigned i = 0; i < NKEYS; ++i) {
+        for (unsigned j = 0; j < 5; ++j) {
+            keys[i][j] = (unsigned char)rand();
+        }
+        keys[i][0] |= (i % 7) ? 0 : 0xF0; // some all-ones-ish prefixes near the sentinel
+        patriset_insert(&map, keys[i], 40, NULL);
+    }
+    for (unsigned round = 0; round < 200; ++round) {
+        uint64_t lim, best = 0;
+        size_t   n, closer = 0;
+
+        for (unsigned j = 0; j < 5; ++j) {
+            tgt[j] = (unsigned char)rand();
+        }
+        if (round % 4 == 0) {
+            memcpy(tgt, keys[rand() % NKEYS], 5); // a member, at distance zero
+        }
+        n = patriset_xor_nearest(&map, tgt, 40, K, out);
+        TEST_ASSERT_EQUAL(K, n);
+        for (size_t i = 1; i < n; ++i) {
+            TEST_ASSERT_TRUE(xdist(out[i - 1]->data, tgt) < xdist(out[i]->data, tgt));
+        }
+
+        // brute force: exactly K-1 keys are closer than the last one returned
+        lim = xdist(out[K - 1]->data, tgt);
+        for (unsigned i = 0; i < NKEYS; ++i) {
+            uint64_t d = xdist(keys[i], tgt);
+            closer += (d < lim);
+            if (d > best) {
+                best = d;
+            }
+        }
+        TEST_ASSERT_EQUAL(K - 1, closer);
+        TEST_ASSERT_NOT_NULL(patriset_xor_max(&map, tgt, 40));
+        TEST_ASSERT_TRUE(best == xdist(patriset_xor_max(&map, tgt, 40)->data, tgt));
+    }
+
+    // a k larger than the set returns all keys
+    {
+        const PTSetNodeT **all = malloc((NKEYS + 1) * sizeof(*all));
+        TEST_ASSERT_NOT_NULL(all);
+        TEST_ASSERT_EQUAL(NKEYS, patriset_xor_nearest(&map, tgt, 40, NKEYS + 1, all));
+        free(all);
+    }
+
+    // a degenerated tree, deeper than the walk stack buffer: one bit set per key
+    patriset_fini(&map);
+    patriset_init(&map);
+    {
+        unsigned char      id[32] = { 0 }, zero[32] = { 0 };
+        const PTSetNodeT **all = malloc(256 * sizeof(*all));
+        TEST_ASSERT_NOT_NULL(all);
+        for (unsigned i = 0; i < 255; ++i) {
+            id[i / 8] = (unsigned char)(0x80u >> (i % 8));
+            patriset_insert(&map, id, 256, NULL);
+            id[i / 8] = 0;
+        }
+        TEST_ASSERT_EQUAL(255, patriset_xor_nearest(&map, zero, 256, 256, all));
+        for (unsigned i = 0; i < 255; ++i) {
+            // the one-bit keys by distance: the lowest bit first
+            TEST_ASSERT_EQUAL(0x80u >> ((254 - i) % 8), (unsigned char)all[i]->data[(254 - i) / 8]);
+        }
+        free(all);
+    }
+}
+
+static bool pred_below(const PTSetNodeT *node, void *ctx)
+{
+    return node->data[0] < *(const char *)ctx;
+}
+
+static bool pred_all(const PTSetNodeT *node, void *ctx)
+{
+    (void)node;
+    (void)ctx;
+    return true;
+}
+
+static void test_remove_if(void)
+{
+    unsigned idx, nkeep = 0, nkill = 0;
+    bool ins;
+    char limit = 'k';
+
+    for (idx = 0; names[idx]; ++idx) {
+        (void)patriset_insert(&map, names[idx], str2bits(names[idx]), &ins);
+        if (names[idx][0] < limit) {
+            ++nkill;
+        } else {
+            ++nkeep;
+        }
+    }
+    validate(map._m_root);
+
+    TEST_ASSERT_EQUAL(nkill, patriset_remove_if(&map, pred_below, &limit));
+    validate(map._m_root);
+    for (idx = 0; names[idx]; ++idx) {
+        const PTSetNodeT *np = patriset_lookup(&map, names[idx], str2bits(names[idx]));
+        if (names[idx][0] < limit) {
+            TEST_ASSERT_NULL(np);
+        } else {
+            TEST_ASSERT_NOT_NULL(np);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(nkeep, patriset_remove_if(&map, pred_all, NULL));
+    TEST_ASSERT_EQUAL_PTR(map._m_root, map._m_root->_m_child[0]);
+    TEST_ASSERT_EQUAL(0, patriset_remove_if(&map, pred_all, NULL));
+}
+
+static bool is_below(const char *key, const char *pivot)
+{
+    uint16_t diff = patricia_bitdiff(key, str2bits(key), pivot, str2bits(pivot));
+    return (0 != diff) && patricia_getbit(pivot, str2bits(pivot), diff);
+}
+
+static void test_split_join(void)
+{
+    static const char *const pivots[] = { "m", "evenly", "even", "a", "zz", "" };
+    PatriciaSetT lo, hi;
+    unsigned idx;
+    bool ins;
+
+    for (idx = 0; names[idx]; ++idx) {
+        (void)patriset_insert(&map, names[idx], str2bits(names[idx]), &ins);
+    }
+
+    for (unsigned pdx = 0; pdx < sizeof(pivots) / sizeof(*pivots); ++pdx) {
+        const char *pivot = pivots[pdx];
+        TEST_ASSERT_TRUE(patriset_split(&map, pivot, str2bits(pivot), &lo, &hi));
+        TEST_ASSERT_EQUAL_PTR(map._m_root, map._m_root->_m_child[0]);
+        validate(lo._m_root);
+        validate(hi._m_root);
+        for (idx = 0; names[idx]; ++idx) {
+            const PTSetNodeT *np = patriset_lookup(&lo, names[idx], str2bits(names[idx]));
+            const PTSetNodeT *nq = patriset_lookup(&hi, names[idx], str2bits(names[idx]));
+            if (is_below(names[idx], pivot)) {
+                TEST_ASSERT_NOT_NULL(np);
+                TEST_ASSERT_NULL(nq);
+            } else {
+                TEST_ASSERT_NULL(np);
+                TEST_ASSERT_NOT_NULL(nq);
+            }
+        }
+
+        // join back into the (empty) source set
+        TEST_ASSERT_TRUE(patriset_join(&map, &lo));
+        TEST_ASSERT_TRUE(patriset_join(&map, &hi));
+        validate(map._m_root);
+        for (idx = 0; names[idx]; ++idx) {
+            TEST_ASSERT_NOT_NULL(patriset_lookup(&map, names[idx], str2bits(names[idx])));
+        }
+        patriset_fini(&lo);
+        patriset_fini(&hi);
+    }
+
+    // overlapping key ranges must be rejected
+    patriset_init(&hi);
+    (void)patriset_insert(&hi, "evenly", str2bits("evenly"), &ins);
+    TEST_ASSERT_FALSE(patriset_join(&map, &hi));
+    patriset_fini(&hi);
+}
+
+// randomized split & join, checked against a plain key list
+
+typedef struct {
+    unsigned char key[6];
+    uint16_t      nbit;
+} ModelKeyT;
+
+// key order as the split sees it: compare at the first differing bit
+static bool key_below(const void *a, uint16_t la, const void *b, uint16_t lb)
+{
+    uint16_t diff = patricia_bitdiff(a, la, b, lb);
+    return (0 != diff) && patricia_getbit(b, lb, diff);
+}
+
+static void rand_key(ModelKeyT *mk)
+{
+    mk->nbit = (uint16_t)(1 + rand() % (8 * sizeof(mk->key)));
+    for (size_t i = 0; i < sizeof(mk->key); ++i)
+        mk->key[i] = (unsigned char)rand();
+    // clear the bits beyond the key so the bytes can be compared, too
+    if (mk->nbit & 7)
+        mk->key[mk->nbit >> 3] &= (unsigned char)(0xFF00u >> (mk->nbit & 7));
+    memset(mk->key + (mk->nbit + 7) / 8, 0, sizeof(mk->key) - (mk->nbit + 7) / 8);
+}
+
+// every key in 'tree' must be a model key on the expected side of the pivot
+static size_t check_side(PatriciaSetT *tree, const ModelKeyT *model, size_t nmod,
+                         const ModelKeyT *pivot, bool below)
+{
+    PTSetIterT        it;
+    const PTSetNodeT *np;
+    size_t            cnt = 0, idx;
+
+    validate(tree->_m_root);
+    psetiter_init(&it, tree, NULL, true, ePTMode_inOrder);
+    while (NULL != (np = psetiter_next(&it))) {
+        TEST_ASSERT_EQUAL(below, key_below(np->data, np->nbit, pivot->key, pivot->nbit));
+        for (idx = 0; idx < nmod; ++idx)
+            if (0 == patricia_bitdiff(np->data, np->nbit, model[idx].key, model[idx].nbit))
+                break;
+        TEST_ASSERT_TRUE(idx < nmod);
+        ++cnt;
+    }
+    return cnt;
+}
+
+static void test_split_join_random(void)
+{
+    enum { NKEY = 200, NROUND = 200 };
+    static ModelKeyT model[NKEY];
+    PatriciaSetT lo, hi, lo2, hi2;
+    ModelKeyT    pivot;
+    size_t       nmod, nlo, idx;
+    bool         ins;
+
+    srand(52);
+    for (unsigned round = 0; round < NROUND; ++round) {
+        // fill the set and the model; duplicates are dropped from both
+        nmod = 0;
+        for (idx = (unsigned)rand() % NKEY; idx; --idx) {
+            rand_key(&model[nmod]);
+            TEST_ASSERT_NOT_NULL(patriset_insert(&map, model[nmod].key, model[nmod].nbit, &ins));
+            nmod += ins;
+        }
+
+        // pivot is either a member (or a prefix / extension of one) or random
+        if (nmod && (rand() & 1)) {
+            pivot = model[(unsigned)rand() % nmod];
+            if (rand() & 1)
+                pivot.nbit = (uint16_t)(1 + rand() % (8 * sizeof(pivot.key)));
+        } else {
+            rand_key(&pivot);
+        }
+        for (nlo = idx = 0; idx < nmod; ++idx)
+            nlo += key_below(model[idx].key, model[idx].nbit, pivot.key, pivot.nbit);
+
+        TEST_ASSERT_TRUE(patriset_split(&map, pivot.key, pivot.nbit, &lo, &hi));
+        TEST_ASSERT_EQUAL_PTR(map._m_root, map._m_root->_m_child[0]);
+        TEST_ASSERT_EQUAL(nlo, check_side(&lo, model, nmod, &pivot, true));
+        TEST_ASSERT_EQUAL(nmod - nlo, check_side(&hi, model, nmod, &pivot, false));
+
+        // splitting a side again at the same pivot leaves the other side empty
+        TEST_ASSERT_TRUE(patriset_split(&lo, pivot.key, pivot.nbit, &lo2, &hi2));
+        TEST_ASSERT_EQUAL(0, check_side(&hi2, model, nmod, &pivot, false));
+        TEST_ASSERT_TRUE(patriset_join(&lo, &lo2));
+        TEST_ASSERT_TRUE(patriset_join(&lo, &hi2));
+        patriset_fini(&lo2);
+        patriset_fini(&hi2);
+        TEST_ASSERT_TRUE(patriset_split(&hi, pivot.key, pivot.nbit, &lo2, &hi2));
+        TEST_ASSERT_EQUAL(0, check_side(&lo2, model, nmod, &pivot, true));
+        TEST_ASSERT_TRUE(patriset_join(&hi, &lo2));
+        TEST_ASSERT_TRUE(patriset_join(&hi, &hi2));
+        patriset_fini(&lo2);
+        patriset_fini(&hi2);
+
+        // joining in the wrong order must fail unless a side is empty
+        if (nlo && (nmod - nlo)) {
+            TEST_ASSERT_FALSE(patriset_join(&hi, &lo));
+        }
+
+        // join back; an empty side on either end must work as well
+        TEST_ASSERT_TRUE(patriset_join(&map, &lo));
+        TEST_ASSERT_TRUE(patriset_join(&map, &hi));
+        validate(map._m_root);
+        for (idx = 0; idx < nmod; ++idx) {
+            TEST_ASSERT_NOT_NULL(patriset_lookup(&map, model[idx].key, model[idx].nbit));
+            TEST_ASSERT_TRUE(patriset_remove(&map, model[idx].key, model[idx].nbit));
+        }
+        TEST_ASSERT_EQUAL_PTR(map._m_root, map._m_root->_m_child[0]);
+        patriset_fini(&lo);
+        patriset_fini(&hi);
+    }
+}
+
 static void test_dotgen(void)
 {
     unsigned idx;
@@ -179,6 +590,126 @@ static void test_dotgen(void)
     fclose(ofp);
 }
 
+static void *alloc_fail(void *arena, size_t bytes)
+{
+    (void)arena;
+    (void)bytes;
+    return NULL;
+}
+
+static void test_counters(void)
+{
+    static const PTMemFuncT mf_fail = { alloc_fail, NULL, NULL };
+    PatriciaSetT failing;
+    PTOpCountT   cnt;
+    unsigned     idx, num;
+    bool         ins, have;
+
+    for (num = 0; names[num]; ++num) {
+        (void)patriset_insert(&map, names[num], str2bits(names[num]), &ins);
+    }
+    memset(&cnt, 0xFF, sizeof(cnt));
+    have = patriset_counters(&map, &cnt, true);
+#ifdef PATRICIA_OP_COUNTERS
+    TEST_ASSERT_TRUE(have);
+    TEST_ASSERT_EQUAL(num, cnt.descents);
+    TEST_ASSERT_EQUAL(num, cnt.equkey);
+    TEST_ASSERT_EQUAL(num, cnt.bitdiff);
+    TEST_ASSERT_EQUAL(0, cnt.allocfail);
+
+    // lookups only: one descent & one key compare each, one bit per node passed
+    for (idx = 0; idx < num; ++idx) {
+        (void)patriset_lookup(&map, names[idx], str2bits(names[idx]));
+    }
+    TEST_ASSERT_TRUE(patriset_counters(&map, &cnt, false));
+    TEST_ASSERT_EQUAL(num, cnt.descents);
+    TEST_ASSERT_EQUAL(num, cnt.equkey);
+    TEST_ASSERT_EQUAL(0, cnt.bitdiff);
+    TEST_ASSERT_EQUAL(cnt.nodes, cnt.getbit);
+    TEST_ASSERT_TRUE(cnt.nodes >= num);
+
+    // reading without reset keeps the counters
+    TEST_ASSERT_TRUE(patriset_counters(&map, NULL, false));
+    TEST_ASSERT_TRUE(patriset_counters(&map, &cnt, true));
+    TEST_ASSERT_EQUAL(num, cnt.descents);
+    TEST_ASSERT_TRUE(patriset_counters(&map, &cnt, false));
+    TEST_ASSERT_EQUAL(0, cnt.descents);
+#else
+    TEST_ASSERT_FALSE(have);
+    TEST_ASSERT_EQUAL(0, cnt.descents);
+    TEST_ASSERT_EQUAL(0, cnt.allocfail);
+    (void)idx;
+#endif
+
+    patriset_init_ex(&failing, &mf_fail, NULL);
+    TEST_ASSERT_NULL(patriset_insert(&failing, "evenly", str2bits("evenly"), &ins));
+    TEST_ASSERT_FALSE(ins);
+    have = patriset_counters(&failing, &cnt, false);
+    TEST_ASSERT_EQUAL(have ? 1 : 0, cnt.allocfail);
+    patriset_fini(&failing);
+}
+
+// lookup path length of a key: nodes passed until the uplink is taken
+static unsigned pathlen(const PatriciaSetT *tree, const char *key)
+{
+    const PTSetNodeT *last = tree->_m_root, *next = last->_m_child[0];
+    unsigned          plen = 0;
+    while (next->bpos > last->bpos) {
+        last = next;
+        next = last->_m_child[patricia_getbit(key, str2bits(key), last->bpos)];
+        ++plen;
+    }
+    return plen;
+}
+
+static void test_stats(void)
+{
+    PTSetStatsT st, est;
+    unsigned    idx, num, dmax = 0;
+    size_t      bytes = 0, dsum = 0, hsum = 0, gsum = 0;
+    bool        ins;
+
+    TEST_ASSERT_TRUE(patriset_stats(&map, &st));
+    TEST_ASSERT_EQUAL(0, st.keys);
+    TEST_ASSERT_EQUAL(0, st.max_depth);
+
+    for (num = 0; names[num]; ++num) {
+        (void)patriset_insert(&map, names[num], str2bits(names[num]), &ins);
+    }
+    for (idx = 0; idx < num; ++idx) {
+        unsigned plen = pathlen(&map, names[idx]);
+        dsum += plen;
+        dmax  = (plen > dmax) ? plen : dmax;
+        bytes += strlen(names[idx]);
+    }
+
+    TEST_ASSERT_TRUE(patriset_stats(&map, &st));
+    TEST_ASSERT_EQUAL(0, st.samples);
+    TEST_ASSERT_EQUAL(num, st.keys);
+    TEST_ASSERT_EQUAL(num, st.leaves + st.inner);
+    TEST_ASSERT_EQUAL(bytes, st.key_bytes);
+    TEST_ASSERT_EQUAL(dmax, st.max_depth);
+    TEST_ASSERT_TRUE(st.avg_depth * num > dsum - 0.5);
+    TEST_ASSERT_TRUE(st.avg_depth * num < dsum + 0.5);
+    for (idx = 0; idx < PATRICIA_STATS_DEPTHS; ++idx) {
+        hsum += st.depth[idx];
+    }
+    for (idx = 0; idx < sizeof(st.gap) / sizeof(st.gap[0]); ++idx) {
+        gsum += st.gap[idx];
+    }
+    TEST_ASSERT_EQUAL(num, hsum);
+    TEST_ASSERT_EQUAL(num, gsum);   // one downlink into every node
+
+    // the estimate from random descents should be in the right ballpark
+    patriset_stats_sampled(&map, &est, 20000, 1);
+    TEST_ASSERT_EQUAL(20000, est.samples);
+    TEST_ASSERT_UINT_WITHIN(num / 5, num, est.keys);
+    TEST_ASSERT_UINT_WITHIN(bytes / 5, bytes, est.key_bytes);
+    TEST_ASSERT_TRUE(est.avg_depth > st.avg_depth - 1.0);
+    TEST_ASSERT_TRUE(est.avg_depth < st.avg_depth + 1.0);
+    TEST_ASSERT_TRUE(est.max_depth <= st.max_depth);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -186,6 +717,14 @@ int main(void)
     RUN_TEST(test_lookup);
     RUN_TEST(test_prefix);
     RUN_TEST(test_delete);
+    RUN_TEST(test_segmented);
+    RUN_TEST(test_bitoffset);
+    RUN_TEST(test_xor);
+    RUN_TEST(test_remove_if);
+    RUN_TEST(test_split_join);
+    RUN_TEST(test_split_join_random);
     RUN_TEST(test_dotgen);
+    RUN_TEST(test_counters);
+    RUN_TEST(test_stats);
     return UNITY_END();
 }
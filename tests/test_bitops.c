@@ -100,6 +100,91 @@ static void test_bitdiff_extcpl(void) {
     }
 }
 
+// copy 'len' bits starting after bit 'from' of 'src' to the start of 'dst'
+static void bitcut(unsigned char *dst, const unsigned char *src, unsigned from, unsigned len)
+{
+    memset(dst, 0, (len + 7) / 8 + 1);
+    for (unsigned i = 0; i < len; ++i) {
+        if (patricia_getbit(src, (uint16_t)(from + len), (uint16_t)(from + i + 1))) {
+            dst[i / 8] |= (unsigned char)(0x80u >> (i % 8));
+        }
+    }
+}
+
+static void test_segmented(void) {
+    // segmented keys must behave exactly like their concatenation
+    unsigned char key[16], other[16], part[4][17];
+    PTKeySegT     seg[4];
+
+    srand(7);
+    for (unsigned round = 0; round < 2000; ++round) {
+        unsigned len = (unsigned)rand() % 100, olen, nseg = 1 + (unsigned)rand() % 4, from = 0;
+        for (unsigned i = 0; i < sizeof(key); ++i) {
+            key[i] = (unsigned char)rand();
+        }
+        // random cut points, zero-length segments included
+        for (unsigned s = 0; s < nseg; ++s) {
+            unsigned n = (s + 1 == nseg) ? len - from : (unsigned)rand() % (len - from + 1);
+            if ((s + 1 < nseg) && (rand() % 2)) {
+                n -= n % 8; // byte-aligned cut
+            }
+            bitcut(part[s], key, from, n);
+            seg[s].ptr = part[s];
+            seg[s].bitlen = (uint16_t)n;
+            from += n;
+        }
+        for (unsigned i = 0; i <= len + 10; ++i) {
+            TEST_ASSERT_EQUAL(patricia_getbit(key, (uint16_t)len, (uint16_t)i),
+                              patricia_getbit_v(seg, nseg, (uint16_t)i));
+        }
+
+        // compare against a mutated copy: flipped bit, other length, or both
+        memcpy(other, key, sizeof(other));
+        olen = len;
+        switch (rand() % 3) {
+        case 0:  olen = (unsigned)rand() % 100; break;
+        case 1:  if (len) other[((unsigned)rand() % len) / 8] ^= (unsigned char)(1u << (rand() % 8)); break;
+        default: break;
+        }
+        TEST_ASSERT_EQUAL(patricia_bitdiff(key, (uint16_t)len, other, (uint16_t)olen),
+                          patricia_bitdiff_v(seg, nseg, other, (uint16_t)olen));
+    }
+}
+
+static void test_bitoffset(void) {
+    // a key at a bit offset must behave exactly like its byte-aligned copy; the buffer
+    // ends with the last key bit, so reading beyond it is caught by the sanitizers
+    unsigned char key[34], other[34], *buf;
+
+    srand(11);
+    for (unsigned round = 0; round < 4000; ++round) {
+        unsigned off = (unsigned)rand() % 64, len = (unsigned)rand() % 260, olen;
+        size_t   nbuf = (off + len + 7) / 8;
+
+        buf = malloc(nbuf ? nbuf : 1);
+        TEST_ASSERT_NOT_NULL(buf);
+        for (size_t i = 0; i < nbuf; ++i) {
+            buf[i] = (unsigned char)rand();
+        }
+        bitcut(key, buf, off, len);
+        for (unsigned i = 0; i <= len + 10; ++i) {
+            TEST_ASSERT_EQUAL(patricia_getbit(key, (uint16_t)len, (uint16_t)i),
+                              patricia_getbit_o(buf, off, (uint16_t)len, (uint16_t)i));
+        }
+
+        memcpy(other, key, sizeof(other));
+        olen = len;
+        switch (rand() % 3) {
+        case 0:  olen = (unsigned)rand() % 260; break;
+        case 1:  if (len) other[((unsigned)rand() % len) / 8] ^= (unsigned char)(1u << (rand() % 8)); break;
+        default: break;
+        }
+        TEST_ASSERT_EQUAL(patricia_bitdiff(key, (uint16_t)len, other, (uint16_t)olen),
+                          patricia_bitdiff_o(buf, off, (uint16_t)len, other, (uint16_t)olen));
+        free(buf);
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_clz);
@@ -110,5 +195,7 @@ int main(void) {
     RUN_TEST(test_bitdiff_extequ);
     RUN_TEST(test_bitdiff_extbit);
     RUN_TEST(test_bitdiff_extcpl);
+    RUN_TEST(test_segmented);
+    RUN_TEST(test_bitoffset);
     return UNITY_END();
 }
@@ -0,0 +1,129 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, Bloom filter front / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_bloom.h"
+#include "helper_build_tree.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static PatriciaBloomT set;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(patribloom_init(&set, 0));
+}
+void tearDown(void)
+{
+    patribloom_fini(&set);
+}
+
+static void test_grow(void)
+{
+    char   buf[32];
+    size_t cap = set._m_cap;
+    bool   ins;
+
+    // the filter grows with the set, and no key is ever filtered out
+    for (unsigned k = 0; k < 20000; ++k) {
+        snprintf(buf, sizeof(buf), "key-%u", k);
+        TEST_ASSERT_NOT_NULL(patribloom_insert(&set, buf, str2bits(buf), &ins));
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_TRUE(set._m_keys <= set._m_cap);
+    }
+    TEST_ASSERT_TRUE(set._m_cap > cap);
+    for (unsigned k = 0; k < 20000; ++k) {
+        snprintf(buf, sizeof(buf), "key-%u", k);
+        TEST_ASSERT_NOT_NULL(patribloom_lookup(&set, buf, str2bits(buf)));
+        snprintf(buf, sizeof(buf), "nokey-%u", k);
+        TEST_ASSERT_NULL(patribloom_lookup(&set, buf, str2bits(buf)));
+    }
+}
+
+static void test_churn(void)
+{
+    char   buf[32];
+    size_t cap;
+
+    // removals fill the filter like inserts; once it has room for churn, it is rebuilt
+    // at the same size
+    for (unsigned k = 0; k < 1000; ++k) {
+        snprintf(buf, sizeof(buf), "k%u", k);
+        patribloom_insert(&set, buf, str2bits(buf), NULL);
+    }
+    cap = 0;
+    for (unsigned round = 0; round < 50; ++round) {
+        for (unsigned k = 0; k < 1000; k += 2) {
+            snprintf(buf, sizeof(buf), "k%u", k);
+            TEST_ASSERT_TRUE(patribloom_remove(&set, buf, str2bits(buf)));
+            TEST_ASSERT_NULL(patribloom_lookup(&set, buf, str2bits(buf)));
+        }
+        for (unsigned k = 0; k < 1000; k += 2) {
+            snprintf(buf, sizeof(buf), "k%u", k);
+            TEST_ASSERT_NOT_NULL(patribloom_insert(&set, buf, str2bits(buf), NULL));
+        }
+        TEST_ASSERT_TRUE(set._m_keys + set._m_stale <= set._m_cap);
+        if (0 == round) {
+            cap = set._m_cap;
+        }
+    }
+    TEST_ASSERT_EQUAL(cap, set._m_cap);
+    TEST_ASSERT_EQUAL(1000, set._m_keys);
+
+    TEST_ASSERT_TRUE(patribloom_rebuild(&set));
+    TEST_ASSERT_EQUAL(0, set._m_stale);
+    for (unsigned k = 0; k < 1000; ++k) {
+        snprintf(buf, sizeof(buf), "k%u", k);
+        TEST_ASSERT_NOT_NULL(patribloom_lookup(&set, buf, str2bits(buf)));
+    }
+}
+
+static void test_fuzz(void)
+{
+    PatriciaSetT  ref;
+    unsigned char key[6];
+
+    // odd bit lengths: pad bits of the last byte must not change the hash
+    patriset_init(&ref);
+    srand(53);
+    for (unsigned step = 0; step < 40000; ++step) {
+        uint16_t len = (uint16_t)(1 + (unsigned)rand() % 44);
+        unsigned v   = (unsigned)rand() % 2000;
+        bool     in, ins;
+
+        memset(key, 0, sizeof(key));
+        memcpy(key, &v, sizeof(v));
+        if (len % 8) {
+            key[len / 8] |= (unsigned char)(rand() & (0xFFu >> (len % 8)));
+        }
+        in = (NULL != patriset_lookup(&ref, key, len));
+        TEST_ASSERT_EQUAL(in, NULL != patribloom_lookup(&set, key, len));
+        if (rand() % 3) {
+            TEST_ASSERT_NOT_NULL(patribloom_insert(&set, key, len, &ins));
+            TEST_ASSERT_EQUAL(!in, ins);
+            patriset_insert(&ref, key, len, NULL);
+        } else {
+            TEST_ASSERT_EQUAL(in, patribloom_remove(&set, key, len));
+            patriset_remove(&ref, key, len);
+        }
+    }
+    patriset_fini(&ref);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_grow);
+    RUN_TEST(test_churn);
+    RUN_TEST(test_fuzz);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-
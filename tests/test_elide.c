@@ -0,0 +1,330 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, prefix-elided key storage / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_elide.h"
+#include "helper_build_tree.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static PatriciaElideT set;
+
+void setUp(void)
+{
+    patrielide_init(&set);
+}
+void tearDown(void)
+{
+    patrielide_fini(&set);
+}
+
+static const char *const urls[] = {
+    "https://www.example.com/",
+    "https://www.example.com/index.html",
+    "https://www.example.com/images/logo.png",
+    "https://www.example.com/images/logo.svg",
+    "https://www.example.com/images/",
+    "https://www.example.com/docs/api/v1/overview",
+    "https://www.example.com/docs/api/v1/reference",
+    "https://www.example.com/docs/api/v2/overview",
+    "https://www.example.org/",
+    "https://www.example.org/about",
+    "http://www.example.com/",
+    "h", "ht", "http",
+    NULL
+};
+
+// every key handed out by the walk must be in the reference set
+typedef struct {
+    const PatriciaSetT *ref;
+    size_t              seen;
+} CheckCtxT;
+
+static bool check_key(const void *key, uint16_t bitlen, void *ctx)
+{
+    CheckCtxT *cc = ctx;
+    TEST_ASSERT_NOT_NULL(patriset_lookup(cc->ref, key, bitlen));
+    ++cc->seen;
+    return true;
+}
+
+static void check_all(const PatriciaSetT *ref, size_t count)
+{
+    CheckCtxT cc = { ref, 0 };
+    TEST_ASSERT_EQUAL(count, patrielide_foreach(&set, check_key, &cc));
+    TEST_ASSERT_EQUAL(count, cc.seen);
+}
+
+static void test_insert_lookup(void)
+{
+    PatriciaSetT ref;
+    size_t       idx, stored = 0, full = 0;
+    bool         ins;
+
+    patriset_init(&ref);
+    for (idx = 0; urls[idx]; ++idx) {
+        const PTSetNodeT *np = patrielide_insert(&set, urls[idx], str2bits(urls[idx]), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_EQUAL(str2bits(urls[idx]), np->nbit);
+        patriset_insert(&ref, urls[idx], str2bits(urls[idx]), NULL);
+    }
+    for (idx = 0; urls[idx]; ++idx) {
+        const PTSetNodeT *np = patrielide_lookup(&set, urls[idx], str2bits(urls[idx]));
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL_PTR(np, patrielide_insert(&set, urls[idx], str2bits(urls[idx]), &ins));
+        TEST_ASSERT_FALSE(ins);
+        stored += patrielide_keybytes(np);
+        full   += strlen(urls[idx]);
+    }
+    TEST_ASSERT_TRUE(3 * stored < 2 * full);
+
+    // misses: prefixes, extensions and near misses of stored keys
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "https://www.example.com", 23 * 8));
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "https://www.example.com/x", 25 * 8));
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "https://www.example.com/images/logo.pnh", 39 * 8));
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "https://www.example.net/", 24 * 8));
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "htt", 3 * 8));
+    TEST_ASSERT_NULL(patrielide_lookup(&set, "http", 31));
+
+    check_all(&ref, idx);
+    patriset_fini(&ref);
+}
+
+static void test_remove(void)
+{
+    bool   present[sizeof(urls) / sizeof(urls[0])];
+    size_t idx, num, round;
+
+    for (num = 0; urls[num]; ++num) {
+        TEST_ASSERT_NOT_NULL(patrielide_insert(&set, urls[num], str2bits(urls[num]), NULL));
+        present[num] = true;
+    }
+    // remove the even keys first, then the odd ones, checking the survivors each time
+    for (round = 0; round < 2; ++round) {
+        for (idx = round; idx < num; idx += 2) {
+            size_t j;
+            TEST_ASSERT_TRUE(patrielide_remove(&set, urls[idx], str2bits(urls[idx])));
+            TEST_ASSERT_FALSE(patrielide_remove(&set, urls[idx], str2bits(urls[idx])));
+            present[idx] = false;
+            for (j = 0; j < num; ++j) {
+                TEST_ASSERT_EQUAL(present[j], NULL != patrielide_lookup(&set, urls[j], str2bits(urls[j])));
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_PTR(set._m_set._m_root, set._m_set._m_root->_m_child[0]);
+}
+
+// -------------------------------------------------------------------------------------
+// random keys with long common prefixes against a plain set
+
+#define NKEY 400
+#define KMAX 40
+
+static unsigned char keys[NKEY][KMAX];
+static uint16_t      klen[NKEY];
+
+static void make_keys(unsigned seed)
+{
+    srand(seed);
+    for (unsigned k = 0; k < NKEY; ++k) {
+        // a few prefix families, then a short tail from a small alphabet
+        unsigned fam = (unsigned)rand() % 4, n = 0;
+        memset(keys[k], 0, KMAX);
+        n += (unsigned)snprintf((char *)keys[k], KMAX, "proto://host%u/path/", fam);
+        while (n < KMAX && (rand() % 6)) {
+            keys[k][n++] = (unsigned char)('a' + rand() % 3);
+        }
+        klen[k] = (uint16_t)(n * 8 - (unsigned)rand() % 8);
+    }
+}
+
+static void test_fuzz(void)
+{
+    PatriciaSetT ref;
+    size_t       count = 0;
+
+    make_keys(1234);
+    patriset_init(&ref);
+    for (unsigned step = 0; step < 20000; ++step) {
+        unsigned k = (unsigned)rand() % NKEY;
+        bool     in = (NULL != patriset_lookup(&ref, keys[k], klen[k]));
+        bool     ins;
+
+        TEST_ASSERT_EQUAL(in, NULL != patrielide_lookup(&set, keys[k], klen[k]));
+        if (rand() % 2) {
+            const PTSetNodeT *np = patrielide_insert(&set, keys[k], klen[k], &ins);
+            TEST_ASSERT_NOT_NULL(np);
+            TEST_ASSERT_EQUAL(!in, ins);
+            TEST_ASSERT_EQUAL(klen[k], np->nbit);
+            TEST_ASSERT_NOT_NULL(patriset_insert(&ref, keys[k], klen[k], NULL));
+            count += ins;
+        } else {
+            TEST_ASSERT_EQUAL(in, patrielide_remove(&set, keys[k], klen[k]));
+            TEST_ASSERT_EQUAL(in, patriset_remove(&ref, keys[k], klen[k]));
+            count -= in;
+        }
+        if (0 == step % 500) {
+            check_all(&ref, count);
+        }
+    }
+    check_all(&ref, count);
+    patriset_fini(&ref);
+}
+
+// -------------------------------------------------------------------------------------
+// iteration with key reconstruction
+
+// iterate in both directions; every key comes exactly once, with its full bits
+static void check_iter(const PatriciaSetT *keyset, size_t count)
+{
+    for (int dir = 0; dir < 2; ++dir) {
+        PatriciaSetT      ref;
+        PTElideIterT      iter;
+        const PTSetNodeT *node, *rn;
+        const void       *key;
+        size_t            seen = 0;
+        PTSetIterT        it;
+
+        // a private copy of the key set, emptied as the keys show up
+        patriset_init(&ref);
+        psetiter_init(&it, (PatriciaSetT *)keyset, NULL, true, ePTMode_preOrder);
+        while (NULL != (rn = psetiter_next(&it))) {
+            TEST_ASSERT_NOT_NULL(patriset_insert(&ref, rn->data, rn->nbit, NULL));
+        }
+
+        TEST_ASSERT_TRUE(pelideiter_init(&iter, &set, dir));
+        while (NULL != (node = pelideiter_next(&iter, &key))) {
+            TEST_ASSERT_EQUAL_PTR(node, patrielide_lookup(&set, key, node->nbit));
+            TEST_ASSERT_TRUE(patriset_remove(&ref, key, node->nbit));
+            ++seen;
+        }
+        TEST_ASSERT_FALSE(iter.failed);
+        pelideiter_fini(&iter);
+        TEST_ASSERT_EQUAL(count, seen);
+        TEST_ASSERT_EQUAL_PTR(ref._m_root, ref._m_root->_m_child[0]);
+        patriset_fini(&ref);
+    }
+}
+
+static void test_iterate(void)
+{
+    PatriciaSetT  ref;
+    PTSetStatsT   st;
+    PTElideIterT  iter;
+    unsigned char deep[KMAX];
+    size_t        count = 0, full = 0;
+    bool          ins;
+
+    // empty set
+    TEST_ASSERT_TRUE(pelideiter_init(&iter, &set, true));
+    TEST_ASSERT_NULL(pelideiter_next(&iter, NULL));
+    pelideiter_fini(&iter);
+
+    make_keys(4711);
+    patriset_init(&ref);
+    for (unsigned k = 0; k < NKEY; ++k) {
+        TEST_ASSERT_NOT_NULL(patrielide_insert(&set, keys[k], klen[k], &ins));
+        TEST_ASSERT_NOT_NULL(patriset_insert(&ref, keys[k], klen[k], NULL));
+        count += ins;
+        full  += ins ? (klen[k] + 7u) / 8u : 0u;
+    }
+    check_iter(&ref, count);
+
+    // shape as for the plain set, but fewer key bytes
+    TEST_ASSERT_TRUE(patrielide_stats(&set, &st));
+    TEST_ASSERT_EQUAL(count, st.keys);
+    TEST_ASSERT_EQUAL(count, st.leaves + st.inner);
+    TEST_ASSERT_TRUE(st.key_bytes < full);
+
+    // a chain of prefixes is deeper than the iterator's own stack
+    memset(deep, 'x', sizeof(deep));
+    for (uint16_t n = 1; n <= KMAX * 8; ++n) {
+        TEST_ASSERT_NOT_NULL(patrielide_insert(&set, deep, n, &ins));
+        TEST_ASSERT_NOT_NULL(patriset_insert(&ref, deep, n, NULL));
+        count += ins;
+    }
+    check_iter(&ref, count);
+    patriset_fini(&ref);
+}
+
+// -------------------------------------------------------------------------------------
+// a failed removal leaves the set untouched
+
+static size_t budget;
+
+static void *bt_alloc(void *arena, size_t n)
+{
+    (void)arena;
+    if (0 == budget) {
+        return NULL;
+    }
+    --budget;
+    return malloc(n);
+}
+static void bt_free(void *arena, void *p)
+{
+    (void)arena;
+    free(p);
+}
+
+static const PTMemFuncT mf_budget = { bt_alloc, bt_free, NULL };
+
+static void test_remove_nomem(void)
+{
+    PatriciaSetT ref;
+    size_t       count = 0, failed = 0;
+
+    patrielide_fini(&set);
+    patrielide_init_ex(&set, &mf_budget, NULL);
+    patriset_init(&ref);
+    make_keys(42);
+    budget = NKEY;
+    for (unsigned k = 0; k < NKEY; ++k) {
+        bool ins;
+        TEST_ASSERT_NOT_NULL(patrielide_insert(&set, keys[k], klen[k], &ins));
+        patriset_insert(&ref, keys[k], klen[k], NULL);
+        count += ins;
+    }
+
+    // without memory, only removals that need no node copies succeed
+    budget = 0;
+    for (unsigned k = 0; k < NKEY; ++k) {
+        if (patrielide_remove(&set, keys[k], klen[k])) {
+            count -= patriset_remove(&ref, keys[k], klen[k]);
+        } else {
+            failed += (NULL != patriset_lookup(&ref, keys[k], klen[k]));
+        }
+    }
+    TEST_ASSERT_TRUE(failed > 0);
+    check_all(&ref, count);
+
+    budget = 2 * NKEY;
+    for (unsigned k = 0; k < NKEY; ++k) {
+        bool in = (NULL != patriset_lookup(&ref, keys[k], klen[k]));
+        TEST_ASSERT_EQUAL(in, patrielide_remove(&set, keys[k], klen[k]));
+        patriset_remove(&ref, keys[k], klen[k]);
+    }
+    check_all(&ref, 0);
+    patriset_fini(&ref);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_lookup);
+    RUN_TEST(test_remove);
+    RUN_TEST(test_fuzz);
+    RUN_TEST(test_iterate);
+    RUN_TEST(test_remove_nomem);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-
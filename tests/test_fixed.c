@@ -0,0 +1,126 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, fixed-length keys / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_fixed.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+
+static PatriciaFixT set;
+
+void setUp(void)
+{
+}
+void tearDown(void)
+{
+    patrifix_fini(&set);
+}
+
+static void test_fullspace(void)
+{
+    unsigned char k;
+    bool          ins;
+
+    // all 256 keys of 8 bits, the all-ones key among them
+    TEST_ASSERT_TRUE(patrifix_init(&set, 8));
+    for (unsigned i = 0; i < 256; ++i) {
+        k = (unsigned char)(i * 167u);
+        TEST_ASSERT_NULL(patrifix_lookup(&set, &k, 8));
+        TEST_ASSERT_NOT_NULL(patrifix_insert(&set, &k, 8, &ins));
+        TEST_ASSERT_TRUE(ins);
+    }
+    for (unsigned i = 0; i < 256; ++i) {
+        const PTFixNodeT *np;
+        k = (unsigned char)i;
+        np = patrifix_lookup(&set, &k, 8);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL(k, (unsigned char)np->data[0]);
+        TEST_ASSERT_NOT_NULL(patrifix_insert(&set, &k, 8, &ins));
+        TEST_ASSERT_FALSE(ins);
+    }
+    for (unsigned i = 0; i < 256; ++i) {
+        k = (unsigned char)(i * 101u);
+        TEST_ASSERT_TRUE(patrifix_remove(&set, &k, 8));
+        TEST_ASSERT_FALSE(patrifix_remove(&set, &k, 8));
+        TEST_ASSERT_NULL(patrifix_lookup(&set, &k, 8));
+    }
+}
+
+static void test_mismatch(void)
+{
+    static const unsigned char key[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    bool ins = true;
+
+    // keys of other lengths are rejected, not truncated or extended
+    TEST_ASSERT_TRUE(patrifix_init(&set, 128));
+    TEST_ASSERT_NOT_NULL(patrifix_insert(&set, key, 128, NULL));
+    TEST_ASSERT_NULL(patrifix_insert(&set, key, 127, &ins));
+    TEST_ASSERT_FALSE(ins);
+    TEST_ASSERT_NULL(patrifix_lookup(&set, key, 120));
+    TEST_ASSERT_FALSE(patrifix_remove(&set, key, 96));
+    TEST_ASSERT_NOT_NULL(patrifix_lookup(&set, key, 128));
+}
+
+static void test_fuzz(void)
+{
+    static const uint16_t lens[] = { 13, 32, 64, 128, 200 };
+
+    // against the plain set, with few distinct keys per length to hit duplicates; the
+    // padding bits of partial bytes are random and must not matter
+    for (unsigned l = 0; l < sizeof(lens) / sizeof(lens[0]); ++l) {
+        uint16_t      len = lens[l];
+        unsigned      nbytes = (len + 7u) / 8u;
+        PatriciaSetT  ref;
+        unsigned char key[25];
+
+        TEST_ASSERT_TRUE(patrifix_init(&set, len));
+        patriset_init(&ref);
+        srand(41 + l);
+        for (unsigned step = 0; step < 20000; ++step) {
+            unsigned v = (unsigned)rand() % 600;
+            bool     in, ins;
+
+            for (unsigned i = 0; i < nbytes; ++i) {
+                key[i] = (unsigned char)((v >> (i % 3)) * 37u + i);
+            }
+            if (0 == v % 50) {
+                memset(key, 0xFF, nbytes);
+            }
+            if (len % 8) {
+                key[nbytes - 1] = (unsigned char)((key[nbytes - 1] & (0xFF00u >> (len % 8)))
+                                                | (rand() & (0xFFu >> (len % 8))));
+            }
+            in = (NULL != patriset_lookup(&ref, key, len));
+            TEST_ASSERT_EQUAL(in, NULL != patrifix_lookup(&set, key, len));
+            if (rand() % 2) {
+                TEST_ASSERT_NOT_NULL(patrifix_insert(&set, key, len, &ins));
+                TEST_ASSERT_EQUAL(!in, ins);
+                patriset_insert(&ref, key, len, NULL);
+            } else {
+                TEST_ASSERT_EQUAL(in, patrifix_remove(&set, key, len));
+                patriset_remove(&ref, key, len);
+            }
+        }
+        patriset_fini(&ref);
+        if (l + 1 < sizeof(lens) / sizeof(lens[0])) {
+            patrifix_fini(&set);
+        }
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fullspace);
+    RUN_TEST(test_mismatch);
+    RUN_TEST(test_fuzz);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-
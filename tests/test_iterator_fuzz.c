@@ -12,8 +12,10 @@
 #include "cpatricia_map.h"
 #include "helper_build_tree.h"
 #include "unity.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 void setUp(void) {
 }
@@ -85,10 +87,225 @@ static void test_fuzz_random_seeded(void) {
     do_one_fuzz_run(98765u, 120u);
 }
 
+static bool pred_all_map(const PTMapNodeT *node, void *ctx) {
+    (void)node;
+    ++*(size_t *)ctx;
+    return true;
+}
+
+/* map-level bulk removal: the predicate sees the map node and its payload */
+static bool pred_odd(const PTMapNodeT *node, void *ctx) {
+    ++*(size_t *)ctx;
+    return 0 != (node->payload & 1u);
+}
+
+static void test_fuzz_remove_if(void) {
+    typedef struct { uint8_t key[32]; uint16_t nbit; uintptr_t payload; } SavedT;
+    PatriciaMapT m;
+    NodeVecT all;
+    SavedT *saved;
+    size_t i, nodd = 0, ncalls = 0;
+
+    patrimap_init(&m);
+    TEST_ASSERT_TRUE(build_random_map(&m, 500u, 815u));
+    nv_init(&all);
+    collect_all_nodes(s2m(m._m_set._m_root->_m_child[0]), &all);
+    saved = malloc(all.n * sizeof(*saved));
+    TEST_ASSERT_NOT_NULL(saved);
+    for (i = 0; i < all.n; ++i) {
+        saved[i].nbit = all.a[i]->_m_node.nbit;
+        saved[i].payload = all.a[i]->payload;
+        memcpy(saved[i].key, all.a[i]->_m_node.data, (saved[i].nbit + 7u) / 8u);
+        nodd += saved[i].payload & 1u;
+    }
+
+    TEST_ASSERT_EQUAL(nodd, patrimap_remove_if(&m, pred_odd, &ncalls));
+    TEST_ASSERT_EQUAL(all.n, ncalls);
+    for (i = 0; i < all.n; ++i) {
+        const PTMapNodeT *x = patrimap_lookup(&m, saved[i].key, saved[i].nbit);
+        if (saved[i].payload & 1u) {
+            TEST_ASSERT_NULL(x);
+        } else {
+            TEST_ASSERT_NOT_NULL(x);
+            TEST_ASSERT_EQUAL(saved[i].payload, x->payload);
+        }
+    }
+
+    /* what is left goes in one call, and the map stays usable */
+    ncalls = 0;
+    TEST_ASSERT_EQUAL(all.n - nodd, patrimap_remove_if(&m, pred_all_map, &ncalls));
+    TEST_ASSERT_EQUAL_PTR(m._m_set._m_root, m._m_set._m_root->_m_child[0]);
+    TEST_ASSERT_NOT_NULL(patrimap_insert(&m, saved[0].key, saved[0].nbit, NULL));
+
+    free(saved);
+    nv_free(&all);
+    patrimap_fini(&m);
+}
+
+static bool same_key(const PTSetNodeT *a, const PTSetNodeT *b) {
+    return (a->nbit == b->nbit) && (0 == memcmp(a->data, b->data, (a->nbit + 7u) / 8u));
+}
+
+/* walk both in lockstep: same shape, same keys, same payload, same link targets */
+static void check_clone(PatriciaMapT *m, PatriciaMapT *c) {
+    PTMapIterT im, ic;
+    const PTMapNodeT *x, *y;
+    pmapiter_init(&im, m, NULL, true, ePTMode_preOrder);
+    pmapiter_init(&ic, c, NULL, true, ePTMode_preOrder);
+    while ((x = pmapiter_next(&im)) != NULL) {
+        y = pmapiter_next(&ic);
+        TEST_ASSERT_NOT_NULL(y);
+        TEST_ASSERT_TRUE(x != y);
+        TEST_ASSERT_EQUAL(x->payload, y->payload);
+        TEST_ASSERT_EQUAL(x->_m_node.bpos, y->_m_node.bpos);
+        TEST_ASSERT_TRUE(same_key(&x->_m_node, &y->_m_node));
+        for (int i = 0; i < 2; ++i) {
+            TEST_ASSERT_TRUE(same_key(x->_m_node._m_child[i], y->_m_node._m_child[i]));
+        }
+    }
+    TEST_ASSERT_NULL(pmapiter_next(&ic));
+}
+
+static void test_fuzz_clone(void) {
+    PatriciaMapT m, c;
+    patrimap_init(&m);
+    TEST_ASSERT_TRUE(build_random_map(&m, 500u, 4711u));
+    TEST_ASSERT_TRUE(patrimap_clone(&c, &m, NULL, NULL));
+    check_clone(&m, &c);
+    patrimap_fini(&m);
+    patrimap_fini(&c);
+}
+
+/* malloc-based map policy with batch hooks; counts calls and live nodes */
+static size_t bt_single, bt_alloc, bt_free, bt_live, bt_budget;
+
+static void *bt_one(size_t bytes) {
+    PTMapNodeT *p = malloc(bytes + offsetof(PTMapNodeT, _m_node));
+    if (p != NULL) {
+        p->payload = 0;
+        ++bt_live;
+    }
+    return p ? &p->_m_node : NULL;
+}
+static void *bt_alloc_one(void *arena, size_t bytes) {
+    (void)arena;
+    ++bt_single;
+    return bt_one(bytes);
+}
+static void bt_free_one(void *arena, void *obj) {
+    (void)arena;
+    --bt_live;
+    free(s2m(obj));
+}
+static size_t bt_alloc_batch(void *arena, void **objs, const size_t *bytes, size_t count) {
+    size_t n;
+    (void)arena;
+    ++bt_alloc;
+    for (n = 0; n < count && bt_budget != 0; ++n, --bt_budget) {
+        if ((objs[n] = bt_one(bytes[n])) == NULL) break;
+    }
+    return n;
+}
+static void bt_free_batch(void *arena, void **objs, size_t count) {
+    ++bt_free;
+    while (count--) bt_free_one(arena, *objs++);
+}
+
+static void test_fuzz_clone_batch(void) {
+    static const PTMemFuncT  mf = { bt_alloc_one, bt_free_one, NULL };
+    static const PTMemBatchT mb = { sizeof(PTMemBatchT), bt_alloc_batch, bt_free_batch };
+    PatriciaMapT m, c;
+    patrimap_init(&m);
+    TEST_ASSERT_TRUE(build_random_map(&m, 500u, 4711u));
+
+    /* clone through the batch allocator; finalising goes through the batch deleter */
+    bt_single = bt_alloc = bt_free = bt_live = 0;
+    bt_budget = (size_t)-1;
+    TEST_ASSERT_TRUE(patrimap_clone_ex(&c, &m, &mf, &mb, NULL));
+    check_clone(&m, &c);
+    TEST_ASSERT_EQUAL(0, bt_single);
+    TEST_ASSERT_TRUE(bt_alloc >= 1 && bt_alloc <= 500u);
+    TEST_ASSERT_TRUE(bt_live <= 500u && bt_live > 250u);
+    patrimap_fini(&c);
+    TEST_ASSERT_EQUAL(0, bt_live);
+    TEST_ASSERT_TRUE(bt_free >= 1 && bt_free <= 500u);
+
+    /* out of memory halfway: the clone fails and leaks nothing */
+    bt_budget = 100;
+    TEST_ASSERT_FALSE(patrimap_clone_ex(&c, &m, &mf, &mb, NULL));
+    TEST_ASSERT_EQUAL(0, bt_live);
+
+    patrimap_fini(&m);
+}
+
+/* random next/prev sequences against a cursor model: prev after next yields the same node */
+static void do_one_zigzag_run(const PatriciaMapT *m, const NodeVecT *ref, EPTIterMode mode) {
+    PTMapIterT it;
+    const PTMapNodeT *x;
+    size_t cur = 0;
+
+    pmapiter_init(&it, (PatriciaMapT *)m, NULL, true, mode);
+    for (unsigned step = 0; step < 20000u; ++step) {
+        if (rand() % 3) {
+            x = pmapiter_next(&it);
+            if (cur < ref->n) {
+                TEST_ASSERT_EQUAL_PTR(ref->a[cur], x);
+                ++cur;
+            } else {
+                TEST_ASSERT_NULL(x);
+            }
+        } else {
+            x = pmapiter_prev(&it);
+            if (cur > 0) {
+                --cur;
+                TEST_ASSERT_EQUAL_PTR(ref->a[cur], x);
+            } else {
+                TEST_ASSERT_NULL(x);
+            }
+        }
+        if (cur == ref->n && 0 == rand() % 4) {
+            /* rewind from the end, to get more turn-arounds near the head */
+            while (NULL != pmapiter_prev(&it)) {
+                --cur;
+            }
+            TEST_ASSERT_EQUAL(0, cur);
+        }
+    }
+}
+
+static void test_fuzz_zigzag(void) {
+    PatriciaMapT m;
+    NodeVecT pre, in, post;
+    patrimap_init(&m);
+    TEST_ASSERT_TRUE(build_random_map(&m, 300u, 2024u));
+
+    const PTMapNodeT *root = s2m(m._m_set._m_root->_m_child[0]);
+    nv_init(&pre);
+    nv_init(&in);
+    nv_init(&post);
+    ref_preorder(root, &pre);
+    ref_inorder(root, &in);
+    ref_postorder(root, &post);
+
+    srand(31337u);
+    do_one_zigzag_run(&m, &pre, ePTMode_preOrder);
+    do_one_zigzag_run(&m, &in, ePTMode_inOrder);
+    do_one_zigzag_run(&m, &post, ePTMode_postOrder);
+
+    nv_free(&pre);
+    nv_free(&in);
+    nv_free(&post);
+    patrimap_fini(&m);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_fuzz_random_small);
     RUN_TEST(test_fuzz_random_medium);
     RUN_TEST(test_fuzz_random_seeded);
+    RUN_TEST(test_fuzz_remove_if);
+    RUN_TEST(test_fuzz_clone);
+    RUN_TEST(test_fuzz_clone_batch);
+    RUN_TEST(test_fuzz_zigzag);
     return UNITY_END();
 }
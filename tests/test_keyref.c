@@ -0,0 +1,208 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, external key references / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_ref.h"
+#include "helper_build_tree.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// a string table: keys are referenced by their offset
+#define NKEY 500
+static char     table[NKEY * 16];
+static uintptr_t offs[NKEY];
+static size_t   resolved;
+
+static const void *resolve(void *ctx, uintptr_t ref)
+{
+    ++resolved;
+    return (const char *)ctx + ref;
+}
+
+// counting policy: all nodes must have the same size
+static size_t allocs, frees, badsize;
+
+static void *fx_alloc(void *arena, size_t n)
+{
+    (void)arena;
+    ++allocs;
+    badsize += (PATRIREF_NODE_SIZE != n);
+    return malloc(n);
+}
+static void fx_free(void *arena, void *p)
+{
+    (void)arena;
+    ++frees;
+    free(p);
+}
+
+static const PTMemFuncT mf_fixed = { fx_alloc, fx_free, NULL };
+
+static PatriciaRefT set;
+
+void setUp(void)
+{
+    size_t pos = 0;
+    for (unsigned k = 0; k < NKEY; ++k) {
+        offs[k] = pos;
+        pos += (size_t)sprintf(table + pos, "key/%u", k * 7919u % 1000u) + 1;
+    }
+    allocs = frees = badsize = resolved = 0;
+    patriref_init_ex(&set, resolve, table, &mf_fixed, NULL);
+}
+void tearDown(void)
+{
+    patriref_fini(&set);
+    TEST_ASSERT_EQUAL(allocs, frees);
+}
+
+static const char *key(unsigned k)
+{
+    return table + offs[k];
+}
+
+static void test_insert_lookup(void)
+{
+    bool ins;
+
+    for (unsigned k = 0; k < NKEY; ++k) {
+        const PTSetNodeT *np = patriref_insert(&set, offs[k], str2bits(key(k)), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_EQUAL(offs[k], patriref_ref(np));
+    }
+    TEST_ASSERT_EQUAL(NKEY, allocs);
+    TEST_ASSERT_EQUAL(0, badsize);
+
+    // lookups with a copy of the key: the node still refers to the table
+    for (unsigned k = 0; k < NKEY; ++k) {
+        char buf[16];
+        const PTSetNodeT *np;
+        strcpy(buf, key(k));
+        resolved = 0;
+        np = patriref_lookup(&set, buf, str2bits(buf));
+        TEST_ASSERT_EQUAL(1, resolved);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL_PTR(key(k), patriref_key(&set, np));
+        TEST_ASSERT_EQUAL_PTR(np, patriref_insert(&set, offs[k], str2bits(key(k)), &ins));
+        TEST_ASSERT_FALSE(ins);
+    }
+    TEST_ASSERT_EQUAL(NKEY, allocs);
+    TEST_ASSERT_NULL(patriref_lookup(&set, "key/", 32));
+    TEST_ASSERT_NULL(patriref_lookup(&set, "key/1000", 64));
+    TEST_ASSERT_NULL(patriref_lookup(&set, "key/1", 39));
+}
+
+static void test_fuzz(void)
+{
+    PatriciaSetT ref;
+    unsigned     count = 0;
+
+    patriset_init(&ref);
+    srand(4711);
+    for (unsigned step = 0; step < 20000; ++step) {
+        unsigned k   = (unsigned)rand() % NKEY;
+        uint16_t len = str2bits(key(k));
+        bool     in  = (NULL != patriset_lookup(&ref, key(k), len));
+        bool     ins;
+
+        TEST_ASSERT_EQUAL(in, NULL != patriref_lookup(&set, key(k), len));
+        if (rand() % 2) {
+            TEST_ASSERT_NOT_NULL(patriref_insert(&set, offs[k], len, &ins));
+            TEST_ASSERT_EQUAL(!in, ins);
+            patriset_insert(&ref, key(k), len, NULL);
+            count += ins;
+        } else {
+            TEST_ASSERT_EQUAL(in, patriref_remove(&set, key(k), len));
+            TEST_ASSERT_EQUAL(in, patriset_remove(&ref, key(k), len));
+            count -= in;
+        }
+        TEST_ASSERT_EQUAL(count, allocs - frees);
+    }
+
+    // the shape is the same as with copied keys
+    {
+        PTSetStatsT a, b;
+        TEST_ASSERT_TRUE(patriset_stats(&set._m_set, &a));
+        TEST_ASSERT_TRUE(patriset_stats(&ref, &b));
+        TEST_ASSERT_EQUAL(b.keys, a.keys);
+        TEST_ASSERT_EQUAL(b.max_depth, a.max_depth);
+        TEST_ASSERT_EQUAL(b.leaves, a.leaves);
+    }
+    TEST_ASSERT_EQUAL(0, badsize);
+    patriset_fini(&ref);
+}
+
+// index of the key with reference 'ref'
+static unsigned keyidx(uintptr_t ref)
+{
+    unsigned lo = 0, hi = NKEY;
+    while (hi - lo > 1) {
+        unsigned mid = (lo + hi) / 2;
+        if (offs[mid] <= ref) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// every mode & direction must see every key once, forward and backward; the tree is
+// deep enough to need parent recovery walks, which have to resolve the references
+static void test_iterate(void)
+{
+    static const PTSetNodeT *seen[NKEY], *order[NKEY];
+    PTRefIterT        it;
+    const PTSetNodeT *np;
+    PTSetStatsT       st;
+
+    for (unsigned k = 0; k < NKEY; ++k) {
+        TEST_ASSERT_NOT_NULL(patriref_insert(&set, offs[k], str2bits(key(k)), NULL));
+    }
+    for (int mode = ePTMode_preOrder; mode <= ePTMode_postOrder; ++mode) {
+        for (int dir = 0; dir < 2; ++dir) {
+            unsigned n = 0;
+            memset(seen, 0, sizeof(seen));
+            prefiter_init(&it, &set, NULL, dir, (EPTIterMode)mode);
+            while (NULL != (np = prefiter_next(&it))) {
+                unsigned k = keyidx(patriref_ref(np));
+                TEST_ASSERT_EQUAL(offs[k], patriref_ref(np));
+                TEST_ASSERT_NULL(seen[k]);
+                seen[k] = np;
+                order[n++] = np;
+            }
+            TEST_ASSERT_EQUAL(NKEY, n);
+
+            // and all the way back, in reverse order
+            while (NULL != (np = prefiter_prev(&it))) {
+                TEST_ASSERT_TRUE(0 != n);
+                TEST_ASSERT_EQUAL_PTR(order[--n], np);
+            }
+            TEST_ASSERT_EQUAL(0, n);
+        }
+    }
+
+    TEST_ASSERT_TRUE(patriref_stats(&set, &st));
+    TEST_ASSERT_EQUAL(NKEY, st.keys);
+    TEST_ASSERT_EQUAL(0, st.key_bytes);
+    TEST_ASSERT_EQUAL(NKEY * PATRIREF_NODE_SIZE, st.node_bytes);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_lookup);
+    RUN_TEST(test_fuzz);
+    RUN_TEST(test_iterate);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-
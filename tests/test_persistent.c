@@ -0,0 +1,229 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, PERSISTENT variant / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_pers.h"
+#include "helper_build_tree.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+
+static PatriciaPersT set;
+
+void setUp(void)
+{
+    patripers_init(&set);
+}
+void tearDown(void)
+{
+    patripers_fini(&set);
+}
+
+static const char *const names[] = {
+    "evenly", "even", "eve", "e",
+    "acornix",   "banquetor", "cascadeum", "emberlyn",    "falconet",  "harborin",   "junctiona", "keystoner",
+    "forgewin",  "gullymar",  "hollowet",  "isletorn",    "jesterin",  "kilnaris",   "ledgerox",  "mosaicor",
+    "lanternis", "meadowen",  "nectaros",  "opalith",     "quiveron",  "rippletar",  "sagelynn",  "tundravel",
+    "venturex",  "willowen",  "yonderix",  "zephyran",    "bristleno", "cobblethor", "duskmire",  "elmshade",
+    NULL
+};
+
+// 'a' sorts before 'b' in left-to-right leaf order
+static bool is_before(const PTPersNodeT *a, const PTPersNodeT *b)
+{
+    uint16_t diff = patricia_bitdiff(a->u.data, a->nbit, b->u.data, b->nbit);
+    return (0 != diff) && patricia_getbit(b->u.data, b->nbit, diff);
+}
+
+static unsigned fill(PatriciaPersT *t)
+{
+    unsigned idx;
+    bool ins;
+
+    for (idx = 0; names[idx]; ++idx) {
+        const PTPersNodeT *np = patripers_insert(t, names[idx], str2bits(names[idx]), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->u.data);
+    }
+    return idx;
+}
+
+static void test_insert_lookup(void)
+{
+    unsigned idx, num = fill(&set);
+    bool ins;
+    char buf[64];
+
+    TEST_ASSERT_EQUAL(num, patripers_count(&set));
+    for (idx = 0; names[idx]; ++idx) {
+        TEST_ASSERT_NOT_NULL(patripers_insert(&set, names[idx], str2bits(names[idx]), &ins));
+        TEST_ASSERT_FALSE(ins);
+        TEST_ASSERT_NOT_NULL(patripers_lookup(&set, names[idx], str2bits(names[idx])));
+        snprintf(buf, sizeof(buf), "%sXX", names[idx]);
+        TEST_ASSERT_NULL(patripers_lookup(&set, buf, str2bits(buf)));
+    }
+    TEST_ASSERT_EQUAL(num, patripers_count(&set));
+}
+
+static void test_prefix(void)
+{
+    const PTPersNodeT *np;
+    unsigned idx;
+    char buf[64];
+
+    (void)fill(&set);
+    for (idx = 0; names[idx]; ++idx) {
+        snprintf(buf, sizeof(buf), "%sXX", names[idx]);
+        np = patripers_prefix(&set, buf, str2bits(buf));
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_EQUAL_STRING(names[idx], np->u.data);
+    }
+    np = patripers_prefix(&set, "evening", str2bits("evening"));
+    TEST_ASSERT_NOT_NULL(np);
+    TEST_ASSERT_EQUAL_STRING("even", np->u.data);
+    TEST_ASSERT_NULL(patripers_prefix(&set, "xylophon", str2bits("xylophon")));
+}
+
+static void test_iterate(void)
+{
+    const PTPersNodeT *np, *last = NULL;
+    PTPersIterT iter;
+    unsigned cnt = 0, num = fill(&set);
+
+    ppersiter_init(&iter, &set, true);
+    while (NULL != (np = ppersiter_next(&iter))) {
+        if (last) {
+            TEST_ASSERT_TRUE(is_before(last, np));
+        }
+        last = np;
+        ++cnt;
+    }
+    TEST_ASSERT_EQUAL(num, cnt);
+
+    // walk back from the end; a step forward in between yields the same leaf again
+    while (NULL != (np = ppersiter_prev(&iter))) {
+        if (cnt < num) {
+            TEST_ASSERT_TRUE(is_before(np, last));
+        }
+        TEST_ASSERT_EQUAL_PTR(np, ppersiter_next(&iter));
+        TEST_ASSERT_EQUAL_PTR(np, ppersiter_prev(&iter));
+        last = np;
+        --cnt;
+    }
+    TEST_ASSERT_EQUAL(0, cnt);
+    TEST_ASSERT_NULL(ppersiter_prev(&iter));
+    TEST_ASSERT_EQUAL_PTR(last, ppersiter_next(&iter));
+
+    ppersiter_init(&iter, &set, false);
+    last = NULL;
+    cnt = 0;
+    while (NULL != (np = ppersiter_next(&iter))) {
+        if (last) {
+            TEST_ASSERT_TRUE(is_before(np, last));
+        }
+        last = np;
+        ++cnt;
+    }
+    TEST_ASSERT_EQUAL(num, cnt);
+}
+
+static void test_snapshot(void)
+{
+    PatriciaPersT snap;
+    unsigned idx, num = fill(&set);
+    bool ins;
+
+    patripers_snapshot(&snap, &set);
+    for (idx = 0; names[idx]; idx += 2) {
+        TEST_ASSERT_TRUE(patripers_remove(&set, names[idx], str2bits(names[idx])));
+    }
+    TEST_ASSERT_NOT_NULL(patripers_insert(&set, "newcomer", str2bits("newcomer"), &ins));
+    TEST_ASSERT_TRUE(ins);
+
+    // the snapshot still sees the old state
+    TEST_ASSERT_EQUAL(num, patripers_count(&snap));
+    TEST_ASSERT_NULL(patripers_lookup(&snap, "newcomer", str2bits("newcomer")));
+    for (idx = 0; names[idx]; ++idx) {
+        TEST_ASSERT_NOT_NULL(patripers_lookup(&snap, names[idx], str2bits(names[idx])));
+        if (idx & 1) {
+            TEST_ASSERT_NOT_NULL(patripers_lookup(&set, names[idx], str2bits(names[idx])));
+        } else {
+            TEST_ASSERT_NULL(patripers_lookup(&set, names[idx], str2bits(names[idx])));
+        }
+    }
+
+    // and survives the original
+    patripers_fini(&set);
+    for (idx = 0; names[idx]; ++idx) {
+        TEST_ASSERT_NOT_NULL(patripers_lookup(&snap, names[idx], str2bits(names[idx])));
+    }
+    patripers_fini(&snap);
+}
+
+// random operations on a bunch of versions, checked against a bitmap of members
+static void test_versions_fuzz(void)
+{
+    enum { NVER = 8, NKEY = 200, NOPS = 4000 };
+    static PatriciaPersT vers[NVER];
+    static bool member[NVER][NKEY];
+    char buf[16];
+
+    srand(4711);
+    memset(member, 0, sizeof(member));
+    for (unsigned v = 0; v < NVER; ++v) {
+        patripers_init(&vers[v]);
+    }
+    for (unsigned op = 0; op < NOPS; ++op) {
+        unsigned v = (unsigned)rand() % NVER;
+        unsigned k = (unsigned)rand() % NKEY;
+        snprintf(buf, sizeof(buf), "k%u", k * 7919u);
+        switch (rand() % 4) {
+        case 0:
+            TEST_ASSERT_EQUAL(member[v][k], patripers_remove(&vers[v], buf, str2bits(buf)));
+            member[v][k] = false;
+            break;
+        case 1: {
+            unsigned w = (unsigned)rand() % NVER;
+            if (w != v) {
+                patripers_fini(&vers[w]);
+                patripers_snapshot(&vers[w], &vers[v]);
+                memcpy(member[w], member[v], sizeof(member[v]));
+            }
+            break;
+        }
+        default:
+            TEST_ASSERT_NOT_NULL(patripers_insert(&vers[v], buf, str2bits(buf), NULL));
+            member[v][k] = true;
+            break;
+        }
+    }
+    for (unsigned v = 0; v < NVER; ++v) {
+        size_t cnt = 0;
+        for (unsigned k = 0; k < NKEY; ++k) {
+            snprintf(buf, sizeof(buf), "k%u", k * 7919u);
+            TEST_ASSERT_EQUAL(member[v][k], NULL != patripers_lookup(&vers[v], buf, str2bits(buf)));
+            cnt += member[v][k];
+        }
+        TEST_ASSERT_EQUAL(cnt, patripers_count(&vers[v]));
+        patripers_fini(&vers[v]);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_lookup);
+    RUN_TEST(test_prefix);
+    RUN_TEST(test_iterate);
+    RUN_TEST(test_snapshot);
+    RUN_TEST(test_versions_fuzz);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-
@@ -0,0 +1,178 @@
+// -------------------------------------------------------------------------------------
+// PATRICIA tree, split node / key arenas / unit testing
+// -------------------------------------------------------------------------------------
+// This file is part of "PatriciaC" by J.Perlinger.
+//
+// PatriciaC by J.Perlinger is marked CC0 1.0. To view a copy of this mark,
+//    visit https://creativecommons.org/publicdomain/zero/1.0/
+//
+// -------------------------------------------------------------------------------------
+#include "cpatricia_split.h"
+#include "helper_build_tree.h"
+#include "unity.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static PatriciaSplitT set;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(patrisplit_init(&set, 16u << 20));
+}
+void tearDown(void)
+{
+    patrisplit_fini(&set);
+}
+
+static void test_copy(void)
+{
+    char buf[64];
+    bool ins;
+
+    // keys are copied: the caller's buffer can be reused right away
+    for (unsigned k = 0; k < 1000; ++k) {
+        const PTSetNodeT *np;
+        snprintf(buf, sizeof(buf), "some/longer/path/%u", k);
+        np = patrisplit_insert(&set, buf, str2bits(buf), &ins);
+        TEST_ASSERT_NOT_NULL(np);
+        TEST_ASSERT_TRUE(ins);
+        TEST_ASSERT_TRUE(patrisplit_key(np) != (const void *)buf);
+        TEST_ASSERT_EQUAL_MEMORY(buf, patrisplit_key(np), strlen(buf));
+    }
+    for (unsigned k = 0; k < 1000; ++k) {
+        snprintf(buf, sizeof(buf), "some/longer/path/%u", k);
+        TEST_ASSERT_NOT_NULL(patrisplit_lookup(&set, buf, str2bits(buf)));
+        TEST_ASSERT_NOT_NULL(patrisplit_insert(&set, buf, str2bits(buf), &ins));
+        TEST_ASSERT_FALSE(ins);
+    }
+    TEST_ASSERT_NULL(patrisplit_lookup(&set, "some/longer/path/", 17 * 8));
+}
+
+static void test_recycle(void)
+{
+    char   buf[32];
+    size_t total;
+
+    for (unsigned k = 0; k < 500; ++k) {
+        snprintf(buf, sizeof(buf), "k%u", k);
+        TEST_ASSERT_NOT_NULL(patrisplit_insert(&set, buf, str2bits(buf), NULL));
+    }
+    total = vmBump_getattr(&set._m_nodes, eVmBumpAtt_Total);
+
+    // removed nodes are reused, the node arena does not grow
+    for (unsigned round = 0; round < 4; ++round) {
+        for (unsigned k = 0; k < 500; k += 2) {
+            snprintf(buf, sizeof(buf), "k%u", k);
+            TEST_ASSERT_TRUE(patrisplit_remove(&set, buf, str2bits(buf)));
+        }
+        for (unsigned k = 0; k < 500; k += 2) {
+            snprintf(buf, sizeof(buf), "k%u", k);
+            TEST_ASSERT_NOT_NULL(patrisplit_insert(&set, buf, str2bits(buf), NULL));
+        }
+    }
+    TEST_ASSERT_EQUAL(total, vmBump_getattr(&set._m_nodes, eVmBumpAtt_Total));
+    for (unsigned k = 0; k < 500; ++k) {
+        snprintf(buf, sizeof(buf), "k%u", k);
+        TEST_ASSERT_NOT_NULL(patrisplit_lookup(&set, buf, str2bits(buf)));
+    }
+}
+
+static void test_fuzz(void)
+{
+    PatriciaSetT ref;
+    char         buf[32];
+
+    patriset_init(&ref);
+    srand(99);
+    for (unsigned step = 0; step < 20000; ++step) {
+        uint16_t len;
+        bool     in, ins;
+
+        snprintf(buf, sizeof(buf), "x%u", (unsigned)rand() % 700);
+        len = (uint16_t)(str2bits(buf) - (unsigned)rand() % 8);
+        in  = (NULL != patriset_lookup(&ref, buf, len));
+        TEST_ASSERT_EQUAL(in, NULL != patrisplit_lookup(&set, buf, len));
+        if (rand() % 2) {
+            TEST_ASSERT_NOT_NULL(patrisplit_insert(&set, buf, len, &ins));
+            TEST_ASSERT_EQUAL(!in, ins);
+            patriset_insert(&ref, buf, len, NULL);
+        } else {
+            TEST_ASSERT_EQUAL(in, patrisplit_remove(&set, buf, len));
+            patriset_remove(&ref, buf, len);
+        }
+    }
+    patriset_fini(&ref);
+}
+
+static void test_limit(void)
+{
+    char     key[2048];
+    unsigned k, made = 0;
+
+    // a small limit: inserting fails cleanly once the key arena is exhausted
+    patrisplit_fini(&set);
+    TEST_ASSERT_TRUE(patrisplit_init(&set, 0));
+    memset(key, 'a', sizeof(key));
+    for (k = 0; k < 100; ++k) {
+        snprintf(key, 16, "%08u", k);
+        key[8] = 'a';
+        if (NULL == patrisplit_insert(&set, key, sizeof(key) * 8, NULL)) {
+            break;
+        }
+        ++made;
+    }
+    TEST_ASSERT_TRUE(made > 0);
+    TEST_ASSERT_TRUE(made < 100);
+    for (k = 0; k <= made; ++k) {
+        snprintf(key, 16, "%08u", k);
+        key[8] = 'a';
+        TEST_ASSERT_EQUAL(k < made, NULL != patrisplit_lookup(&set, key, sizeof(key) * 8));
+    }
+}
+
+// the reference set iterators walk the split set; every key must show up once and be
+// found again by lookup
+static void test_iterate(void)
+{
+    static bool       seen[1000];
+    char              buf[64];
+    PTRefIterT        it;
+    const PTSetNodeT *np;
+    unsigned          n = 0, k;
+
+    for (k = 0; k < 1000; ++k) {
+        snprintf(buf, sizeof(buf), "some/longer/path/%u", k);
+        TEST_ASSERT_NOT_NULL(patrisplit_insert(&set, buf, str2bits(buf), NULL));
+    }
+    for (int dir = 0; dir < 2; ++dir) {
+        memset(seen, 0, sizeof(seen));
+        n = 0;
+        prefiter_init(&it, &set._m_ref, NULL, dir, ePTMode_postOrder);
+        while (NULL != (np = prefiter_next(&it))) {
+            TEST_ASSERT_TRUE(np->nbit / 8u < sizeof(buf));
+            memcpy(buf, patrisplit_key(np), np->nbit / 8u);
+            buf[np->nbit / 8u] = '\0';
+            TEST_ASSERT_EQUAL(1, sscanf(buf, "some/longer/path/%u", &k));
+            TEST_ASSERT_TRUE(k < 1000);
+            TEST_ASSERT_FALSE(seen[k]);
+            seen[k] = true;
+            TEST_ASSERT_EQUAL_PTR(np, patrisplit_lookup(&set, buf, np->nbit));
+            ++n;
+        }
+        TEST_ASSERT_EQUAL(1000, n);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_copy);
+    RUN_TEST(test_recycle);
+    RUN_TEST(test_fuzz);
+    RUN_TEST(test_limit);
+    RUN_TEST(test_iterate);
+    return UNITY_END();
+}
+
+// -*- that's all folks -*-